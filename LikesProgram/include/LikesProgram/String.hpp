@@ -1,18 +1,28 @@
 ﻿#pragma once
 #include "system/LikesProgramLibExport.hpp"
+#include "stringFormat/FormatString.hpp"
 #include <vector>
 #include <string>
 #include <memory>
 #include <sstream>
 #include <any>
+#include <cstdint>
+
+// 短字符串 UTF-8 内联存储（SSO），构建时可通过 LIKESPROGRAM_STRING_SSO=0 关闭
+#ifndef LIKESPROGRAM_STRING_SSO
+#define LIKESPROGRAM_STRING_SSO 1
+#endif
 
 namespace LikesProgram {
     using Any = std::any;
     class LIKESPROGRAM_API String {
     public:
-        // 支持的编码类型，仅用于标识字符串来源，内部存储总是 UTF-16。
-        enum class Encoding { GBK, UTF8, UTF16, UTF32 };
+        // 支持的编码类型，仅用于标识字符串来源。
+        // 内部存储：不超过 SSOCapacity 字节的短字符串以 UTF-8 内联保存，其余使用堆上的 UTF-16。
+        enum class Encoding : uint8_t { GBK, UTF8, UTF16, UTF32 };
         static constexpr size_t npos = static_cast<size_t>(-1);
+        // 内联存储的最大 UTF-8 字节数（使 String 保持 32 字节）
+        static constexpr size_t SSOCapacity = 21;
 
         // 从 std::any 创建 String
         static bool FromAny(const std::any& a, String& outContent);
@@ -68,6 +78,8 @@ namespace LikesProgram {
         size_t Length() const;
         // 是否为空
         bool Empty() const;
+        // 是否使用 UTF-8 内联存储（未分配堆内存）
+        bool IsInline() const noexcept;
         // 清空字符串
         void Clear();
 
@@ -82,6 +94,8 @@ namespace LikesProgram {
 
         // 拼接字符串
         String& Append(const String& str);
+        // 追加 UTF-8 文本（堆存储时直接转码到已有容量的尾部）
+        String& Append(const char8_t* utf8, size_t length);
         String& operator+=(const String& str);
         friend String operator+(const String& lhs, const String& rhs);
 
@@ -133,39 +147,106 @@ namespace LikesProgram {
         std::u16string ToU16String() const;
         // 转换为u32string
         std::u32string ToU32String() const;
+        // 以 UTF-8 追加到 out（内联存储时直接拷贝）
+        void AppendTo(std::u8string& out) const;
 
         // 分割成字符串数组
         std::vector<String> Split(const String& sep) const;
 
-        // 迭代器
+        // 迭代器（按存储单元顺序解码，每步 O(1)）
         class CodePointIterator {
         private:
             const String* str;
-            size_t idx;  // code point 索引
+            size_t pos;        // 当前码点的存储单元偏移
+            size_t next = 0;   // 下一个码点的存储单元偏移
+            char32_t cp = 0;   // 当前码点
         public:
-            CodePointIterator(const String* s, size_t i) : str(s), idx(i) {}
-            char32_t operator*() const { return str->At(idx); }
-            CodePointIterator& operator++() { ++idx; return *this; }
-            bool operator!=(const CodePointIterator& other) const { return idx != other.idx; }
+            CodePointIterator(const String* s, size_t p) : str(s), pos(p) {
+                if (pos < str->UnitCount()) next = str->DecodeAt(pos, cp);
+            }
+            char32_t operator*() const { return cp; }
+            CodePointIterator& operator++() {
+                pos = next;
+                if (pos < str->UnitCount()) next = str->DecodeAt(pos, cp);
+                return *this;
+            }
+            bool operator!=(const CodePointIterator& other) const { return pos != other.pos; }
         };
 
         CodePointIterator begin() const { return CodePointIterator(this, 0); }
-        CodePointIterator end() const { return CodePointIterator(this, Size()); }
+        CodePointIterator end() const { return CodePointIterator(this, UnitCount()); }
 
         // JSON 转义
         static String EscapeJson(const String& str);
 
         // 格式化
+        // 字面量格式串在编译期解析，内建类型参数直接写入线程缓冲区；其余情况走 FormatAny
         template <typename... Args>
-        static String Format(const String& fmt, Args&&... args) {
-            // 打包参数
-            std::vector<Any> v;
-            v.reserve(sizeof...(Args));
-            // 将每个参数替换为std:：any（decaded）
-            (v.emplace_back(std::decay_t<Args>(std::forward<Args>(args))), ...);
+        static String Format(StringFormat::FormatString<Args...> fmt, Args&&... args) {
+            if (fmt.IsCompiled() && !StringFormat::BuiltinFormattersOverridden()) {
+                try {
+                    std::u8string& out = StringFormat::ThreadFormatBuffer();
+                    fmt.FormatTo(out, args...);
+                    return String(out);
+                }
+                catch (...) {
+                    // 无法直接写入（如非法编码），交给 FormatAny 处理
+                }
+            }
+            return FormatRuntime(fmt, std::forward<Args>(args)...);
+        }
 
-            // 调用 FormatAny
-            return FormatAny(fmt, v);
+        // 格式化并以 UTF-8 追加到 out，复用其已有容量
+        template <typename... Args>
+        static void FormatTo(std::u8string& out, StringFormat::FormatString<Args...> fmt, Args&&... args) {
+            if (fmt.IsCompiled() && !StringFormat::BuiltinFormattersOverridden()) {
+                size_t start = out.size();
+                try {
+                    fmt.FormatTo(out, args...);
+                    return;
+                }
+                catch (...) {
+                    out.resize(start); // 丢弃写了一半的内容
+                }
+            }
+            FormatRuntime(fmt, std::forward<Args>(args)...).AppendTo(out);
+        }
+
+        // 格式化并追加到 out（按倍数扩容，连续追加时摊销分配）
+        template <typename... Args>
+        static void FormatTo(String& out, StringFormat::FormatString<Args...> fmt, Args&&... args) {
+            if (fmt.IsCompiled() && !StringFormat::BuiltinFormattersOverridden()) {
+                try {
+                    std::u8string& buffer = StringFormat::ThreadFormatBuffer();
+                    fmt.FormatTo(buffer, args...);
+                    out.Append(buffer.data(), buffer.size());
+                    return;
+                }
+                catch (...) {
+                }
+            }
+            out.Append(FormatRuntime(fmt, std::forward<Args>(args)...));
+        }
+
+        // 格式化并以 UTF-8 字节追加到写缓冲区（如 Net::Buffer，需提供 Append(const void*, size_t)）
+        template <typename Output, typename... Args>
+            requires requires(Output& o, const void* data, size_t length) { o.Append(data, length); }
+        static void FormatTo(Output& out, StringFormat::FormatString<Args...> fmt, Args&&... args) {
+            if (fmt.IsCompiled() && !StringFormat::BuiltinFormattersOverridden()) {
+                try {
+                    std::u8string& buffer = StringFormat::ThreadFormatBuffer();
+                    fmt.FormatTo(buffer, args...);
+                    out.Append(buffer.data(), buffer.size());
+                    return;
+                }
+                catch (...) {
+                }
+            }
+            // 自定义 formatter 可能嵌套使用线程缓冲区，先得到结果再取缓冲区
+            String result = FormatRuntime(fmt, std::forward<Args>(args)...);
+            std::u8string& buffer = StringFormat::ThreadFormatBuffer();
+            result.AppendTo(buffer);
+            out.Append(buffer.data(), buffer.size());
         }
 
         template <typename T>
@@ -196,17 +277,68 @@ namespace LikesProgram {
         }
 
     private:
+        // 打包参数并调用 FormatAny（运行时格式串或编译期路径失败时使用）
+        template <typename... Args>
+        static String FormatRuntime(const StringFormat::FormatString<Args...>& fmt, Args&&... args) {
+            // 打包参数
+            std::vector<Any> v;
+            v.reserve(sizeof...(Args));
+            // 将每个参数替换为std:：any（decaded）
+            (v.emplace_back(std::decay_t<Args>(std::forward<Args>(args))), ...);
+
+            // 调用 FormatAny
+            if (const String* runtime = fmt.RuntimeString()) return FormatAny(*runtime, v);
+            return FormatAny(fmt.ToString(), v);
+        }
+
         struct StringImpl;
-        StringImpl* m_impl = nullptr;
+        StringImpl* m_impl = nullptr;  // UTF-16 堆存储，为空时使用内联存储
 
-        size_t CodePointOffset(size_t index) const;
+        char8_t m_sso[SSOCapacity];     // UTF-8 内联存储（不含结尾 '\0'）
+        uint8_t m_ssoSize = 0;          // 内联存储的字节数
+        bool m_ssoAscii = true;         // 内联内容是否全为 ASCII（可按字节直接索引）
+        Encoding m_encoding = Encoding::UTF8; // 原始编码
 
-        void update_cp_cache() const;
+        // 尝试以 UTF-8 内联存储（超出容量或含非法序列时返回 false）
+        bool TryStoreInline(const char8_t* utf8, size_t length);
+        bool TryStoreInline(const char16_t* utf16, size_t length);
+        bool TryStoreInline(const char32_t* utf32, size_t length);
+        // 以 UTF-8 内容赋值（可内联时优先内联，否则直接转码到堆存储）
+        void AssignUtf8(const char8_t* utf8, size_t length);
+        // 以 UTF-16 内容赋值（可内联时优先内联）
+        void AssignUtf16(const char16_t* utf16, size_t length);
+        // 内联存储转为堆存储，并预留 extra 个 UTF-16 单元
+        void PromoteToHeap(size_t extra);
+        // 获取 UTF-16 数据（内联存储时转码到 buffer）
+        const char16_t* Utf16Data(std::u16string& buffer, size_t& length) const;
+        // 由 UTF-16 数据构造
+        static String FromUtf16(const char16_t* utf16, size_t length, Encoding enc = Encoding::UTF8);
+
+        // 当前存储的单元数（内联为 UTF-8 字节，堆为 UTF-16 单元）
+        size_t UnitCount() const;
+        // 从存储单元偏移 pos 解码一个码点，返回下一个码点的偏移
+        size_t DecodeAt(size_t pos, char32_t& cp) const;
+        // 第 index 个码点在存储中的单元偏移
+        size_t CodePointOffset(size_t index) const;
 
         static String FormatAny(const String& fmt, const std::vector<Any>& args);
     };
 }
 
+namespace LikesProgram {
+    namespace StringFormat {
+        template <typename... Args>
+        String BasicFormatString<Args...>::ToString() const {
+            if (m_runtime) return *m_runtime;
+            switch (m_unitSize) {
+            case 1: return String(std::u8string(static_cast<const char8_t*>(m_data), m_length));
+            case 2: return String(static_cast<const char16_t*>(m_data), m_length);
+            default: return String(std::u32string(static_cast<const char32_t*>(m_data), m_length));
+            }
+        }
+    }
+}
+
 namespace std {
     template<>
     struct hash<LikesProgram::String> {
@@ -1,12 +1,22 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
 #include "sinks/Sink.hpp"
+#include "RateLimit.hpp"
+#include "../threading/InplaceTask.hpp"
 #include <source_location>
 
+// 编译期最低日志级别（0=Trace … 5=Fatal），低于该级别的 LogXxx 宏展开为空，参数不会被求值
+#ifndef LIKESPROGRAM_LOG_MIN_LEVEL
+#define LIKESPROGRAM_LOG_MIN_LEVEL 0
+#endif
+
 namespace LikesProgram {
     namespace Log {
         class LIKESPROGRAM_API Logger {
         public:
+            // 默认队列容量（条），向上取整为 2 的幂
+            static constexpr size_t DefaultQueueCapacity = 4096;
+
             // 获取全局唯一实例
             static Logger& Instance();
             static Logger& Instance(bool autoStart);
@@ -16,25 +26,72 @@ namespace LikesProgram {
             // 低于该级别的日志将被过滤掉
             void SetLevel(Level level);
 
+            // 该级别的日志是否会被记录（仅一次 relaxed 原子读取，LogXxx 宏在求值参数前调用）
+            static bool ShouldLog(Level level) noexcept;
+
             // 设置日志输出编码
             void SetEncoding(String::Encoding encoding);
 
+            // 设置队列已满时的处理策略（默认 Block）
+            void SetOverflowPolicy(OverflowPolicy policy);
+
+            // 设置队列容量，仅在日志系统停止且队列为空时生效
+            bool SetQueueCapacity(size_t capacity);
+
+            // 当前排队的日志条数（近似值）
+            size_t QueueDepth() const;
+
+            // 因队列已满被丢弃的日志条数
+            uint64_t DroppedCount() const;
+
+            // 设置是否延迟格式化：开启后调用线程只拷贝参数，格式化在日志线程进行。
+            // 参数按值拷贝，自定义类型需自身拥有数据；视图、引用包装与对象指针仍在调用线程立即格式化
+            void SetDeferredFormatting(bool enable);
+            bool IsDeferredFormatting() const;
+
             // 添加一个日志输出目标（Sink）
             void AddSink(std::shared_ptr<Sink> sink);
 
             // 格式化面板
             template <typename... Args>
-            void Log(Level level, const std::source_location& loc, const String& format, Args&&... args) {
+            void Log(Level level, const std::source_location& loc, StringFormat::FormatString<Args...> format, Args&&... args) {
+                if (!ShouldLog(level)) return;
                 if constexpr (sizeof...(args) == 0) {
                     // 无参数，直接输出原始字符串
-                    LogMessageString(level, format, loc.file_name(), loc.line(), loc.function_name());
+                    if (const String* runtime = format.RuntimeString()) LogMessageString(level, *runtime, loc.file_name(), loc.line(), loc.function_name());
+                    else LogMessageString(level, format.ToString(), loc.file_name(), loc.line(), loc.function_name());
                 }
                 else {
+                    if constexpr ((IsDeferrable<Args> && ...)) {
+                        if (IsDeferredFormatting()) {
+                            // 延迟格式化：拷贝参数，交给日志线程（记录从任务内存池分配，稳定运行时不触发堆分配）
+                            using Deferred = DeferredFormatArgs<std::decay_t<Args>...>;
+                            LogDeferred(level, std::allocate_shared<const Deferred>(TaskPool::Allocator<Deferred>(), format, std::forward<Args>(args)...),
+                                loc.file_name(), loc.line(), loc.function_name());
+                            return;
+                        }
+                    }
                     // 有参数，执行格式化
                     LogMessageString(level, String::Format(format, std::forward<Args>(args)...), loc.file_name(), loc.line(), loc.function_name());
                 }
             }
 
+            // 限频日志输出（由 LogEveryN 等宏调用），suppressed 大于 0 时在消息末尾注明被抑制的条数
+            template <typename... Args>
+            void LogSuppressed(Level level, const std::source_location& loc, uint64_t suppressed, StringFormat::FormatString<Args...> format, Args&&... args) {
+                if (!ShouldLog(level)) return;
+                String msg;
+                if constexpr (sizeof...(args) == 0) {
+                    if (const String* runtime = format.RuntimeString()) msg = *runtime;
+                    else msg = format.ToString();
+                }
+                else {
+                    String::FormatTo(msg, format, std::forward<Args>(args)...);
+                }
+                if (suppressed > 0) String::FormatTo(msg, u" (suppressed {} similar messages)", suppressed);
+                LogMessageString(level, msg, loc.file_name(), loc.line(), loc.function_name());
+            }
+
             // 启动日志系统（创建后台线程）
             bool Start();
 
@@ -56,20 +113,58 @@ namespace LikesProgram {
 
             // 记录一条日志
             void LogMessageString(Level level, const String& msg, const char* file, int line, const char* func);
+            // 记录一条延迟格式化的日志
+            void LogDeferred(Level level, std::shared_ptr<const DeferredFormat> deferred, const char* file, int line, const char* func);
+            // 填充公共字段并入队
+            void Submit(Level level, String&& msg, std::shared_ptr<const DeferredFormat>&& deferred, const char* file, int line, const char* func);
 
             // 日志处理循环（后台线程执行）
             void ProcessLoop();
 
+            // 入队，队列已满时按 OverflowPolicy 处理
+            void Enqueue(Message&& message);
+
+            // 在当前线程直接写入所有 Sink
+            void WriteToSinks(const Message& message);
+
             struct LoggerImpl;
             LoggerImpl* m_impl; // 指针方式隐藏具体实现，减少编译依赖
         };
     }
 
 // 宏接口
-#define LogTrace(msg, ...) (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Trace, std::source_location::current(), msg, ##__VA_ARGS__))
-#define LogDebug(msg, ...) (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Debug, std::source_location::current(), msg, ##__VA_ARGS__))
-#define LogInfo(msg, ...)  (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Info,  std::source_location::current(), msg, ##__VA_ARGS__))
-#define LogWarn(msg, ...)  (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Warn,  std::source_location::current(), msg, ##__VA_ARGS__))
-#define LogError(msg, ...) (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Error, std::source_location::current(), msg, ##__VA_ARGS__))
-#define LogFatal(msg, ...) (LikesProgram::Log::Logger::Instance().Log(LikesProgram::Log::Level::Fatal, std::source_location::current(), msg, ##__VA_ARGS__))
+// 先检查级别，未启用时不求值参数、不格式化
+#define LIKESPROGRAM_LOG(level, msg, ...) (LikesProgram::Log::Logger::ShouldLog(level) \
+    ? LikesProgram::Log::Logger::Instance().Log(level, std::source_location::current(), msg, ##__VA_ARGS__) : void())
+
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 0
+#define LogTrace(msg, ...) LIKESPROGRAM_LOG(LikesProgram::Log::Level::Trace, msg, ##__VA_ARGS__)
+#else
+#define LogTrace(msg, ...) ((void)0)
+#endif
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 1
+#define LogDebug(msg, ...) LIKESPROGRAM_LOG(LikesProgram::Log::Level::Debug, msg, ##__VA_ARGS__)
+#else
+#define LogDebug(msg, ...) ((void)0)
+#endif
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 2
+#define LogInfo(msg, ...)  LIKESPROGRAM_LOG(LikesProgram::Log::Level::Info,  msg, ##__VA_ARGS__)
+#else
+#define LogInfo(msg, ...)  ((void)0)
+#endif
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 3
+#define LogWarn(msg, ...)  LIKESPROGRAM_LOG(LikesProgram::Log::Level::Warn,  msg, ##__VA_ARGS__)
+#else
+#define LogWarn(msg, ...)  ((void)0)
+#endif
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 4
+#define LogError(msg, ...) LIKESPROGRAM_LOG(LikesProgram::Log::Level::Error, msg, ##__VA_ARGS__)
+#else
+#define LogError(msg, ...) ((void)0)
+#endif
+#if LIKESPROGRAM_LOG_MIN_LEVEL <= 5
+#define LogFatal(msg, ...) LIKESPROGRAM_LOG(LikesProgram::Log::Level::Fatal, msg, ##__VA_ARGS__)
+#else
+#define LogFatal(msg, ...) ((void)0)
+#endif
 }
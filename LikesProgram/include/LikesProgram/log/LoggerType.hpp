@@ -2,6 +2,11 @@
 #include "../String.hpp"
 #include <thread>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <string_view>
+#include <tuple>
 
 namespace LikesProgram {
     namespace Log {
@@ -14,23 +19,100 @@ namespace LikesProgram {
             Fatal       // 致命错误信息, 代表程序无法继续运行
         };
 
+        // 日志队列已满时的处理策略
+        enum class OverflowPolicy {
+            Block = 0,      // 阻塞等待队列腾出空间
+            DropNewest,     // 丢弃当前这条日志
+            DropOldest,     // 丢弃队列中最旧的日志，为当前日志腾出空间
+            Synchronous     // 在调用线程直接写入 Sink（可能与队列中的日志乱序）
+        };
+
         // 日志级别转字符串
         const String LevelToString(Level level);
         // 字符串转日志级别
         Level StringToLevel(const String& levelString, const Level defaultLevel = Level::Trace);
 
+        // 延迟格式化记录：调用线程只拷贝格式串与参数，由日志线程完成格式化
+        class DeferredFormat {
+        public:
+            virtual ~DeferredFormat() = default;
+            virtual String Format() const = 0;
+        };
+
+        // 延迟格式化时参数的保存方式：字符串指针与字符串视图拷贝为对应的字符串，其余按值保存。
+        // 按值保存的参数必须自身拥有数据，格式化时调用方的对象可能已经销毁
+        template <typename T>
+        struct DeferredArg {
+            using Type = T;
+            static const T& Get(const Type& value) { return value; }
+        };
+        template <typename CharT>
+        struct DeferredStringArg {
+            using Type = std::basic_string<std::remove_const_t<CharT>>;
+            static CharT* Get(const Type& value) { return const_cast<CharT*>(value.c_str()); }
+        };
+        template <> struct DeferredArg<const char*> : DeferredStringArg<const char> {};
+        template <> struct DeferredArg<char*> : DeferredStringArg<char> {};
+        template <> struct DeferredArg<const wchar_t*> : DeferredStringArg<const wchar_t> {};
+        template <> struct DeferredArg<wchar_t*> : DeferredStringArg<wchar_t> {};
+        template <> struct DeferredArg<const char16_t*> : DeferredStringArg<const char16_t> {};
+        template <> struct DeferredArg<const char32_t*> : DeferredStringArg<const char32_t> {};
+        template <typename CharT, typename Traits>
+        struct DeferredArg<std::basic_string_view<CharT, Traits>> {
+            using Type = std::basic_string<CharT, Traits>;
+            static std::basic_string_view<CharT, Traits> Get(const Type& value) { return value; }
+        };
+
+        // 不拥有数据的参数（视图、引用包装）：按值拷贝后仍引用调用方的数据
+        template <typename T>
+        constexpr bool IsBorrowedArg = std::ranges::view<T>;
+        template <typename T>
+        constexpr bool IsBorrowedArg<std::reference_wrapper<T>> = true;
+
+        // 参数能否延迟格式化：需可拷贝保存；未转为拥有数据的对象指针、视图与引用包装在格式化时可能已失效，
+        // 含有这类参数的日志在调用线程立即格式化
+        template <typename T>
+        constexpr bool IsDeferrable = std::is_constructible_v<typename DeferredArg<std::decay_t<T>>::Type, T&&> &&
+            (!std::is_pointer_v<std::decay_t<T>> || !std::is_same_v<typename DeferredArg<std::decay_t<T>>::Type, std::decay_t<T>> ||
+                std::is_void_v<std::remove_pointer_t<std::decay_t<T>>>) &&
+            (!IsBorrowedArg<std::decay_t<T>> || !std::is_same_v<typename DeferredArg<std::decay_t<T>>::Type, std::decay_t<T>>);
+
+        template <typename... Args>
+        class DeferredFormatArgs final : public DeferredFormat {
+        public:
+            template <typename... Ts>
+            DeferredFormatArgs(const StringFormat::FormatString<Args...>& format, Ts&&... args)
+                : m_format(format), m_args(std::forward<Ts>(args)...) {
+                // 运行时格式串只保存了指针，需拷贝一份
+                if (const String* runtime = format.RuntimeString()) {
+                    m_runtime = *runtime;
+                    m_format = StringFormat::FormatString<Args...>(m_runtime);
+                }
+            }
+
+            String Format() const override {
+                return std::apply([this](const auto&... args) { return String::Format(m_format, DeferredArg<Args>::Get(args)...); }, m_args);
+            }
+
+        private:
+            String m_runtime;
+            StringFormat::FormatString<Args...> m_format;
+            std::tuple<typename DeferredArg<Args>::Type...> m_args;
+        };
+
         struct Message {
             Level level = Level::Trace;
             String msg;
-            String file;
+            const char* file = nullptr;          // 源文件（指向 source_location 的静态数据）
             int line = 0;
             std::thread::id tid;
-            String threadName;
+            std::shared_ptr<const String> threadName; // 线程名（CoreUtils::GetCurrentThreadNameShared 的共享副本）
             std::chrono::system_clock::time_point timestamp;
-            String func;
+            const char* func = nullptr;          // 函数名（指向 source_location 的静态数据）
             Level minLevel = Level::Info;
             String::Encoding encoding = String::Encoding::UTF8;
             bool debug = true;
+            std::shared_ptr<const DeferredFormat> deferred; // 非空时 msg 尚未格式化，由日志线程填充
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace LikesProgram {
+    namespace Log {
+        // 限频 / 采样日志的调用点状态（由 LogEveryN 等宏为每个调用点生成一个静态实例）
+        // Acquire 无锁，返回 true 表示本次应输出，suppressed 为自上次输出以来被抑制的条数
+        namespace RateLimit {
+            // 每 N 次输出一次
+            class EveryN {
+            public:
+                bool Acquire(uint64_t n, uint64_t& suppressed) noexcept {
+                    uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+                    if (n <= 1) return true;
+                    if (count % n != 0) return false;
+                    suppressed = count == 0 ? 0 : n - 1;
+                    return true;
+                }
+            private:
+                std::atomic<uint64_t> m_count{ 0 };
+            };
+
+            // 只输出前 N 次
+            class FirstN {
+            public:
+                bool Acquire(uint64_t n, uint64_t& suppressed) noexcept {
+                    suppressed = 0;
+                    // 超过 N 后不再递增，避免计数溢出回绕
+                    if (m_count.load(std::memory_order_relaxed) >= n) return false;
+                    return m_count.fetch_add(1, std::memory_order_relaxed) < n;
+                }
+            private:
+                std::atomic<uint64_t> m_count{ 0 };
+            };
+
+            // 每隔 intervalMs 毫秒最多输出一次
+            class EveryMs {
+            public:
+                bool Acquire(int64_t intervalMs, uint64_t& suppressed) noexcept {
+                    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                    int64_t last = m_last.load(std::memory_order_relaxed);
+                    if ((last == 0 || now - last >= intervalMs) && m_last.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+                        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+                        return true;
+                    }
+                    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            private:
+                std::atomic<int64_t> m_last{ 0 };
+                std::atomic<uint64_t> m_suppressed{ 0 };
+            };
+
+            // 按概率 probability（0~1）随机采样
+            class Sampled {
+            public:
+                bool Acquire(double probability, uint64_t& suppressed) noexcept {
+                    if (probability < 1.0 && NextUnit() >= probability) {
+                        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+                    return true;
+                }
+            private:
+                // 线程内 xorshift 随机数，[0, 1)
+                static double NextUnit() noexcept {
+                    thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) ^
+                        static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^ 0x9E3779B97F4A7C15ULL;
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    return static_cast<double>(state >> 11) * (1.0 / 9007199254740992.0);
+                }
+
+                std::atomic<uint64_t> m_suppressed{ 0 };
+            };
+        }
+    }
+}
+
+// 限频 / 采样日志宏：level 为级别名（Trace、Debug、Info、Warn、Error、Fatal）
+// 先检查级别，再更新调用点状态；输出时在消息末尾附带被抑制的条数
+#define LIKESPROGRAM_LOG_RATE(level, State, param, msg, ...) do { \
+        constexpr LikesProgram::Log::Level likesLevel = LikesProgram::Log::Level::level; \
+        if (static_cast<int>(likesLevel) >= LIKESPROGRAM_LOG_MIN_LEVEL && LikesProgram::Log::Logger::ShouldLog(likesLevel)) { \
+            static State likesRateState; \
+            uint64_t likesSuppressed = 0; \
+            if (likesRateState.Acquire(param, likesSuppressed)) \
+                LikesProgram::Log::Logger::Instance().LogSuppressed(likesLevel, std::source_location::current(), likesSuppressed, msg, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LogEveryN(level, n, msg, ...)            LIKESPROGRAM_LOG_RATE(level, LikesProgram::Log::RateLimit::EveryN, n, msg, ##__VA_ARGS__)
+#define LogFirstN(level, n, msg, ...)            LIKESPROGRAM_LOG_RATE(level, LikesProgram::Log::RateLimit::FirstN, n, msg, ##__VA_ARGS__)
+#define LogEveryMs(level, ms, msg, ...)          LIKESPROGRAM_LOG_RATE(level, LikesProgram::Log::RateLimit::EveryMs, ms, msg, ##__VA_ARGS__)
+#define LogSampled(level, probability, msg, ...) LIKESPROGRAM_LOG_RATE(level, LikesProgram::Log::RateLimit::Sampled, probability, msg, ##__VA_ARGS__)
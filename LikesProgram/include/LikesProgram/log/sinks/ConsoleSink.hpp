@@ -9,6 +9,8 @@ namespace LikesProgram {
             static std::shared_ptr<Sink> CreateSink();
 
             void Write(const Message& message) override;
+            // 整批格式化后一次写出（Windows 下按相同级别的连续日志分段设置颜色）
+            void WriteBatch(std::span<const Message> messages) override;
         };
 	}
 }
\ No newline at end of file
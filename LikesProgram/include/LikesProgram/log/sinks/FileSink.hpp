@@ -1,19 +1,36 @@
 ﻿#pragma once
 #include "Sink.hpp"
+#include <chrono>
 
 namespace LikesProgram {
 	namespace Log {
         class FileSink : public Sink {
         public:
+            // 配置选项
+            struct Options {
+                size_t maxFileSizeMB = 30; // 单文件最大容量（MB），按写入字节数计算；0 表示不按大小切分
+                size_t flushBytes = 0;     // 用户态缓冲累计达到该字节数才写入文件；0 表示每批写入
+                std::chrono::milliseconds flushInterval{ 0 }; // 缓冲内容最长保留时间，由后台线程定时写入；0 表示不定时
+                Level flushLevel = Level::Error;              // 遇到不低于该级别的日志立即写入
+                std::chrono::milliseconds fsyncInterval{ 0 }; // 后台 fsync 间隔；0 表示不主动 fsync
+            };
+
             // 构造
             explicit FileSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB = 30);
+            FileSink(const LikesProgram::String& path, const LikesProgram::String& filename, const Options& options);
             ~FileSink();
 
             // 重写输出函数
             void Write(const Message& message) override;
+            // 整批格式化到缓冲区后一次写入文件
+            void WriteBatch(std::span<const Message> messages) override;
 
             // 构建工厂
             static std::shared_ptr<Sink> CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB = 30);
+            static std::shared_ptr<Sink> CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, const Options& options);
+
+            // 将缓冲内容写入文件
+            void Flush();
         private:
             class FileSinkImpl;
             FileSinkImpl* m_impl;
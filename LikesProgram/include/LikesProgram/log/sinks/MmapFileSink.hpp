@@ -0,0 +1,31 @@
+﻿#pragma once
+#include "Sink.hpp"
+
+namespace LikesProgram {
+	namespace Log {
+        // 内存映射文件输出：预分配固定大小的日志分段并映射到内存，写入只是一次内存拷贝。
+        // 写入位置由原子游标分配，多个线程可无锁并发写入；分段写满后切换到后台预先准备好的下一个分段，
+        // 旧分段由后台线程截断到实际长度并关闭。
+        class LIKESPROGRAM_API MmapFileSink : public Sink {
+        public:
+            // maxFileSizeMB 为每个分段的大小（为 0 时使用 30MB）
+            explicit MmapFileSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB = 30);
+            ~MmapFileSink();
+
+            void Write(const Message& message) override;
+            void WriteBatch(std::span<const Message> messages) override;
+
+            // 将当前分段已写入的内容同步到磁盘
+            void Flush();
+
+            // 无法创建新分段时丢弃的日志条数（后台准备好新分段后自动恢复写入）
+            uint64_t DroppedCount() const;
+
+            // 构建工厂
+            static std::shared_ptr<Sink> CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB = 30);
+        private:
+            class MmapFileSinkImpl;
+            MmapFileSinkImpl* m_impl;
+        };
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "../../system/LikesProgramLibExport.hpp"
 #include "../LoggerType.hpp"
+#include <span>
 
 namespace LikesProgram {
 	namespace Log {
@@ -12,9 +13,17 @@ namespace LikesProgram {
 
             // 写日志接口
             virtual void Write(const Message& message) = 0;
+
+            // 批量写日志接口（日志线程每次取出一批调用），默认逐条调用 Write
+            // 重写后可将整批格式化到同一缓冲区，一次系统调用写出
+            virtual void WriteBatch(std::span<const Message> messages);
         protected:
             // 格式化日志内容
             const String FormatLogMessage(const Message& message);
+            // 格式化日志内容并以 UTF-8 追加到 out（可复用调用方的缓冲区）
+            void FormatLogMessageTo(std::u8string& out, const Message& message);
+            // 格式化日志内容并按 message.encoding 编码后追加到 out
+            void AppendEncodedLogMessage(std::u8string& out, const Message& message);
         private:
             String m_sinkName;
         };
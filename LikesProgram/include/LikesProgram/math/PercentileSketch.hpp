@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
+#include <cstdint>
+#include <span>
 #include <vector>
 #include <shared_mutex>
 
@@ -7,7 +9,13 @@ namespace LikesProgram {
     namespace Math {
         class LIKESPROGRAM_API PercentileSketch {
         public:
-            explicit PercentileSketch(size_t compression = 400, size_t shards = 8);
+            // 写入方式
+            enum class Ingest {
+                Shared,     // 每次 Add 持分片锁写入分片缓存
+                ThreadLocal // 每个线程写入自己的定长缓冲（无锁），写满后整体交给分片；Quantile 等读取前合并所有线程缓冲
+            };
+
+            explicit PercentileSketch(size_t compression = 400, size_t shards = 8, Ingest ingest = Ingest::Shared);
             // 拷贝构造 & 拷贝赋值
             PercentileSketch(const PercentileSketch& other);
             PercentileSketch& operator=(const PercentileSketch& other);
@@ -22,17 +30,26 @@ namespace LikesProgram {
             double Quantile(double q) const;
             void Compress();
 
-            // 分布式/并行支持
+            // 分布式/并行支持：按均值有序的质心数组线性归并，保留质心权重
             void Merge(const PercentileSketch& other);
 
             // 序列化（小端二进制）
             void Serialize(std::ostream& os) const;
             static PercentileSketch Deserialize(std::istream& is);
 
+            // 紧凑二进制格式（带版本号）：合并各分片后压缩，均值按序差分编码，计数为 varint；追加到 out 末尾
+            void SerializeTo(std::vector<uint8_t>& out) const;
+            // 直接从字节区间解析，格式错误时抛出 std::runtime_error
+            static PercentileSketch Deserialize(std::span<const uint8_t> data);
+            // 将 SerializeTo 的数据直接合并到当前实例，不构造中间实例
+            void MergeSerialized(std::span<const uint8_t> data);
+
             // 调试/监控
             std::vector<std::pair<double, int>> GetCentroids() const;
 
             void Reset();
+
+            Ingest GetIngest() const;
         private:
             struct Centroid {
                 double mean;
@@ -50,9 +67,24 @@ namespace LikesProgram {
             size_t m_compression;
             size_t m_shards;
 
+            struct ThreadBuffer;
             struct PercentileSketchImpl;
             PercentileSketchImpl* m_impl;
 
+            // 当前线程在本实例中的缓冲（首次调用时创建或复用闲置缓冲；线程退出过程中返回 nullptr）
+            ThreadBuffer* LocalBuffer();
+            // 将缓冲中的值交给所属分片（调用方持有该分片的独占锁）
+            void drainBuffer(ThreadBuffer& buffer, Shard& shard) const;
+            // 合并所有线程缓冲到各分片（ThreadLocal 模式）
+            void drainThreadBuffers() const;
+
+            // 收集所有分片的质心（含分片缓存中的值），返回观测总数
+            int collectCentroids(std::vector<Centroid>& out) const;
+            // 将按均值有序的质心线性归并到第 0 个分片
+            void mergeSorted(std::vector<Centroid>& incoming, int incomingCount);
+            // 解析紧凑二进制格式
+            static void decodeCentroids(std::span<const uint8_t> data, size_t& compression, std::vector<Centroid>& out, int& totalCount);
+
             void flushShard(Shard& shard);
             static void compressCentroids(std::vector<Centroid>& centroids, size_t compression);
         };
@@ -1,22 +1,31 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
 #include "Metrics.hpp"
+#include <concepts>
+#include <cstdint>
 
 namespace LikesProgram {
 	namespace Metrics {
         class LIKESPROGRAM_API Counter : public MetricsObject {
 		public:
 			Counter(const LikesProgram::String& name, const LikesProgram::String& help = u"",
-				const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
+				const std::map<LikesProgram::String, LikesProgram::String>& labels = {},
+				Storage storage = Storage::Single);
             Counter(const Counter& other);
             Counter& operator=(const Counter& other);
 			Counter(Counter&& other) noexcept;
             Counter& operator=(Counter&& other) noexcept;
 			~Counter() override;
 
-            void Increment(double value = 1.0);
+            // 整数增量走 fetch_add 快路径，非整数增量走 double 单元
+            void Increment();
+            void Increment(double value);
+            template <std::integral T>
+            void Increment(T value) { IncrementInteger(static_cast<int64_t>(value)); }
 			double Value() const;
 
+            Storage GetStorage() const;
+
 			void Reset() override;
 
 			LikesProgram::String Name() const override;
@@ -25,7 +34,10 @@ namespace LikesProgram {
 			LikesProgram::String Type() const override;
             LikesProgram::String ToPrometheus() const override;
             LikesProgram::String ToJson() const override;
+            void Collect(MetricData& data) const override;
 		private:
+			void IncrementInteger(int64_t value);
+
 			struct CounterImpl;
 			CounterImpl* m_impl;
         };
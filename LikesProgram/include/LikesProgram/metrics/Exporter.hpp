@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include "../net/Buffer.hpp"
+#include "Registry.hpp"
+#include <string>
+
+namespace LikesProgram {
+	namespace Metrics {
+        // 流式导出：持锁拷贝 Registry 中的指标指针后逐个写出 UTF-8，不拼接整段 String。
+        // 同名指标（如 MetricVec 的子指标）合并为一个指标族，只输出一次 HELP / TYPE。
+        // 输出按块（约 64KB）写入目标；同一 Exporter 实例不可被多个线程同时使用。
+        class LIKESPROGRAM_API Exporter {
+        public:
+            enum class Format {
+                Prometheus,  // Prometheus 文本格式 0.0.4
+                OpenMetrics, // OpenMetrics 1.0 文本格式（以 # EOF 结尾）
+                Protobuf     // io.prometheus.client.MetricFamily，按 varint 长度分隔
+            };
+
+            explicit Exporter(Format format = Format::Prometheus);
+            ~Exporter();
+
+            Exporter(const Exporter&) = delete;
+            Exporter& operator=(const Exporter&) = delete;
+
+            Format GetFormat() const;
+
+            // 对应格式的 HTTP Content-Type
+            const char* ContentType() const;
+
+            // 追加到 out 末尾
+            void Export(Registry& registry, std::u8string& out);
+            void Export(Registry& registry, Net::Buffer& out);
+
+            // 写入文件描述符，全部写出返回 true
+            bool Export(Registry& registry, int fd);
+
+        private:
+            struct ExporterImpl;
+            ExporterImpl* m_impl;
+        };
+	}
+}
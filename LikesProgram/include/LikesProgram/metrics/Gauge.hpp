@@ -1,13 +1,16 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
 #include "Metrics.hpp"
+#include <concepts>
+#include <cstdint>
 
 namespace LikesProgram {
 	namespace Metrics {
         class LIKESPROGRAM_API Gauge : public MetricsObject {
         public:
             Gauge(const LikesProgram::String& name, const LikesProgram::String& help = u"",
-                const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
+                const std::map<LikesProgram::String, LikesProgram::String>& labels = {},
+                Storage storage = Storage::Single);
             Gauge(const Gauge& other);
             Gauge& operator=(const Gauge& other);
             Gauge(Gauge&& other) noexcept;
@@ -16,10 +19,19 @@ namespace LikesProgram {
             
             void Set(double value);
 
-            void Increment(double value = 1.0);
-            void Decrement(double value = 1.0);
+            // 整数增减走 fetch_add 快路径，非整数增减走 double 单元
+            void Increment();
+            void Increment(double value);
+            template <std::integral T>
+            void Increment(T value) { IncrementInteger(static_cast<int64_t>(value)); }
+            void Decrement();
+            void Decrement(double value);
+            template <std::integral T>
+            void Decrement(T value) { IncrementInteger(-static_cast<int64_t>(value)); }
             double Value() const;
 
+            Storage GetStorage() const;
+
             void Reset() override;
 
             LikesProgram::String Name() const override;
@@ -28,8 +40,11 @@ namespace LikesProgram {
             LikesProgram::String Type() const override;
             LikesProgram::String ToPrometheus() const override;
             LikesProgram::String ToJson() const override;
+            void Collect(MetricData& data) const override;
 
         private:
+            void IncrementInteger(int64_t value);
+
             struct GaugeImpl;
             GaugeImpl* m_impl;
         };
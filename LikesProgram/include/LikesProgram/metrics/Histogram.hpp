@@ -2,14 +2,39 @@
 #include "../system/LikesProgramLibExport.hpp"
 #include "Metrics.hpp"
 #include "../time/Timer.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace LikesProgram {
 	namespace Metrics {
 		class LIKESPROGRAM_API Histogram : public MetricsObject {
 		public:
+			// 桶布局：Linear / Exponential / LogLinear 可 O(1) 计算桶下标，Custom 为任意边界（二分查找）
+			struct BucketLayout {
+				enum class Kind { Custom, Linear, Exponential, LogLinear };
+				Kind kind = Kind::Custom;
+				std::vector<double> bounds; // 升序的桶上界（不含 +Inf）
+				double start = 0.0;         // 第一个桶上界
+				double step = 0.0;          // Linear 为桶宽，Exponential 为倍率
+				size_t subBuckets = 0;      // LogLinear 每个 2 倍区间内的线性子桶数
+			};
+
+			// 线性桶：start, start + width, ... 共 count 个
+			static BucketLayout Linear(double start, double width, size_t count);
+			// 指数桶：start, start * factor, ... 共 count 个
+			static BucketLayout Exponential(double start, double factor, size_t count);
+			// 对数-线性桶（HDR 风格）：从 start 起的 octaves 个 2 倍区间，每个区间等分为 subBuckets 个桶
+			static BucketLayout LogLinear(double start, size_t octaves, size_t subBuckets);
+
 			Histogram(const LikesProgram::String& name, const std::vector<double>& buckets,
 				const LikesProgram::String& help = u"",
-				const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
+				const std::map<LikesProgram::String, LikesProgram::String>& labels = {},
+				Storage storage = Storage::Single);
+			Histogram(const LikesProgram::String& name, const BucketLayout& layout,
+				const LikesProgram::String& help = u"",
+				const std::map<LikesProgram::String, LikesProgram::String>& labels = {},
+				Storage storage = Storage::Single);
 			Histogram(const Histogram& other);
 			Histogram& operator=(const Histogram& other);
 			Histogram(Histogram&& other) noexcept;
@@ -20,14 +45,23 @@ namespace LikesProgram {
 			void Observe(double value);
 			void ObserveDuration(const LikesProgram::Time::Timer& timer);
 
+			// value 所在桶的下标，Buckets().size() 表示 +Inf 桶
+			size_t BucketIndex(double value) const;
+
+			// 批量合并：bucketCounts 为各桶的非累计计数（长度 Buckets().size() + 1，最后一个为 +Inf 桶），sum 为这些观测值之和
+			void Merge(std::span<const int64_t> bucketCounts, double sum);
+
 			std::vector<double> Buckets() const;
 
+			// 各桶的累计计数（小于等于对应上界的观测数）
 			std::vector<int64_t> Counts() const;
 
 			int64_t Count() const;
 
 			double Sum() const;
 
+			Storage GetStorage() const;
+
 			void Reset() override;
 
 			LikesProgram::String Name() const override;
@@ -36,6 +70,7 @@ namespace LikesProgram {
 			LikesProgram::String Type() const override { return u"histogram"; }
 			LikesProgram::String ToPrometheus() const override;
 			LikesProgram::String ToJson() const override;
+			void Collect(MetricData& data) const override;
 
 		private:
 			struct HistogramImpl;
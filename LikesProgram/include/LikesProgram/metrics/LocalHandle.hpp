@@ -0,0 +1,143 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include "Counter.hpp"
+#include "Histogram.hpp"
+#include "Summary.hpp"
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace LikesProgram {
+	namespace Metrics {
+        // 线程本地指标句柄：更新只写本线程的缓冲（单写者，relaxed 读写，无原子读改写），
+        // 按 flushInterval 由本线程合并到共享指标，Registry 导出时也会合并所有存活句柄。
+        // 每个句柄只能由一个线程更新（通常声明为 thread_local 或作为工作线程的成员），Flush 可由任意线程调用。
+        class LIKESPROGRAM_API LocalHandle {
+        public:
+            struct Options {
+                std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000); // 本线程合并间隔
+                size_t bufferSize = 256; // LocalSummary 缓冲的观测值个数，写满时立即合并
+            };
+
+            virtual ~LocalHandle();
+
+            LocalHandle(const LocalHandle&) = delete;
+            LocalHandle& operator=(const LocalHandle&) = delete;
+
+            // 将尚未合并的更新合并到共享指标
+            void Flush();
+
+            // 合并所有存活的句柄（Registry 导出前调用）
+            static void FlushAll();
+
+        protected:
+            explicit LocalHandle(const Options& options);
+
+            // 派生类析构时先调用：从全局列表移除并合并剩余更新
+            void Detach();
+
+            // 每次更新后调用，每 64 次检查一次是否到达合并间隔
+            void Tick() {
+                if ((++m_ops & (CheckEvery - 1)) == 0) MaybeFlush();
+            }
+
+            // 合并尚未合并的更新（调用方持有 m_flushMutex）
+            virtual void FlushPending() = 0;
+
+            Options m_options;
+
+        private:
+            static constexpr uint32_t CheckEvery = 64;
+
+            void MaybeFlush();
+
+            std::mutex m_flushMutex;
+            uint32_t m_ops = 0;
+            std::chrono::steady_clock::time_point m_nextFlush;
+            bool m_attached = false;
+        };
+
+        class LIKESPROGRAM_API LocalCounter : public LocalHandle {
+        public:
+            explicit LocalCounter(std::shared_ptr<Counter> counter, const Options& options = Options());
+            ~LocalCounter() override;
+
+            void Increment() { AddInteger(1); }
+            void Increment(double value) {
+                m_real.store(m_real.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+                Tick();
+            }
+            template <std::integral T>
+            void Increment(T value) { AddInteger(static_cast<int64_t>(value)); }
+
+        private:
+            void AddInteger(int64_t value) {
+                m_integer.store(m_integer.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+                Tick();
+            }
+
+            void FlushPending() override;
+
+            std::shared_ptr<Counter> m_counter;
+            std::atomic<int64_t> m_integer{ 0 }; // 本线程累计（只增不清零，合并时取与上次合并的差值）
+            std::atomic<double> m_real{ 0.0 };
+            int64_t m_flushedInteger = 0;
+            double m_flushedReal = 0.0;
+        };
+
+        class LIKESPROGRAM_API LocalHistogram : public LocalHandle {
+        public:
+            explicit LocalHistogram(std::shared_ptr<Histogram> histogram, const Options& options = Options());
+            ~LocalHistogram() override;
+
+            // value 单位为 秒
+            void Observe(double value) {
+                std::atomic<int64_t>& count = m_counts[m_histogram->BucketIndex(value)];
+                count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                // 先计数后累加和（release）：刷新时读到的和所含的观测，其计数也一定可见
+                m_sum.store(m_sum.load(std::memory_order_relaxed) + value, std::memory_order_release);
+                Tick();
+            }
+            void ObserveDuration(const LikesProgram::Time::Timer& timer);
+
+        private:
+            void FlushPending() override;
+
+            std::shared_ptr<Histogram> m_histogram;
+            std::unique_ptr<std::atomic<int64_t>[]> m_counts; // 各桶本线程累计（非累计分布，最后一个为 +Inf 桶）
+            std::atomic<double> m_sum{ 0.0 };
+            std::vector<int64_t> m_flushedCounts;
+            std::vector<int64_t> m_delta;
+            double m_flushedSum = 0.0;
+        };
+
+        class LIKESPROGRAM_API LocalSummary : public LocalHandle {
+        public:
+            explicit LocalSummary(std::shared_ptr<Summary> summary, const Options& options = Options());
+            ~LocalSummary() override;
+
+            void Observe(double value) {
+                uint64_t head = m_head.load(std::memory_order_relaxed);
+                if (head - m_tail.load(std::memory_order_acquire) >= m_capacity) {
+                    Flush(); // 缓冲已满，由本线程合并
+                }
+                m_values[head % m_capacity] = value;
+                m_head.store(head + 1, std::memory_order_release);
+                Tick();
+            }
+
+        private:
+            void FlushPending() override;
+
+            std::shared_ptr<Summary> m_summary;
+            size_t m_capacity;
+            std::unique_ptr<double[]> m_values; // 单生产者（本线程）/ 单消费者（持锁的合并方）环形缓冲
+            std::atomic<uint64_t> m_head{ 0 };
+            std::atomic<uint64_t> m_tail{ 0 };
+        };
+	}
+}
@@ -0,0 +1,97 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include "Counter.hpp"
+#include "Gauge.hpp"
+#include "Histogram.hpp"
+#include "Summary.hpp"
+#include "Registry.hpp"
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace LikesProgram {
+	namespace Metrics {
+        // 带标签的指标族：按标签值查找或创建子指标，子指标创建时注册到 Registry。
+        // 已存在的子指标查找无锁（不拼接字符串，只哈希标签值）；返回的引用在指标族生命周期内有效，可缓存后直接使用。
+        class LIKESPROGRAM_API MetricFamily {
+        public:
+            using Factory = std::function<std::shared_ptr<MetricsObject>(const std::map<LikesProgram::String, LikesProgram::String>& labels)>;
+
+            // registry 为空时子指标不注册
+            MetricFamily(std::vector<LikesProgram::String> labelNames, Factory factory, Registry* registry);
+            ~MetricFamily(); // 从 Registry 注销所有子指标
+
+            MetricFamily(const MetricFamily&) = delete;
+            MetricFamily& operator=(const MetricFamily&) = delete;
+
+            // 标签值按 labelNames 的顺序给出，个数不符时抛出 std::invalid_argument
+            MetricsObject& WithLabelValues(std::span<const LikesProgram::String> values);
+
+            // 子指标个数
+            size_t Size() const;
+
+            const std::vector<LikesProgram::String>& LabelNames() const;
+
+        private:
+            struct MetricFamilyImpl;
+            MetricFamilyImpl* m_impl;
+        };
+
+        template <typename T>
+        class MetricVec {
+        public:
+            T& WithLabelValues(std::initializer_list<LikesProgram::String> values) {
+                return static_cast<T&>(m_family.WithLabelValues(std::span<const LikesProgram::String>(values.begin(), values.size())));
+            }
+            T& WithLabelValues(std::span<const LikesProgram::String> values) {
+                return static_cast<T&>(m_family.WithLabelValues(values));
+            }
+
+            size_t Size() const { return m_family.Size(); }
+
+        protected:
+            MetricVec(std::vector<LikesProgram::String> labelNames, MetricFamily::Factory factory, Registry* registry)
+                : m_family(std::move(labelNames), std::move(factory), registry) { }
+
+            MetricFamily m_family;
+        };
+
+        class CounterVec : public MetricVec<Counter> {
+        public:
+            CounterVec(const LikesProgram::String& name, const LikesProgram::String& help, std::vector<LikesProgram::String> labelNames,
+                Storage storage = Storage::Single, Registry* registry = &Registry::Global())
+                : MetricVec<Counter>(std::move(labelNames), [name, help, storage](const std::map<LikesProgram::String, LikesProgram::String>& labels) {
+                    return std::make_shared<Counter>(name, help, labels, storage);
+                }, registry) { }
+        };
+
+        class GaugeVec : public MetricVec<Gauge> {
+        public:
+            GaugeVec(const LikesProgram::String& name, const LikesProgram::String& help, std::vector<LikesProgram::String> labelNames,
+                Storage storage = Storage::Single, Registry* registry = &Registry::Global())
+                : MetricVec<Gauge>(std::move(labelNames), [name, help, storage](const std::map<LikesProgram::String, LikesProgram::String>& labels) {
+                    return std::make_shared<Gauge>(name, help, labels, storage);
+                }, registry) { }
+        };
+
+        class HistogramVec : public MetricVec<Histogram> {
+        public:
+            HistogramVec(const LikesProgram::String& name, const Histogram::BucketLayout& layout, const LikesProgram::String& help,
+                std::vector<LikesProgram::String> labelNames, Storage storage = Storage::Single, Registry* registry = &Registry::Global())
+                : MetricVec<Histogram>(std::move(labelNames), [name, layout, help, storage](const std::map<LikesProgram::String, LikesProgram::String>& labels) {
+                    return std::make_shared<Histogram>(name, layout, help, labels, storage);
+                }, registry) { }
+        };
+
+        class SummaryVec : public MetricVec<Summary> {
+        public:
+            SummaryVec(const LikesProgram::String& name, size_t maxWindow, const LikesProgram::String& help,
+                std::vector<LikesProgram::String> labelNames, Registry* registry = &Registry::Global())
+                : MetricVec<Summary>(std::move(labelNames), [name, maxWindow, help](const std::map<LikesProgram::String, LikesProgram::String>& labels) {
+                    return std::make_shared<Summary>(name, maxWindow, help, labels);
+                }, registry) { }
+        };
+	}
+}
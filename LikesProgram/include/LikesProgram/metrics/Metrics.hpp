@@ -1,10 +1,42 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
 #include "../String.hpp"
+#include <cstdint>
 #include <map>
+#include <vector>
 
 namespace LikesProgram {
 	namespace Metrics {
+		// 数值型指标（Counter、Gauge、Histogram）的存储方式
+		enum class Storage {
+			Single,  // 单个原子变量，内存占用最小（默认）
+			Striped  // 按线程分散到多个缓存行对齐的单元，读取时求和，适合多核高频更新
+		};
+
+		// 结构化的指标数据，供流式导出（Exporter）使用；各容器在多次 Collect 之间复用容量
+		struct MetricData {
+			enum class Kind { Unknown, Counter, Gauge, Histogram, Summary };
+			Kind kind = Kind::Unknown;
+			double value = 0.0;                  // Counter / Gauge
+			std::vector<double> bounds;          // Histogram 桶上界（不含 +Inf）
+			std::vector<int64_t> counts;         // Histogram 各桶累计计数
+			std::vector<double> quantiles;       // Summary 分位点
+			std::vector<double> quantileValues;  // Summary 分位值
+			int64_t count = 0;                   // Histogram / Summary 观测次数
+			double sum = 0.0;                    // Histogram / Summary 观测值之和
+
+			void Clear() {
+				kind = Kind::Unknown;
+				value = 0.0;
+				bounds.clear();
+				counts.clear();
+				quantiles.clear();
+				quantileValues.clear();
+				count = 0;
+				sum = 0.0;
+			}
+		};
+
 		class LIKESPROGRAM_API MetricsObject {
 		public:
 			MetricsObject(const LikesProgram::String& name = u"", const LikesProgram::String& help = u"",
@@ -21,6 +53,14 @@ namespace LikesProgram {
 			virtual LikesProgram::String ToPrometheus() const = 0;
 			virtual LikesProgram::String ToJson() const = 0;
 
+			// 填充结构化数据（data 已被 Clear），未实现的指标类型保持 Kind::Unknown，导出时回退到 ToPrometheus
+			virtual void Collect(MetricData& data) const;
+
+			// 以引用方式访问名称、说明与标签，导出时避免拷贝
+			const LikesProgram::String& NameRef() const noexcept;
+			const LikesProgram::String& HelpRef() const noexcept;
+			const std::map<LikesProgram::String, LikesProgram::String>& LabelsRef() const noexcept;
+
 			MetricsObject(const MetricsObject& other);
 			MetricsObject& operator=(const MetricsObject& other);
 			MetricsObject(MetricsObject&& other) noexcept;
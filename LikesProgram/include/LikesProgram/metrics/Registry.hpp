@@ -2,6 +2,8 @@
 #include "../system/LikesProgramLibExport.hpp"
 #include "../String.hpp"
 #include "Metrics.hpp"
+#include <memory>
+#include <vector>
 
 namespace LikesProgram {
 	namespace Metrics {
@@ -28,6 +30,9 @@ namespace LikesProgram {
 
             std::shared_ptr<MetricsObject> GetMetrics(const LikesProgram::String& name, const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
 
+            // 当前注册的全部指标（持锁拷贝指针，遍历时不持锁）
+            std::vector<std::shared_ptr<MetricsObject>> Snapshot() const;
+
             LikesProgram::String ExportPrometheus();
             LikesProgram::String ExportJson();
 
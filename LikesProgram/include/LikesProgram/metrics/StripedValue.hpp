@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "Metrics.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace LikesProgram {
+	namespace Metrics {
+        // Striped 存储的分片数：不小于核数的 2 的幂（上限 256），Single 为 1
+        inline size_t StripeCount(Storage storage) noexcept {
+            size_t count = 1;
+            if (storage == Storage::Striped) {
+                size_t cores = std::thread::hardware_concurrency();
+                while (count < cores && count < 256) count <<= 1;
+            }
+            return count;
+        }
+
+        // 当前线程的分片序号：线程首次访问时按顺序分配，相邻线程落在不同分片（使用时与分片数掩码）
+        inline size_t ThreadStripe() noexcept {
+            static std::atomic<size_t> next{ 0 };
+            thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+        // Counter / Gauge 的内部存储（不导出，仅供指标实现使用）
+        // 整数增量走 fetch_add，非整数增量落在 double 单元上；Striped 模式下每个线程固定落在一个单元，读取时求和
+        class StripedValue {
+        public:
+            explicit StripedValue(Storage storage = Storage::Single) : m_storage(storage) {
+                size_t count = StripeCount(storage);
+                m_cells = std::make_unique<Cell[]>(count);
+                m_mask = count - 1;
+            }
+
+            void Add(int64_t value) noexcept {
+                Current().integer.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            void Add(double value) noexcept {
+                Current().real.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            double Sum() const noexcept {
+                int64_t integer = 0;
+                double real = 0.0;
+                for (size_t i = 0; i <= m_mask; ++i) {
+                    integer += m_cells[i].integer.load(std::memory_order_relaxed);
+                    real += m_cells[i].real.load(std::memory_order_relaxed);
+                }
+                return static_cast<double>(integer) + real;
+            }
+
+            // 覆盖为指定值（与并发的 Add 之间不是原子的，多单元时可能丢失同时发生的增量）
+            void Set(double value) noexcept {
+                for (size_t i = 0; i <= m_mask; ++i) {
+                    m_cells[i].integer.store(0, std::memory_order_relaxed);
+                    m_cells[i].real.store(i == 0 ? value : 0.0, std::memory_order_relaxed);
+                }
+            }
+
+            Storage GetStorage() const noexcept { return m_storage; }
+
+        private:
+            struct alignas(64) Cell {
+                std::atomic<int64_t> integer{ 0 };
+                std::atomic<double> real{ 0.0 };
+            };
+
+            Cell& Current() noexcept {
+                if (m_mask == 0) return m_cells[0];
+                return m_cells[ThreadStripe() & m_mask];
+            }
+
+            Storage m_storage;
+            std::unique_ptr<Cell[]> m_cells;
+            size_t m_mask = 0;
+        };
+	}
+}
@@ -2,6 +2,7 @@
 #include "../system/LikesProgramLibExport.hpp"
 #include "../math/PercentileSketch.hpp"
 #include "Metrics.hpp"
+#include <chrono>
 
 namespace LikesProgram {
 	namespace Metrics {
@@ -10,6 +11,11 @@ namespace LikesProgram {
             Summary(const LikesProgram::String& name,
                 size_t maxWindow = 1000, const LikesProgram::String& help = u"",
                 const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
+            // 滑动窗口：分位数只统计最近 bucketCount 个长度为 bucketDuration 的时间桶（如 6 × 10s），
+            // 过期的桶在下次写入时复用；Count/Sum/Min/Max 仍为累计值
+            Summary(const LikesProgram::String& name,
+                std::chrono::milliseconds bucketDuration, size_t bucketCount = 6, const LikesProgram::String& help = u"",
+                const std::map<LikesProgram::String, LikesProgram::String>& labels = {});
             Summary(const Summary& other);
             Summary& operator=(const Summary& other);
             Summary(Summary&& other) noexcept;
@@ -35,12 +41,16 @@ namespace LikesProgram {
 
             double Max() const;
 
+            // 是否为滑动窗口模式
+            bool IsWindowed() const;
+
             LikesProgram::String Name() const override;
             std::map<LikesProgram::String, LikesProgram::String> Labels() const override;
             LikesProgram::String Help() const override;
             LikesProgram::String Type() const override;
             LikesProgram::String ToPrometheus() const override;
             LikesProgram::String ToJson() const override;
+            void Collect(MetricData& data) const override;
 
         private:
             size_t m_maxWindow;
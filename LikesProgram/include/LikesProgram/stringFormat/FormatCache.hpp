@@ -0,0 +1,58 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include "../String.hpp"
+#include "FormatParser.hpp"
+#include <memory>
+
+namespace LikesProgram {
+    namespace Metrics {
+        class Counter;
+        class Registry;
+    }
+    namespace StringFormat {
+        // 运行时格式串的解析结果缓存（分片 LRU，线程安全）
+        // 日志等场景反复使用少量格式串，命中时直接复用已解析的 token 序列
+        class LIKESPROGRAM_API FormatCache {
+        public:
+            using Program = std::shared_ptr<const FormatParser::Result>;
+
+            static constexpr size_t DefaultCapacity = 1024; // 默认最多缓存的格式串数量
+            static constexpr size_t ShardCount = 16;        // 分片数，降低多线程锁竞争
+            static constexpr size_t MaxKeyLength = 1024;    // 超过该长度（码点）的格式串不缓存
+
+            explicit FormatCache(size_t capacity = DefaultCapacity);
+            ~FormatCache();
+
+            // 禁止拷贝和移动（计数器可能已注册到 Registry）
+            FormatCache(const FormatCache&) = delete;
+            FormatCache& operator=(const FormatCache&) = delete;
+            FormatCache(FormatCache&&) = delete;
+            FormatCache& operator=(FormatCache&&) = delete;
+
+            // 获取解析结果：命中时直接返回，未命中时解析并缓存
+            // 结果中的 FormatSpec 绑定到结果自带的格式串副本，不依赖 fmt 的生命周期
+            Program Get(const String& fmt);
+
+            // 设置容量（0 表示关闭缓存），超出部分立即淘汰
+            void SetCapacity(size_t capacity);
+            size_t Capacity() const;
+            // 当前缓存条目数
+            size_t Size() const;
+            // 清空缓存（计数器保留）
+            void Clear();
+
+            // 命中 / 未命中 / 淘汰次数
+            uint64_t Hits() const;
+            uint64_t Misses() const;
+            uint64_t Evictions() const;
+
+            // 将计数器注册到指定 Registry（likesprogram_format_cache_*）
+            void RegisterMetrics(Metrics::Registry& registry);
+            void UnregisterMetrics(Metrics::Registry& registry);
+
+        private:
+            struct FormatCacheImpl;
+            FormatCacheImpl* m_impl;
+        };
+    }
+}
@@ -2,6 +2,7 @@
 #include "../system/LikesProgramLibExport.hpp"
 #include "../String.hpp"
 #include "FormatParser.hpp"
+#include "FormatCache.hpp"
 #include "FormatSpec.hpp"
 #include <any>
 #include <functional>
@@ -52,6 +53,8 @@ namespace LikesProgram {
                         return String(U"{!type}");
                     }
                     };
+                // 覆盖内建类型时，编译期格式化路径需让位给注册表
+                if constexpr (ClassifyArg<std::remove_cvref_t<T>>() != ArgKind::Unsupported) MarkBuiltinFormattersOverridden();
                 std::unique_lock lock(m_impl->m_mutex);
                 m_impl->m_typeFormatters[std::type_index(typeid(T))] = std::move(wrapper);
             }
@@ -66,6 +69,9 @@ namespace LikesProgram {
             // 格式化
             String FormatAny(const String& fmt, const std::vector<Any>& args);
 
+            // 格式串解析缓存（单例的计数器已注册到 Metrics::Registry::Global()）
+            FormatCache& Cache();
+
         private: // 内部实现函数
 
             // 将一组参数（any）和一个 FormatSpec 渲染为 String
@@ -101,6 +107,7 @@ namespace LikesProgram {
                 mutable std::shared_mutex m_mutex;
                 std::unordered_map<std::string, UserFormatter> m_nameFormatters;
                 std::unordered_map<std::type_index, UserFormatter> m_typeFormatters;
+                FormatCache m_cache;
             };
             FormatInternalImpl* m_impl = nullptr;
         };
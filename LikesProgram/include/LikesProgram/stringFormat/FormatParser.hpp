@@ -8,10 +8,11 @@ namespace LikesProgram {
 	namespace StringFormat {
         class LIKESPROGRAM_API FormatParser {
         public:
-            // 解析单元
+            // 解析单元（可平凡拷贝，文本以区间引用格式串）
             struct Token {
                 bool isPlaceholder = false; // true 表示 {} 占位符
-                String literal;             // 普通文本或占位符原始内容
+                bool isInvalid = false;     // 占位符解析失败，格式化时输出 {!}
+                TextRange literal;          // 普通文本在格式串中的区间（转义 {{ / }} 只保留一个括号）
                 FormatSpec spec;            // 占位符解析后的规格信息
                 size_t position = 0;        // 格式串中起始位置，用于错误定位
             };
@@ -35,6 +36,7 @@ namespace LikesProgram {
 
             // 主解析入口
             // 解析整个格式字符串，返回解析结果（包含错误信息）
+            // 结果中的 FormatSpec 绑定到 fmt，读取其文本时 fmt 需仍然有效
             Result Parse(const String& fmt);
 
         private: // 内部工具函数
@@ -42,26 +44,26 @@ namespace LikesProgram {
             // 检查大括号是否匹配
             static bool ValidateBraces(const String& fmt);
 
-            // 提取下一个 {} 或文本片段
-            static bool ExtractNextToken(const String& fmt, size_t& pos, String& outContent, bool& outIsPlaceholder);
+            // 提取下一个 {} 或文本片段（区间 outRange 为文本或占位符内容）
+            static bool ExtractNextToken(const String& fmt, size_t& pos, TextRange& outRange, bool& outIsPlaceholder);
 
-            // 从占位符内容中解析 FormatSpec
-            static FormatSpec ParsePlaceholder(const String& inside);
+            // 从占位符内容 fmt[inside] 中解析 FormatSpec
+            static FormatSpec ParsePlaceholder(const String& fmt, TextRange inside);
 
             // 跳过空白
-            static void SkipSpaces(const String& s, size_t& i);
+            static void SkipSpaces(const String& s, size_t& i, size_t end);
 
             // 提取数字（用于 index / width / precision）
-            static std::optional<int> ParseNumber(const String& s, size_t& i);
+            static std::optional<int> ParseNumber(const String& s, size_t& i, size_t end);
 
-            // 提取填充字符（可能为 ' 或 " 包裹）
-            static String ParseFillChar(const String& s, size_t& i);
+            // 提取填充字符（可能为 ' 或 " 包裹），结果写入 spec
+            static bool ParseFillChar(const String& s, size_t& i, size_t end, FormatSpec& spec);
 
             // 检查是否为合法对齐符号
             static bool IsAlignChar(char32_t c);
 
             // 从 spec 内提取 [align][sign][#][0][width][.precision][type]
-            static void ParseFormatOptions(const String& s, size_t& i, FormatSpec& spec);
+            static void ParseFormatOptions(const String& s, size_t& i, size_t end, FormatSpec& spec);
 
             // 检查字符是否属于类型标识 (f, d, s, x 等)
             static bool IsTypeChar(char32_t c);
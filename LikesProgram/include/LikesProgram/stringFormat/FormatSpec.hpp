@@ -1,103 +1,146 @@
 ﻿#pragma once
 #include "../system/LikesProgramLibExport.hpp"
 #include <optional>
+#include <cstdint>
 #include "../String.hpp"
 
 namespace LikesProgram {
 	namespace StringFormat {
+        // 格式串中的一段文本（按码点计的偏移与长度）
+        struct TextRange {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+
+            bool Empty() const noexcept { return length == 0; }
+        };
+
         // 格式化规格 : {[index]:[fill][align][sign][#][0][width][.precision][type][typeExpand]}
+        // 可平凡拷贝的值类型：填充为单个码点，多字符填充、类型扩展与原始文本以区间引用格式串。
+        // 读取这些文本前需通过 Bind 绑定格式串（FormatParser::Parse 会绑定到传入的格式串）。
         class LIKESPROGRAM_API FormatSpec {
         public:
-            FormatSpec();
-            explicit FormatSpec(int idx, bool explicitIdx = false);
-            FormatSpec(const FormatSpec& other);
-            FormatSpec(FormatSpec&& other) noexcept;
-            ~FormatSpec();
-
-            FormatSpec& operator=(const FormatSpec& other);
-            FormatSpec& operator=(FormatSpec&& other) noexcept;
+            FormatSpec() = default;
+            explicit FormatSpec(int idx, bool explicitIdx = false) noexcept;
 
             // 重置
             void Reset() noexcept;
 
+            // 绑定格式串（区间引用的文本从该字符串读取，需保证其生命周期）
+            void Bind(const String& fmt) noexcept;
+
             // 获取参数索引
             int GetIndex() const noexcept;
 
             // 设置参数索引和是否显式指定
-            void SetIndex(int idx, bool explicitIdx = false);
+            void SetIndex(int idx, bool explicitIdx = false) noexcept;
 
             // 判断是否显式指定了参数索引
             bool HasExplicitIndex() const noexcept;
 
-            // 获取填充字符
-            const String& GetFill() const noexcept;
+            // 获取填充文本（多字符填充会解析转义）
+            String GetFill() const;
 
-            // 设置填充字符
-            void SetFill(const String& f);
+            // 获取单字符填充
+            char32_t GetFillChar() const noexcept;
+
+            // 是否为多字符填充
+            bool HasMultiCharFill() const noexcept;
+
+            // 设置单字符填充
+            void SetFill(char32_t fill) noexcept;
+
+            // 设置多字符填充（引号内的原文区间，可含转义）
+            void SetFill(TextRange quoted) noexcept;
 
             // 获取对齐方式（<、>、^）
             char32_t GetAlign() const noexcept;
 
             // 设置对齐方式
-            void SetAlign(char32_t a);
+            void SetAlign(char32_t a) noexcept;
 
             // 获取符号控制（+、-、空格）
             char32_t GetSign() const noexcept;
 
             // 设置符号控制
-            void SetSign(char32_t s);
+            void SetSign(char32_t s) noexcept;
 
             // 是否显示进制前缀（#）
             bool GetAlternateForm() const noexcept;
 
             // 设置是否显示进制前缀
-            void SetAlternateForm(bool show);
+            void SetAlternateForm(bool show) noexcept;
 
             // 是否启用零填充（0）
             bool GetZeroPad() const noexcept;
 
             // 设置是否启用零填充
-            void SetZeroPad(bool zero);
+            void SetZeroPad(bool zero) noexcept;
 
             // 获取最小输出宽度
             std::optional<int> GetWidth() const noexcept;
 
             // 设置最小输出宽度
-            void SetWidth(std::optional<int> w);
+            void SetWidth(std::optional<int> w) noexcept;
 
             // 获取输出精度（用于浮点或字符串截断）
             std::optional<int> GetPrecision() const noexcept;
 
             // 设置输出精度
-            void SetPrecision(std::optional<int> p);
+            void SetPrecision(std::optional<int> p) noexcept;
 
             // 获取类型标识（如 d, f, x, s, t）
             char32_t GetType() const noexcept;
 
             // 设置类型标识
-            void SetType(char32_t t);
+            void SetType(char32_t t) noexcept;
 
             // 获取类型扩展说明（例如时间模板）
-            const String& GetTypeExpand() const noexcept;
+            String GetTypeExpand() const;
 
             // 设置类型扩展说明
-            void SetTypeExpand(const String& expand);
+            void SetTypeExpand(TextRange expand) noexcept;
 
             // 判断当前规格是否合法
             bool IsValid() const noexcept;
 
             // 设置格式是否有效
-            void SetValid(bool v);
+            void SetValid(bool v) noexcept;
 
             // 获取原始格式字符串
-            const String& GetRaw() const noexcept;
+            String GetRaw() const;
 
             // 设置原始格式字符串
-            void SetRaw(const String& raw);
+            void SetRaw(TextRange raw) noexcept;
+
+            // 转义字符映射（\n、\t、\r 等），用于引号填充
+            static char32_t Unescape(char32_t c) noexcept;
 
         private:
-            struct FormatSpecImpl;
-            FormatSpecImpl* impl = nullptr;
+            enum Flags : uint8_t {
+                ExplicitIndex = 1 << 0,  // 显式指定了 index
+                AlternateForm = 1 << 1,  // '#'，显示进制前缀
+                ZeroPad = 1 << 2,        // '0'，零填充
+                HasWidth = 1 << 3,
+                HasPrecision = 1 << 4,
+                Invalid = 1 << 5,        // 格式错误
+                MultiCharFill = 1 << 6   // 多字符填充（m_fillText 有效）
+            };
+
+            // 读取绑定格式串中的区间
+            String Slice(TextRange range) const;
+
+            const String* m_source = nullptr; // 绑定的格式串
+            TextRange m_fillText;             // 多字符填充（引号内原文）
+            TextRange m_typeExpand;           // 类型扩展描述（如时间模板）
+            TextRange m_raw;                  // 原始格式子串，便于调试或错误输出
+            int32_t m_index = -1;             // 参数索引（若为 -1 表示未指定）
+            int32_t m_width = 0;              // 输出最小宽度
+            int32_t m_precision = 0;          // 精度
+            char32_t m_fill = U' ';           // 单字符填充（默认空格）
+            uint8_t m_align = '>';            // 对齐方式：<' 左, >' 右, ^' 居中, 默认右对齐
+            uint8_t m_sign = 0;               // '+', '-', ' '，0 表示未指定
+            uint8_t m_type = 's';             // 数据类型标识：s, d, x, f, t 等
+            uint8_t m_flags = 0;
         };
 	}
 }
@@ -0,0 +1,434 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// 置 1 时，字面量格式串中的语法错误与越界索引会导致编译失败；
+// 默认按规范在运行时输出 {!} / {?}
+#ifndef LIKESPROGRAM_FORMAT_CHECKED
+#define LIKESPROGRAM_FORMAT_CHECKED 0
+#endif
+
+namespace LikesProgram {
+    class String;
+    namespace StringFormat {
+        // 编译后的格式片段（文本或占位符），可在编译期构造
+        struct CompiledToken {
+            enum class Kind : uint8_t { Literal, Argument, Missing };
+
+            Kind kind = Kind::Literal;
+            uint8_t argIndex = 0;         // 参数序号（Argument）
+            char8_t align = u8'>';        // 对齐方式：< > ^ =
+            char8_t type = u8's';         // 类型标识
+            char32_t fill = U' ';         // 填充字符（单个码点）
+            bool alternateForm = false;   // '#'
+            bool zeroPad = false;         // '0'
+            bool hasPrecision = false;    // 是否指定精度
+            uint16_t offset = 0;          // 文本在格式串中的起始单元（Literal）
+            uint16_t length = 0;          // 文本单元数（Literal）
+            uint16_t width = 0;           // 最小宽度（Argument）
+            uint16_t precision = 0;       // 精度（Argument）
+        };
+
+        // 参数类别：决定使用哪个写入器，Unsupported 表示交给运行时路径
+        enum class ArgKind : uint8_t { Unsupported, Signed, Unsigned, Float, Bool, Char, Text, Pointer };
+
+        template <typename T>
+        consteval ArgKind ClassifyArg() {
+            if constexpr (std::is_same_v<T, bool>) return ArgKind::Bool;
+            else if constexpr (std::is_same_v<T, short> || std::is_same_v<T, int> ||
+                std::is_same_v<T, long> || std::is_same_v<T, long long>) return ArgKind::Signed;
+            else if constexpr (std::is_same_v<T, unsigned int> || std::is_same_v<T, unsigned long> ||
+                std::is_same_v<T, unsigned long long>) return ArgKind::Unsigned;
+            else if constexpr (std::is_floating_point_v<T>) return ArgKind::Float;
+            else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, wchar_t> ||
+                std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>) return ArgKind::Char;
+            else if constexpr (std::is_same_v<T, String> ||
+                std::is_same_v<T, std::string> || std::is_same_v<T, std::wstring> ||
+                std::is_same_v<T, std::u16string> || std::is_same_v<T, std::u32string> ||
+                std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                std::is_same_v<T, const wchar_t*> || std::is_same_v<T, wchar_t*> ||
+                std::is_same_v<T, const char16_t*> || std::is_same_v<T, const char32_t*>) return ArgKind::Text;
+            else if constexpr (std::is_same_v<T, const void*> || std::is_same_v<T, void*>) return ArgKind::Pointer;
+            else return ArgKind::Unsupported;
+        }
+
+        // ---- 写入器：将单个值以 UTF-8 追加到 out ----
+        LIKESPROGRAM_API void WriteSigned(std::u8string& out, long long value, const CompiledToken& spec);
+        LIKESPROGRAM_API void WriteUnsigned(std::u8string& out, unsigned long long value, const CompiledToken& spec);
+        LIKESPROGRAM_API void WriteFloat(std::u8string& out, double value, const CompiledToken& spec);
+        LIKESPROGRAM_API void WritePointer(std::u8string& out, const void* value);
+        // 非法码点抛出 std::runtime_error
+        LIKESPROGRAM_API void WriteCodePoint(std::u8string& out, char32_t cp);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const char* text, size_t length);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const char8_t* text, size_t length);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const char16_t* text, size_t length);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const char32_t* text, size_t length);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const wchar_t* text, size_t length);
+        LIKESPROGRAM_API void WriteText(std::u8string& out, const String& text);
+        // 对 out[start, end) 应用宽度、填充与对齐
+        LIKESPROGRAM_API void ApplyAlignment(std::u8string& out, size_t start, const CompiledToken& spec);
+
+        // 当前线程复用的格式化缓冲区
+        LIKESPROGRAM_API std::u8string& ThreadFormatBuffer();
+        // 是否为内建类型注册过按类型的格式化器（此时编译期路径让位给运行时路径）
+        LIKESPROGRAM_API bool BuiltinFormattersOverridden() noexcept;
+        LIKESPROGRAM_API void MarkBuiltinFormattersOverridden() noexcept;
+        // 仅在 LIKESPROGRAM_FORMAT_CHECKED 下于编译期被引用，用于产生编译错误
+        LIKESPROGRAM_API void InvalidFormatString(const char* reason);
+
+        template <typename T>
+        void WriteArgument(std::u8string& out, const T& value, const CompiledToken& spec) {
+            constexpr ArgKind kind = ClassifyArg<T>();
+            if constexpr (kind == ArgKind::Signed) WriteSigned(out, static_cast<long long>(value), spec);
+            else if constexpr (kind == ArgKind::Unsigned) WriteUnsigned(out, static_cast<unsigned long long>(value), spec);
+            else if constexpr (kind == ArgKind::Float) WriteFloat(out, static_cast<double>(value), spec);
+            else if constexpr (kind == ArgKind::Bool) WriteText(out, value ? u8"true" : u8"false", value ? 4 : 5);
+            else if constexpr (kind == ArgKind::Char) WriteCodePoint(out, static_cast<char32_t>(value));
+            else if constexpr (kind == ArgKind::Pointer) WritePointer(out, value);
+            else if constexpr (kind == ArgKind::Text) {
+                if constexpr (std::is_pointer_v<T>) {
+                    if (value) WriteText(out, value, std::char_traits<std::remove_cv_t<std::remove_pointer_t<T>>>::length(value));
+                }
+                else if constexpr (std::is_same_v<T, String>) WriteText(out, value);
+                else WriteText(out, value.data(), value.size());
+            }
+            // Unsupported：格式串不会被编译，不会到达此处
+        }
+
+        // 编译期解析的格式串。
+        // 字面量在编译期完成解析与参数匹配；格式串为运行时 String、含不支持的语法
+        // （多字符填充、用户格式化器等）或参数类型不受支持时，IsCompiled() 为 false，由 FormatAny 处理。
+        template <typename... Args>
+        class BasicFormatString {
+        public:
+            static constexpr size_t MaxTokens = 16;
+
+            template <size_t N>
+            consteval BasicFormatString(const char8_t (&fmt)[N]) : m_data(fmt), m_length(N - 1), m_unitSize(1), m_tokens{} { Compile(fmt, N - 1); }
+            template <size_t N>
+            consteval BasicFormatString(const char16_t (&fmt)[N]) : m_data(fmt), m_length(N - 1), m_unitSize(2), m_tokens{} { Compile(fmt, N - 1); }
+            template <size_t N>
+            consteval BasicFormatString(const char32_t (&fmt)[N]) : m_data(fmt), m_length(N - 1), m_unitSize(4), m_tokens{} { Compile(fmt, N - 1); }
+            BasicFormatString(const String& fmt) noexcept : m_runtime(&fmt) {}
+
+            bool IsCompiled() const noexcept { return m_compiled; }
+            // 运行时格式串（字面量时为 nullptr）
+            const String* RuntimeString() const noexcept { return m_runtime; }
+            // 格式串本身（定义见 String.hpp）
+            String ToString() const;
+
+            // 按编译结果写入 UTF-8（仅 IsCompiled() 时可用）
+            void FormatTo(std::u8string& out, const Args&... args) const {
+                using Writer = void (*)(std::u8string&, const void*, const CompiledToken&);
+                const void* values[] = { static_cast<const void*>(&args)..., nullptr };
+                static constexpr Writer writers[] = { &WriteErased<Args>..., nullptr };
+
+                for (size_t t = 0; t < m_count; ++t) {
+                    const CompiledToken& token = m_tokens[t];
+                    switch (token.kind) {
+                    case CompiledToken::Kind::Literal:
+                        WriteLiteral(out, token);
+                        break;
+                    case CompiledToken::Kind::Missing:
+                        out.append(u8"{?}");
+                        break;
+                    case CompiledToken::Kind::Argument: {
+                        size_t start = out.size();
+                        writers[token.argIndex](out, values[token.argIndex], token);
+                        ApplyAlignment(out, start, token);
+                        break;
+                    }
+                    }
+                }
+            }
+
+        private:
+            template <typename T>
+            static void WriteErased(std::u8string& out, const void* value, const CompiledToken& spec) {
+                WriteArgument(out, *static_cast<const T*>(value), spec);
+            }
+
+            void WriteLiteral(std::u8string& out, const CompiledToken& token) const {
+                switch (m_unitSize) {
+                case 1: WriteText(out, static_cast<const char8_t*>(m_data) + token.offset, token.length); break;
+                case 2: WriteText(out, static_cast<const char16_t*>(m_data) + token.offset, token.length); break;
+                default: WriteText(out, static_cast<const char32_t*>(m_data) + token.offset, token.length); break;
+                }
+            }
+
+            // ---- 编译期解析（语义与 FormatParser + FormatInternal::FormatAny 一致） ----
+
+            // 语法错误：按规范由运行时输出 {!}；LIKESPROGRAM_FORMAT_CHECKED 时直接编译失败
+            consteval void Reject([[maybe_unused]] const char* reason) {
+                if constexpr (LIKESPROGRAM_FORMAT_CHECKED) InvalidFormatString(reason);
+                m_compiled = false;
+            }
+
+            static consteval bool IsAlignChar(char32_t c) { return c == U'<' || c == U'>' || c == U'^' || c == U'='; }
+            static consteval bool IsDigit(char32_t c) { return c >= U'0' && c <= U'9'; }
+            // 运行时按 wchar_t 计宽，16 位 wchar_t 下代理对填充字符交给运行时路径
+            static consteval bool FitsWChar(char32_t c) { return sizeof(wchar_t) >= 4 || c <= 0xFFFF; }
+            static consteval bool IsTypeChar(char32_t c) {
+                constexpr char32_t types[] = { U's', U'S', U'd', U'i', U'o', U'O', U'u', U'x', U'X', U'b', U'B',
+                    U'f', U'F', U'e', U'E', U'g', U'G', U'c', U'p', U'P', U't', U'T', U'%' };
+                for (char32_t t : types) if (c == t) return true;
+                return false;
+            }
+
+            // 解码 s[i] 开始的一个码点，返回单元数（0 表示非法序列）
+            template <typename CharT>
+            static consteval size_t DecodeAt(const CharT* s, size_t n, size_t i, char32_t& cp) {
+                char32_t c = static_cast<char32_t>(s[i]);
+                if constexpr (sizeof(CharT) == 1) {
+                    size_t len = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+                    if (len == 0 || i + len > n) return 0;
+                    cp = len == 1 ? c : c & (0xFF >> (len + 1));
+                    for (size_t j = 1; j < len; ++j) {
+                        char32_t cont = static_cast<char32_t>(s[i + j]);
+                        if ((cont & 0xC0) != 0x80) return 0;
+                        cp = (cp << 6) | (cont & 0x3F);
+                    }
+                    return len;
+                }
+                else if constexpr (sizeof(CharT) == 2) {
+                    if (c >= 0xDC00 && c <= 0xDFFF) return 0;
+                    if (c >= 0xD800 && c <= 0xDBFF) {
+                        if (i + 1 >= n) return 0;
+                        char32_t low = static_cast<char32_t>(s[i + 1]);
+                        if (low < 0xDC00 || low > 0xDFFF) return 0;
+                        cp = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                        return 2;
+                    }
+                    cp = c;
+                    return 1;
+                }
+                else {
+                    if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) return 0;
+                    cp = c;
+                    return 1;
+                }
+            }
+
+            consteval bool Push(const CompiledToken& token) {
+                if (m_count == MaxTokens) return false;
+                m_tokens[m_count++] = token;
+                return true;
+            }
+
+            template <typename CharT>
+            consteval bool PushLiteral(const CharT* s, size_t begin, size_t end) {
+                if (begin == end) return true;
+                // 文本需为合法编码，否则交给运行时路径
+                for (size_t i = begin; i < end;) {
+                    char32_t cp = 0;
+                    size_t len = DecodeAt(s, end, i, cp);
+                    if (len == 0) return false;
+                    i += len;
+                }
+                CompiledToken token;
+                token.offset = static_cast<uint16_t>(begin);
+                token.length = static_cast<uint16_t>(end - begin);
+                return Push(token);
+            }
+
+            template <typename CharT>
+            static consteval void SkipSpaces(const CharT* s, size_t& i, size_t end) {
+                while (i < end && (s[i] == U' ' || s[i] == U'\t')) ++i;
+            }
+
+            template <typename CharT>
+            static consteval bool ParseNumber(const CharT* s, size_t& i, size_t end, int& value) {
+                if (i >= end || !IsDigit(s[i])) return false;
+                value = 0;
+                while (i < end && IsDigit(s[i])) {
+                    if (value < 100000) value = value * 10 + static_cast<int>(s[i] - U'0');
+                    ++i;
+                }
+                return true;
+            }
+
+            // 解析占位符内容 s[begin, end)，成功时 explicitIndex < 0 表示自动索引
+            template <typename CharT>
+            consteval bool ParsePlaceholder(const CharT* s, size_t begin, size_t end, CompiledToken& token, int& explicitIndex) {
+                size_t i = begin;
+                explicitIndex = -1;
+                SkipSpaces(s, i, end);
+                int index = 0;
+                if (ParseNumber(s, i, end, index)) explicitIndex = index;
+                SkipSpaces(s, i, end);
+
+                if (i < end && s[i] == U':') {
+                    ++i;
+                    // 填充：仅支持单个码点（多字符或转义填充交给运行时路径）
+                    if (i < end && (s[i] == U'\'' || s[i] == U'"')) {
+                        CharT quote = s[i];
+                        char32_t cp = 0;
+                        size_t len = i + 1 < end && s[i + 1] != U'\\' ? DecodeAt(s, end, i + 1, cp) : 0;
+                        if (len == 0 || i + 1 + len >= end || s[i + 1 + len] != quote || cp == static_cast<char32_t>(quote)) return false;
+                        if (!FitsWChar(cp)) return false;
+                        token.fill = cp;
+                        i += len + 2;
+                    }
+                    else if (i < end) {
+                        char32_t cp = 0;
+                        size_t len = DecodeAt(s, end, i, cp);
+                        if (len == 0) return false;
+                        if (i + len < end && IsAlignChar(s[i + len])) {
+                            if (!FitsWChar(cp)) return false;
+                            token.fill = cp;
+                            i += len;
+                        }
+                    }
+                    if (i < end && IsAlignChar(s[i])) token.align = static_cast<char8_t>(s[i++]);
+                    if (i < end && (s[i] == U'+' || s[i] == U'-' || s[i] == U' ')) ++i; // 符号位不影响输出
+                    if (i < end && s[i] == U'#') { token.alternateForm = true; ++i; }
+                    if (i < end && s[i] == U'0') { token.zeroPad = true; ++i; }
+
+                    int width = 0;
+                    if (ParseNumber(s, i, end, width)) {
+                        if (width > 0x7FFF) return false;
+                        token.width = static_cast<uint16_t>(width);
+                    }
+                    if (i < end && s[i] == U'.') {
+                        ++i;
+                        int precision = 0;
+                        if (!ParseNumber(s, i, end, precision)) {
+                            Reject("invalid precision");
+                            return false;
+                        }
+                        if (precision > 0x7FFF) return false;
+                        token.hasPrecision = true;
+                        token.precision = static_cast<uint16_t>(precision);
+                    }
+                    if (i < end && IsTypeChar(s[i])) {
+                        token.type = static_cast<char8_t>(s[i]);
+                        if (token.type == u8'u') return false; // 命名格式化器
+                        i = end; // 类型扩展说明对内建写入器无影响
+                    }
+                }
+
+                SkipSpaces(s, i, end);
+                if (i != end) {
+                    Reject("invalid character in placeholder");
+                    return false;
+                }
+                return true;
+            }
+
+            template <typename CharT>
+            consteval void Compile(const CharT* s, size_t n) {
+                if (n > 0xFFFF) return;
+
+                // 括号匹配（与 FormatParser::ValidateBraces 一致）
+                int depth = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    if (s[i] == U'{') {
+                        if (i + 1 < n && s[i + 1] == U'{') { ++i; continue; }
+                        ++depth;
+                    }
+                    else if (s[i] == U'}') {
+                        if (i + 1 < n && s[i + 1] == U'}') { ++i; continue; }
+                        if (--depth < 0) break;
+                    }
+                }
+                if (depth != 0) {
+                    Reject("unmatched brace");
+                    return;
+                }
+
+                constexpr std::array<ArgKind, sizeof...(Args)> kinds = { ClassifyArg<Args>()... };
+                constexpr size_t argCount = sizeof...(Args);
+
+                // 第一遍：收集显式索引（FormatAny 中显式索引优先占用）
+                bool used[argCount + 1] = {};
+                int explicitIndices[MaxTokens] = {};
+                size_t placeholderCount = 0;
+
+                size_t pos = 0, literalStart = 0;
+                while (pos < n) {
+                    if (s[pos] == U'{' || s[pos] == U'}') {
+                        if (pos + 1 < n && s[pos + 1] == s[pos]) {
+                            // 转义 {{ / }}：保留一个括号
+                            if (!PushLiteral(s, literalStart, pos + 1)) return;
+                            pos += 2;
+                            literalStart = pos;
+                            continue;
+                        }
+                        if (s[pos] == U'}') { ++pos; continue; }
+
+                        if (!PushLiteral(s, literalStart, pos)) return;
+                        size_t close = pos + 1;
+                        while (close < n && s[close] != U'}') ++close;
+                        if (close >= n) {
+                            Reject("missing '}'");
+                            return;
+                        }
+
+                        CompiledToken token;
+                        token.kind = CompiledToken::Kind::Argument;
+                        int explicitIndex = -1;
+                        if (placeholderCount == MaxTokens || !ParsePlaceholder(s, pos + 1, close, token, explicitIndex)) return;
+                        if (explicitIndex >= 0 && static_cast<size_t>(explicitIndex) < argCount) used[explicitIndex] = true;
+                        explicitIndices[placeholderCount++] = explicitIndex;
+                        // 先占位，第二遍再确定参数
+                        if (!Push(token)) return;
+
+                        pos = close + 1;
+                        literalStart = pos;
+                        continue;
+                    }
+                    ++pos;
+                }
+                if (!PushLiteral(s, literalStart, n)) return;
+
+                // 第二遍：按 FormatAny 的规则分配自动索引并检查参数类型
+                size_t nextAuto = 0, p = 0;
+                for (size_t t = 0; t < m_count; ++t) {
+                    CompiledToken& token = m_tokens[t];
+                    if (token.kind != CompiledToken::Kind::Argument) continue;
+                    int explicitIndex = explicitIndices[p++];
+                    size_t chosen = argCount;
+                    if (explicitIndex >= 0) {
+                        if (static_cast<size_t>(explicitIndex) < argCount) chosen = static_cast<size_t>(explicitIndex);
+                    }
+                    else {
+                        while (nextAuto < argCount && used[nextAuto]) ++nextAuto;
+                        if (nextAuto < argCount) {
+                            chosen = nextAuto;
+                            used[nextAuto++] = true;
+                        }
+                    }
+
+                    if (chosen == argCount) {
+                        if constexpr (LIKESPROGRAM_FORMAT_CHECKED) InvalidFormatString("argument index out of range");
+                        token.kind = CompiledToken::Kind::Missing;
+                        continue;
+                    }
+                    if constexpr (argCount > 0) {
+                        ArgKind kind = kinds[chosen];
+                        if (kind == ArgKind::Unsupported) return;
+                        if (kind == ArgKind::Pointer && token.type != u8'p' && token.type != u8'P') return;
+                    }
+                    token.argIndex = static_cast<uint8_t>(chosen);
+                }
+                m_compiled = argCount < 0xFF;
+            }
+
+            const void* m_data = nullptr;       // 字面量格式串
+            size_t m_length = 0;                // 字面量单元数
+            const String* m_runtime = nullptr;  // 运行时格式串
+            uint8_t m_unitSize = 0;             // 字面量单元字节数（1/2/4）
+            bool m_compiled = false;
+            uint8_t m_count = 0;
+            CompiledToken m_tokens[MaxTokens];
+        };
+
+        // 以参数的退化类型实例化，使 String::Format 与 Logger::Log 之间可直接传递
+        template <typename... Args>
+        using FormatString = BasicFormatString<std::decay_t<Args>...>;
+    }
+}
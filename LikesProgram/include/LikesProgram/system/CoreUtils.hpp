@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "LikesProgramLibExport.hpp"
 #include "../String.hpp"
+#include <memory>
 
 namespace LikesProgram {
 	namespace CoreUtils {
@@ -10,6 +11,10 @@ namespace LikesProgram {
         // 获取当前线程名
 		LIKESPROGRAM_API LikesProgram::String GetCurrentThreadName();
 
+        // 获取当前线程名的共享副本：按线程缓存，SetCurrentThreadName 会使缓存失效，
+        // 通过系统 API 直接改名的情况每 256 次调用重新读取一次后生效。复制返回的指针即可跨线程保存
+		LIKESPROGRAM_API const std::shared_ptr<const LikesProgram::String>& GetCurrentThreadNameShared();
+
 		// 获取本机 MAC 地址
 		LIKESPROGRAM_API LikesProgram::String GetMACAddress();
 
@@ -0,0 +1,159 @@
+﻿#pragma once
+#include "../system/LikesProgramLibExport.hpp"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace LikesProgram {
+    // 任务内存池：按 64/128/256/512 字节分级复用内存块，每个线程缓存一批空闲块，
+    // 与全局池之间按批次交换，稳定运行时不触发堆分配；超过 512 字节直接走 operator new
+    namespace TaskPool {
+        LIKESPROGRAM_API void* Allocate(size_t bytes);
+        LIKESPROGRAM_API void Deallocate(void* ptr, size_t bytes) noexcept;
+
+        // 基于任务内存池的分配器（用于 std::promise 的共享状态等）
+        template<typename T>
+        class Allocator {
+        public:
+            using value_type = T;
+
+            Allocator() noexcept = default;
+            template<typename U>
+            Allocator(const Allocator<U>&) noexcept {}
+
+            T* allocate(size_t n) {
+                if constexpr (alignof(T) > alignof(std::max_align_t)) {
+                    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+                }
+                else {
+                    return static_cast<T*>(Allocate(n * sizeof(T)));
+                }
+            }
+
+            void deallocate(T* ptr, size_t n) noexcept {
+                if constexpr (alignof(T) > alignof(std::max_align_t)) {
+                    ::operator delete(ptr, std::align_val_t(alignof(T)));
+                }
+                else {
+                    Deallocate(ptr, n * sizeof(T));
+                }
+            }
+
+            template<typename U>
+            bool operator==(const Allocator<U>&) const noexcept { return true; }
+            template<typename U>
+            bool operator!=(const Allocator<U>&) const noexcept { return false; }
+        };
+    }
+
+    // 只可移动的 void() 任务：可调用对象不超过 InlineSize 字节且移动不抛异常时直接存放在内部缓冲区，
+    // 否则从任务内存池分配
+    class InplaceTask {
+    public:
+        static constexpr size_t InlineSize = 64;
+
+        InplaceTask() noexcept = default;
+
+        template<typename F, typename Fn = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same_v<Fn, InplaceTask> && std::is_invocable_v<Fn&>>>
+        InplaceTask(F&& f) {
+            if constexpr (IsInline<Fn>) {
+                ::new (static_cast<void*>(m_storage)) Fn(std::forward<F>(f));
+            }
+            else {
+                void* memory = TaskPool::Allocator<Fn>().allocate(1);
+                try {
+                    ::new (memory) Fn(std::forward<F>(f));
+                }
+                catch (...) {
+                    TaskPool::Allocator<Fn>().deallocate(static_cast<Fn*>(memory), 1);
+                    throw;
+                }
+                *reinterpret_cast<Fn**>(m_storage) = static_cast<Fn*>(memory);
+            }
+            m_ops = &OpsFor<Fn>;
+        }
+
+        InplaceTask(InplaceTask&& other) noexcept {
+            MoveFrom(other);
+        }
+
+        InplaceTask& operator=(InplaceTask&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+
+        InplaceTask(const InplaceTask&) = delete;
+        InplaceTask& operator=(const InplaceTask&) = delete;
+
+        ~InplaceTask() { Reset(); }
+
+        void operator()() { m_ops->invoke(m_storage); }
+
+        explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+        // 销毁内部可调用对象
+        void Reset() noexcept {
+            if (m_ops) {
+                m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+    private:
+        struct Ops {
+            void (*invoke)(void* storage);
+            void (*move)(void* dst, void* src) noexcept; // 移动到 dst 并销毁 src
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template<typename Fn>
+        static constexpr bool IsInline = sizeof(Fn) <= InlineSize && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+
+        template<typename Fn>
+        static Fn& Get(void* storage) noexcept {
+            if constexpr (IsInline<Fn>) return *std::launder(reinterpret_cast<Fn*>(storage));
+            else return **reinterpret_cast<Fn**>(storage);
+        }
+
+        template<typename Fn>
+        static constexpr Ops OpsFor = {
+            [](void* storage) { Get<Fn>(storage)(); },
+            [](void* dst, void* src) noexcept {
+                if constexpr (IsInline<Fn>) {
+                    Fn& from = Get<Fn>(src);
+                    ::new (dst) Fn(std::move(from));
+                    from.~Fn();
+                }
+                else {
+                    *reinterpret_cast<Fn**>(dst) = *reinterpret_cast<Fn**>(src); // 只转移指针
+                }
+            },
+            [](void* storage) noexcept {
+                if constexpr (IsInline<Fn>) {
+                    Get<Fn>(storage).~Fn();
+                }
+                else {
+                    Fn* fn = *reinterpret_cast<Fn**>(storage);
+                    fn->~Fn();
+                    TaskPool::Allocator<Fn>().deallocate(fn, 1);
+                }
+            }
+        };
+
+        void MoveFrom(InplaceTask& other) noexcept {
+            if (other.m_ops) {
+                other.m_ops->move(m_storage, other.m_storage);
+                m_ops = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+        const Ops* m_ops = nullptr;
+    };
+}
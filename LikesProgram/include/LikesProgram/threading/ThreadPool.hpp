@@ -3,6 +3,7 @@
 #include "../String.hpp"
 #include "../time/Time.hpp"
 #include "IThreadPoolObserver.hpp"
+#include "InplaceTask.hpp"
 #include <functional>
 #include <future>
 #include <chrono>
@@ -26,6 +27,11 @@ namespace LikesProgram {
             Drain,      // 立刻拒绝新任务；执行队列里已有任务；尽快退出（不清队列）
             CancelNow   // 立刻拒绝新任务；丢弃队列；尽快退出
         };
+        // 调度方式
+        enum class Scheduler {
+            SharedQueue,  // 所有任务进入同一个加锁队列
+            WorkStealing  // 每个工作线程一个本地双端队列 + 无锁全局注入队列，空闲线程随机窃取；工作线程内提交的任务留在本地
+        };
 
         // 配置选项
         struct Options {
@@ -37,16 +43,18 @@ namespace LikesProgram {
             bool allowDynamicResize = true; // 是否启用动态扩容/回收
             String threadNamePrefix = u"tp-worker-"; // 线程名前缀
             std::function<void(std::exception_ptr)> exceptionHandler = [](std::exception_ptr) {}; // 异常回调
+            Scheduler scheduler = Scheduler::SharedQueue; // 调度方式
             // 构造函数
             Options(size_t coreThreads = 0, size_t maxThreads = 0, size_t queueCapacity = 1024,
                 RejectPolicy rejectPolicy = RejectPolicy::Block,
                 std::chrono::milliseconds keepAlive = std::chrono::milliseconds(30000),
                 bool allowDynamicResize = true, String threadNamePrefix = u"tp-worker-",
-                std::function<void(std::exception_ptr)> exceptionHandler = [](std::exception_ptr) {})
+                std::function<void(std::exception_ptr)> exceptionHandler = [](std::exception_ptr) {},
+                Scheduler scheduler = Scheduler::SharedQueue)
                 : coreThreads(coreThreads ? coreThreads : (std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1)),
                 maxThreads(maxThreads ? maxThreads : (std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1)),
                 queueCapacity(queueCapacity), rejectPolicy(rejectPolicy), keepAlive(keepAlive), allowDynamicResize(allowDynamicResize),
-                threadNamePrefix(std::move(threadNamePrefix)), exceptionHandler(std::move(exceptionHandler)) {
+                threadNamePrefix(std::move(threadNamePrefix)), exceptionHandler(std::move(exceptionHandler)), scheduler(scheduler) {
             }
         };
 
@@ -92,49 +100,56 @@ namespace LikesProgram {
             -> std::future<std::invoke_result_t<F, Args...>> {
             using Ret = std::invoke_result_t<F, Args...>;
 
-            // 调用带有移动参数的fn的packaged_task（支持仅移动参数）
-            auto task = std::make_shared<std::packaged_task<Ret()>>(
-                [fn = std::forward<F>(f), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable -> Ret {
-                    return std::apply(fn, std::move(tup));
+            // 共享状态从任务内存池分配；promise 与函数、参数一起存放在任务内（支持仅移动参数）
+            std::promise<Ret> promise(std::allocator_arg, TaskPool::Allocator<Ret>());
+            std::future<Ret> fut = promise.get_future();
+
+            bool success = EnqueueTask(InplaceTask(
+                [p = std::move(promise), fn = std::decay_t<F>(std::forward<F>(f)), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                    // 异常转发到 future
+                    try {
+                        if constexpr (std::is_void_v<Ret>) {
+                            std::apply(fn, std::move(tup));
+                            p.set_value();
+                        }
+                        else {
+                            p.set_value(std::apply(fn, std::move(tup)));
+                        }
+                    }
+                    catch (...) {
+                        p.set_exception(std::current_exception());
+                    }
                 }
-            );
-            std::future<Ret> fut = task->get_future();
-
-            auto wrapper = [task]() {
-                // packaged_task 会把异常转发到 future
-                (*task)();
-            };
+            ));
 
-            if (!EnqueueTask(std::function<void()>(wrapper))) {
+            if (!success) {
                 // 入队失败：返回一个已经带异常的 future
-                std::promise<Ret> p;
-                p.set_exception(std::make_exception_ptr(std::runtime_error("ThreadPool: Task rejected")));
-                return p.get_future();
+                std::promise<Ret> rejected(std::allocator_arg, TaskPool::Allocator<Ret>());
+                rejected.set_exception(std::make_exception_ptr(std::runtime_error("ThreadPool: Task rejected")));
+                return rejected.get_future();
             }
             return fut;
         }
 
-        // 提交一个任务，无返回值，支持参数
+        // 提交一个任务，无返回值，支持参数；可调用对象直接存放在任务内，执行时抛出的异常交给 exceptionHandler
         template<typename F, typename... Args>
         bool Post(F&& f, Args&&... args) {
-            using Fn = std::decay_t<F>;
-
-            // 打包任务，捕获函数和参数，生成一个 void() 调用
-            auto task = std::make_shared<std::packaged_task<void()>>(
-                [fn = Fn(std::forward<F>(f)), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
-                    std::apply(fn, std::move(tup));
-                }
-            );
-
-            auto wrapper = [task]() {
-                // packaged_task 会把异常转发到 future
-                (*task)();
-            };
+            bool success;
+            if constexpr (sizeof...(Args) == 0) {
+                success = EnqueueTask(InplaceTask(std::forward<F>(f)));
+            }
+            else {
+                success = EnqueueTask(InplaceTask(
+                    [fn = std::decay_t<F>(std::forward<F>(f)), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                        std::apply(fn, std::move(tup));
+                    }
+                ));
+            }
 
-            std::function<void(std::exception_ptr)> exceptionHandler = GetExceptionHandler();
-            // 入队并返回是否成功
-            bool success = EnqueueTask(std::function<void()>(wrapper));
-            if (!success && exceptionHandler) exceptionHandler(std::make_exception_ptr(std::runtime_error("Task rejected")));
+            if (!success) {
+                std::function<void(std::exception_ptr)> exceptionHandler = GetExceptionHandler();
+                if (exceptionHandler) exceptionHandler(std::make_exception_ptr(std::runtime_error("Task rejected")));
+            }
             return success;
         }
 
@@ -173,11 +188,23 @@ namespace LikesProgram {
         ThreadPool& operator=(const ThreadPool&) = delete;
 
         // 任务入队及动态扩容
-        bool EnqueueTask(std::function<void()>&& task);
+        bool EnqueueTask(InplaceTask&& task);
+
+        // 工作窃取模式入队
+        bool EnqueueStealing(InplaceTask&& task);
 
         // 工作线程循环体
         void WorkerLoop();
 
+        // 共享队列模式的取任务循环
+        void SharedQueueLoop();
+
+        // 工作窃取模式的取任务循环
+        void WorkStealingLoop();
+
+        // 执行任务并更新统计
+        void RunTask(InplaceTask& task);
+
         // 创建新线程
         void SpawnWorker();
 
@@ -22,6 +22,22 @@ namespace LikesProgram {
 
             // 将 UTF-16 转换为 GBK
             LIKESPROGRAM_API std::string Utf16ToGbk(const std::u16string& utf16);
+
+            // ---- 写入调用方缓冲区的转换接口 ----
+            // 返回写入的单元数；out 的容量需不小于对应 Max* 函数的结果，不足时抛出 std::length_error
+            LIKESPROGRAM_API size_t Utf8ToUtf16(const char8_t* utf8, size_t length, char16_t* out, size_t capacity);
+            LIKESPROGRAM_API size_t Utf32ToUtf16(const char32_t* utf32, size_t length, char16_t* out, size_t capacity);
+            LIKESPROGRAM_API size_t Utf16ToUtf8(const char16_t* utf16, size_t length, char8_t* out, size_t capacity);
+            LIKESPROGRAM_API size_t Utf16ToUtf32(const char16_t* utf16, size_t length, char32_t* out, size_t capacity);
+
+            // 输出缓冲区所需的最大容量（单元数）
+            constexpr size_t MaxUtf16FromUtf8(size_t utf8Length) { return utf8Length; }
+            constexpr size_t MaxUtf16FromUtf32(size_t utf32Length) { return utf32Length * 2; }
+            constexpr size_t MaxUtf8FromUtf16(size_t utf16Length) { return utf16Length * 3; }
+            constexpr size_t MaxUtf32FromUtf16(size_t utf16Length) { return utf16Length; }
+
+            // 当前使用的转换内核（"AVX2"、"SSE2" 或 "Scalar"）
+            LIKESPROGRAM_API const char* ActiveKernel();
         }
     }
 }
\ No newline at end of file
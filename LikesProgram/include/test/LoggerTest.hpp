@@ -2,9 +2,22 @@
 #include "../LikesProgram/log/Logger.hpp"
 #include "../LikesProgram/log/sinks/ConsoleSink.hpp"
 #include "../LikesProgram/log/sinks/FileSink.hpp"
+#include "../LikesProgram/log/sinks/MmapFileSink.hpp"
 #include "../LikesProgram/String.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
 
 namespace LoggerTest {
+    // 检查失败时抛出异常，中止示例
+    inline void Check(bool condition, const char* what) {
+        if (!condition) throw std::runtime_error(std::string("LoggerTest check failed: ") + what);
+    }
+
     // 自定义网络输出 Sink
     class NetworkSink : public LikesProgram::Log::Sink {
     public:
@@ -33,11 +46,15 @@ namespace LoggerTest {
         // 初始化日志
 #ifdef _DEBUG
         auto& logger = LikesProgram::Log::Logger::Instance(true, true);
-        logger.SetLevel(LikesProgram::Log::Level::Debug);
+        const LikesProgram::Log::Level defaultLevel = LikesProgram::Log::Level::Debug;
 #else
         auto& logger = LikesProgram::Log::Logger::Instance(true);
-        logger.SetLevel(LikesProgram::Log::Level::Info);
+        const LikesProgram::Log::Level defaultLevel = LikesProgram::Log::Level::Info;
 #endif
+        logger.SetLevel(defaultLevel);
+
+        // 队列已满时阻塞等待（也可选择丢弃最新/最旧或同步写入）
+        logger.SetOverflowPolicy(LikesProgram::Log::OverflowPolicy::Block);
 
 #ifdef _WIN32
         logger.SetEncoding(LikesProgram::String::Encoding::GBK);
@@ -68,13 +85,145 @@ namespace LoggerTest {
         LogFatal(u"fatal message 日志输出");   // 会输出
 #endif
 
-        // 格式化输出
+        // 格式化输出（延迟格式化：调用线程只拷贝参数，由日志线程格式化）
+        logger.SetDeferredFormatting(true);
         LogTrace(u"trace message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Trace);   // 不会输出
         LogDebug(u"debug message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Debug);   // 会输出
         LogInfo(u"info message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Info);    // 会输出
         LogWarn(u"warn message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Warn);    // 会输出
         LogError(u"error message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Error);   // 会输出
         LogFatal(u"fatal message 格式化输出 LogLevel：{}", (int)LikesProgram::Log::Level::Fatal);   // 会输出
+
+        // 限频输出：同一调用点每 4 次输出一次 / 只输出前 2 次，输出时附带被抑制的条数
+        for (int i = 0; i < 10; i++) {
+            LogEveryN(Info, 4, u"every n 限频输出 i：{}", i);  // i = 0、4、8 时输出
+            LogFirstN(Warn, 2, u"first n 限频输出 i：{}", i);  // i = 0、1 时输出
+        }
+
+        // 被过滤的日志调用不求值参数：运行期级别过滤（SetLevel）与编译期级别过滤（-DLOG_MIN_LEVEL=N）
+        {
+            int evaluated = 0;
+            auto touch = [&evaluated]() { return ++evaluated; };
+            logger.SetLevel(LikesProgram::Log::Level::Fatal);
+            LogError(u"runtime filtered {}", touch());  // 运行期低于 Fatal，不求值
+            Check(evaluated == 0, "runtime-filtered LogError did not evaluate its arguments");
+            logger.SetLevel(LikesProgram::Log::Level::Trace);
+#if LIKESPROGRAM_LOG_MIN_LEVEL > 0
+            LogTrace(u"compiled out {}", touch());      // 运行期允许 Trace，但宏已在编译期展开为空
+            Check(evaluated == 0, "compile-time filtered LogTrace did not evaluate its arguments");
+#endif
+            logger.SetLevel(defaultLevel);
+            (void)touch;
+            std::cout << "filtered log arguments evaluated: " << evaluated << " (expect 0, LOG_MIN_LEVEL="
+                << LIKESPROGRAM_LOG_MIN_LEVEL << ")" << std::endl;
+        }
         logger.Shutdown();
+
+        // 文件输出的刷新策略：分别验证 flushBytes、flushLevel、flushInterval 触发前后文件中的内容
+        {
+            const std::filesystem::path root = "./logs/flush-test";
+            std::error_code ec;
+            std::filesystem::remove_all(root, ec);
+
+            // 目录下所有日志文件中的行数（文件按日期放在子目录中）
+            auto fileLines = [](const std::filesystem::path& dir) {
+                size_t lines = 0;
+                std::error_code ec;
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+                    if (!entry.is_regular_file()) continue;
+                    std::ifstream in(entry.path(), std::ios::binary);
+                    lines += std::count(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>(), '\n');
+                }
+                return lines;
+            };
+            auto makeMessage = [](LikesProgram::Log::Level level, int i) {
+                LikesProgram::Log::Message message;
+                message.level = level;
+                message.debug = false;
+                message.tid = std::this_thread::get_id();
+                message.timestamp = std::chrono::system_clock::now();
+                message.msg = LikesProgram::String::Format(u"flush 策略测试 i：{:04}", i);
+                return message;
+            };
+
+            // flushBytes：缓冲不足 4KB 时文件为空，累计达到后一次写入
+            {
+                LikesProgram::Log::FileSink::Options options;
+                options.flushBytes = 4096;
+                options.flushLevel = LikesProgram::Log::Level::Fatal;
+                LikesProgram::Log::FileSink sink(u"./logs/flush-test/bytes", u"Flush.log", options);
+                sink.Write(makeMessage(LikesProgram::Log::Level::Info, 0));
+                Check(fileLines(root / "bytes") == 0, "flushBytes: a single line stays buffered");
+                int written = 1;
+                while (fileLines(root / "bytes") == 0 && written < 1000) sink.Write(makeMessage(LikesProgram::Log::Level::Info, written++));
+                Check(fileLines(root / "bytes") == static_cast<size_t>(written), "flushBytes: reaching the threshold writes every buffered line");
+                Check(written > 10, "flushBytes: the threshold was not reached by the first few lines");
+            }
+
+            // flushLevel：Info 留在缓冲中，随后的 Error 把两行一起写入
+            {
+                LikesProgram::Log::FileSink::Options options;
+                options.flushBytes = 1 << 20;
+                options.flushLevel = LikesProgram::Log::Level::Error;
+                LikesProgram::Log::FileSink sink(u"./logs/flush-test/level", u"Flush.log", options);
+                sink.Write(makeMessage(LikesProgram::Log::Level::Info, 0));
+                Check(fileLines(root / "level") == 0, "flushLevel: Info stays buffered");
+                sink.Write(makeMessage(LikesProgram::Log::Level::Error, 1));
+                Check(fileLines(root / "level") == 2, "flushLevel: Error writes itself and the buffered Info");
+            }
+
+            // flushInterval：没有新日志时由后台线程在间隔到期后写入
+            {
+                LikesProgram::Log::FileSink::Options options;
+                options.flushBytes = 1 << 20;
+                options.flushLevel = LikesProgram::Log::Level::Fatal;
+                options.flushInterval = std::chrono::milliseconds(50);
+                LikesProgram::Log::FileSink sink(u"./logs/flush-test/interval", u"Flush.log", options);
+                sink.Write(makeMessage(LikesProgram::Log::Level::Info, 0));
+                Check(fileLines(root / "interval") == 0, "flushInterval: the line stays buffered before the interval");
+                for (int i = 0; i < 100 && fileLines(root / "interval") == 0; i++) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                Check(fileLines(root / "interval") == 1, "flushInterval: the background thread wrote the line");
+            }
+            std::cout << "FileSink flushBytes / flushLevel / flushInterval: ok" << std::endl;
+        }
+
+        // 内存映射文件输出：分段 1MB，写入约 4.5MB（30000 行，每行约 150 字节）后检查分段切换与关闭后的文件大小
+        {
+            const std::filesystem::path dir = "./logs/mmap-test";
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+
+            const int count = 30000;
+            {
+                LikesProgram::Log::MmapFileSink sink(u"./logs/mmap-test", u"Mmap.log", 1);
+                LikesProgram::Log::Message message;
+                message.level = LikesProgram::Log::Level::Info;
+                message.debug = false;
+                message.tid = std::this_thread::get_id();
+                for (int i = 0; i < count; i++) {
+                    message.msg = LikesProgram::String::Format(u"mmap sink 分段测试 i：{:08} ................................................", i);
+                    message.timestamp = std::chrono::system_clock::now();
+                    sink.Write(message);
+                }
+            } // 析构时封存当前分段并截断到实际长度
+
+            size_t files = 0, lines = 0, bytes = 0;
+            bool truncated = true;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+                if (!entry.is_regular_file()) continue;
+                std::ifstream in(entry.path(), std::ios::binary);
+                std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                files++;
+                bytes += content.size();
+                lines += std::count(content.begin(), content.end(), '\n');
+                // 文件以换行结尾且不含预分配的零填充，说明已截断到有效长度
+                if (content.empty() || content.back() != '\n' || content.find('\0') != std::string::npos) truncated = false;
+            }
+            std::cout << "MmapFileSink files: " << files << " (expect >= 2), lines: " << lines << "/" << count
+                << ", bytes: " << bytes << ", truncated: " << (truncated ? "yes" : "no") << std::endl;
+            Check(files >= 2, "MmapFileSink rotated into at least two segments");
+            Check(lines == static_cast<size_t>(count), "MmapFileSink kept every line");
+            Check(truncated, "MmapFileSink truncated every segment to its data");
+        }
 	}
 }
\ No newline at end of file
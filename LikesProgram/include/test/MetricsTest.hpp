@@ -4,9 +4,13 @@
 #include "../LikesProgram/metrics/Histogram.hpp"
 #include "../LikesProgram/metrics/Summary.hpp"
 #include "../LikesProgram/metrics/Registry.hpp"
+#include "../LikesProgram/metrics/LocalHandle.hpp"
+#include "../LikesProgram/metrics/MetricVec.hpp"
+#include "../LikesProgram/metrics/Exporter.hpp"
 #include "../LikesProgram/time/Timer.hpp"
 #include <iostream>
 #include <thread>
+#include <vector>
 #include <chrono>
 
 namespace MetricsTest {
@@ -25,6 +29,34 @@ namespace MetricsTest {
         std::wcout << L"Prometheus Counter:\n" << httpCounter->ToPrometheus() << std::endl;
         std::wcout << L"Json Counter:\n" << httpCounter->ToJson() << std::endl << std::endl;
 
+        // 多线程高频计数：Striped 存储按线程分散到多个缓存行，读取时求和
+        LikesProgram::Metrics::Counter hotCounter(u"hot_requests_total", u"Hot path requests", {}, LikesProgram::Metrics::Storage::Striped);
+        {
+            std::vector<std::thread> workers;
+            for (int i = 0; i < 4; i++) workers.emplace_back([&hotCounter] { for (int n = 0; n < 10000; n++) hotCounter.Increment(); });
+            for (auto& worker : workers) worker.join();
+        }
+        std::wcout << L"Striped Counter Value: " << hotCounter.Value() << std::endl << std::endl;
+
+        // 线程本地句柄：更新只写本线程缓冲，按间隔或导出时合并到共享指标
+        auto messageCounter = std::make_shared<LikesProgram::Metrics::Counter>(u"messages_total", u"Messages handled");
+        {
+            std::vector<std::thread> workers;
+            for (int i = 0; i < 4; i++) workers.emplace_back([messageCounter] {
+                LikesProgram::Metrics::LocalCounter local(messageCounter);
+                for (int n = 0; n < 10000; n++) local.Increment();
+            }); // 句柄析构时合并剩余更新
+            for (auto& worker : workers) worker.join();
+        }
+        std::wcout << L"Local Counter Value: " << messageCounter->Value() << std::endl << std::endl;
+
+        // 带标签的指标族：子指标按标签值解析一次后可缓存引用，已存在的子指标查找无锁
+        LikesProgram::Metrics::CounterVec endpointRequests(u"endpoint_requests_total", u"Requests per endpoint", { u"endpoint", u"method" });
+        LikesProgram::Metrics::Counter& usersGet = endpointRequests.WithLabelValues({ u"/users", u"GET" });
+        usersGet.Increment();
+        endpointRequests.WithLabelValues({ u"/orders", u"POST" }).Increment(3);
+        std::wcout << L"CounterVec children: " << endpointRequests.Size() << L", /users GET: " << usersGet.Value() << std::endl << std::endl;
+
 
         std::cout << "\n===== Gauge 示例 =====\n" << std::endl;
         auto tempGauge = std::make_shared<LikesProgram::Metrics::Gauge>(
@@ -79,6 +111,12 @@ namespace MetricsTest {
         std::wcout << L"Prometheus Histogram:\n" << hist->ToPrometheus() << std::endl;
         std::wcout << L"Json Histogram:\n" << hist->ToJson() << std::endl << std::endl;
 
+        // 指数桶布局：0.1ms 起每次翻倍共 16 个桶，O(1) 定位桶
+        LikesProgram::Metrics::Histogram rpcLatency(u"rpc_latency_seconds", LikesProgram::Metrics::Histogram::Exponential(0.0001, 2.0, 16), u"RPC latency");
+        rpcLatency.Observe(0.0003);
+        rpcLatency.Observe(0.012);
+        std::wcout << L"Prometheus Exponential Histogram:\n" << rpcLatency.ToPrometheus() << std::endl;
+
 
         std::cout << "\n===== Summary 示例 =====\n" << std::endl;
         auto latencySummary = std::make_shared<LikesProgram::Metrics::Summary>(
@@ -96,6 +134,12 @@ namespace MetricsTest {
         std::wcout << L"Prometheus Summary:\n" << latencySummary->ToPrometheus() << std::endl;
         std::wcout << L"Json Summary:\n" << latencySummary->ToJson() << std::endl << std::endl;
 
+        // 滑动窗口 Summary：分位数只反映最近 6 × 10s 内的观测值
+        LikesProgram::Metrics::Summary recentLatency(u"recent_latency_seconds", std::chrono::seconds(10), 6, u"Recent request latency");
+        recentLatency.Observe(0.02);
+        recentLatency.Observe(0.30);
+        std::wcout << L"Windowed Summary p99: " << recentLatency.Quantile(0.99) << std::endl << std::endl;
+
 
         std::cout << "\n===== Registry 示例 =====\n" << std::endl;
         auto& reg = LikesProgram::Metrics::Registry::Global();
@@ -120,6 +164,12 @@ namespace MetricsTest {
         LikesProgram::String jsonOutput = reg.ExportJson();
         std::wcout << L"JSON Export:\n" << jsonOutput << std::endl;
 
+        // 流式导出：直接写出 UTF-8（也可写入 Net::Buffer 或文件描述符）
+        LikesProgram::Metrics::Exporter exporter(LikesProgram::Metrics::Exporter::Format::OpenMetrics);
+        std::u8string openMetrics;
+        exporter.Export(reg, openMetrics);
+        std::cout << "OpenMetrics Export (" << exporter.ContentType() << "):\n" << std::string(openMetrics.begin(), openMetrics.end()) << std::endl;
+
         // Unregister
         reg.Unregister(u"http_requests_total", { {u"method", u"GET"}, {u"code", u"200"} });
 
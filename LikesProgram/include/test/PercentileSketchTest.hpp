@@ -2,6 +2,7 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
+#include <thread>
 #include "../LikesProgram/math/PercentileSketch.hpp"
 
 namespace PercentileSketchTest {
@@ -58,5 +59,43 @@ namespace PercentileSketchTest {
         ifs.close();
 
         std::cout << "Deserialized 50th percentile: " << loadedSketch.Quantile(0.5) << std::endl;
+
+        // 紧凑二进制格式：适合跨进程汇总，可直接从字节合并
+        std::vector<uint8_t> bytes;
+        sketch1.SerializeTo(bytes);
+        LikesProgram::Math::PercentileSketch rollup(1200);
+        rollup.MergeSerialized(bytes);
+        std::cout << "Compact bytes: " << bytes.size() << ", rollup 50th percentile: " << rollup.Quantile(0.5) << std::endl;
+
+        // 损坏的数据应抛出异常：截断、权重为 0、权重超过 int 范围
+        std::vector<uint8_t> single;
+        LikesProgram::Math::PercentileSketch one;
+        one.Add(1.0);
+        one.SerializeTo(single); // 末尾 1 字节为唯一质心的权重
+        std::vector<std::vector<uint8_t>> malformed = {
+            std::vector<uint8_t>(bytes.begin(), bytes.begin() + bytes.size() / 2),
+            std::vector<uint8_t>(single.begin(), single.end() - 1),
+            std::vector<uint8_t>(single.begin(), single.end() - 1),
+        };
+        malformed[1].push_back(0x00);
+        malformed[2].insert(malformed[2].end(), { 0xFF, 0xFF, 0xFF, 0xFF, 0x0F });
+        for (const auto& data : malformed) {
+            try {
+                LikesProgram::Math::PercentileSketch::Deserialize(std::span<const uint8_t>(data));
+                std::cout << "Malformed sketch accepted!" << std::endl;
+            }
+            catch (const std::runtime_error& e) {
+                std::cout << "Malformed sketch rejected: " << e.what() << std::endl;
+            }
+        }
+
+        // 线程本地写入：各线程写自己的缓冲（无锁），写满后交给分片，查询前合并
+        LikesProgram::Math::PercentileSketch latency(400, 8, LikesProgram::Math::PercentileSketch::Ingest::ThreadLocal);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([&latency, t] { for (int i = 0; i < 10000; i++) latency.Add((i % 1000) + t); });
+        }
+        for (auto& worker : workers) worker.join();
+        std::cout << "ThreadLocal 99th percentile: " << latency.Quantile(0.99) << std::endl;
 	}
 }
\ No newline at end of file
@@ -66,7 +66,7 @@ namespace StringFormatTest {
                 }
                 else {
                     log += u"\r\n[文本]";
-                    log += tok.literal;
+                    log += tok.isInvalid ? String(u"{!}") : fmt.SubString(tok.literal.offset, tok.literal.length);
                     log += u"\r\n";
                 }
             }
@@ -87,6 +87,67 @@ namespace StringFormatTest {
         }
 	}
 
+    // 比较编译期路径与运行时路径（FormatAny）的输出
+    template <typename... Args>
+    void CompareFormat(FormatString<Args...> fmt, Args&&... args) {
+        String compiled = String::Format(fmt, args...);
+        String runtimeFmt = fmt.ToString();
+        String runtime = String::Format(runtimeFmt, args...);
+        LogDebug(u"{} [{}] {}", compiled == runtime ? u"OK" : u"MISMATCH", fmt.IsCompiled() ? u"compiled" : u"runtime", compiled);
+    }
+
+    void FormatStringBenchmark() {
+        constexpr int iterations = 200000;
+        String runtimeFmt(u"id={} name={} score={:.2f} hex={:#x}");
+        String name(u"LikesProgram");
+
+        uint64_t begin = Timer::NowNs();
+        for (int i = 0; i < iterations; ++i) String::Format(u"id={} name={} score={:.2f} hex={:#x}", i, name, i * 0.5, i);
+        uint64_t compiledNs = Timer::NowNs() - begin;
+
+        begin = Timer::NowNs();
+        for (int i = 0; i < iterations; ++i) String::Format(runtimeFmt, i, name, i * 0.5, i);
+        uint64_t runtimeNs = Timer::NowNs() - begin;
+
+        LogDebug(u"Format 编译期: {} ns/op, 运行时: {} ns/op", compiledNs / iterations, runtimeNs / iterations);
+
+        // 运行时格式串的解析结果由 FormatCache 复用
+        FormatCache& cache = FormatInternal::Instance().Cache();
+        LogDebug(u"FormatCache: hits={} misses={} evictions={} size={}", cache.Hits(), cache.Misses(), cache.Evictions(), cache.Size());
+
+        // 缓存返回的解析结果不依赖调用方的格式串：临时格式串销毁后仍可读取占位符文本
+        FormatCache::Program program = cache.Get(String(u"value={:*>8.3f}"));
+        for (const auto& tok : program->tokens) {
+            if (tok.isPlaceholder) LogDebug(u"FormatCache raw spec: {} fill: {}", tok.spec.GetRaw(), tok.spec.GetFill());
+        }
+    }
+
+    void FormatToTest() {
+        // 追加到已有 String：连续追加复用容量
+        String report(u"报告:");
+        for (int i = 0; i < 3; ++i) String::FormatTo(report, u" [{}:{:>4}]", i, i * 100);
+        String::FormatTo(report, String(u" total={}"), 300); // 运行时格式串
+        LogDebug(u"FormatTo(String): {}", report);
+
+        // 追加到 UTF-8 缓冲区
+        std::u8string line(u8"UTF-8:");
+        String::FormatTo(line, u8" {} {:.1f} {}", u"π", 3.14159, String(u"一段超过内联容量的较长字符串内容"));
+        LogDebug(u"FormatTo(u8string): {}", String(line));
+
+        constexpr int iterations = 200000;
+        uint64_t begin = Timer::NowNs();
+        String appended;
+        for (int i = 0; i < iterations; ++i) appended += String::Format(u"{},", i);
+        uint64_t formatNs = Timer::NowNs() - begin;
+
+        begin = Timer::NowNs();
+        String streamed;
+        for (int i = 0; i < iterations; ++i) String::FormatTo(streamed, u"{},", i);
+        uint64_t formatToNs = Timer::NowNs() - begin;
+
+        LogDebug(u"Format+Append: {} ns/op, FormatTo: {} ns/op, {}", formatNs / iterations, formatToNs / iterations, appended == streamed ? u"OK" : u"MISMATCH");
+    }
+
     void Test() {
 #ifdef _DEBUG
         auto& logger = LikesProgram::Log::Logger::Instance(true, true);
@@ -239,6 +300,27 @@ namespace StringFormatTest {
         // ===========================
         LogDebug(String::Format(U"{1}{}{1}{}{}{}", U"A", U"B", U"C", U"D", U"E"));
 
+        // ===========================
+        // 12. 编译期解析与运行时一致性
+        // ===========================
+        CompareFormat(U"Hello {}, {}!", U"World", 123);
+        CompareFormat(U"{2}{}{1}{}", U"X", 7, U"Y");
+        CompareFormat(u"{} {2} {} {5}", u"first", u"second", u"third");
+        CompareFormat(u"Hex: {:x} {:X} {:#x} {:#X} {:#b} {:#o}", 255, 255u, -1, 255LL, 10, 63);
+        CompareFormat(u"Float: {:.2f} {:.3e} {:g} {:.2%} {}", 3.14159, 1234.5678, 0.0001, 0.1234, 2.5f);
+        CompareFormat(u"Align: '{:*>10}' '{:<6}' '{:^7}' '{:06}' '{:'░'^9}'", u"R", 42, true, -12, U"中");
+        CompareFormat(u8"UTF-8: {} {} {}", std::string("文本"), L'字', String(u"一段超过内联容量的较长字符串内容"));
+        CompareFormat(u"Pointer: {:p} Char: {}", static_cast<const void*>(&val), 'c');
+        CompareFormat(u"Fallback: {:'**'^8} {:c}", u"A", 65);
+        CompareFormat(u"Escape {{{}}} {0:05", 1);
+
+        FormatStringBenchmark();
+
+        // ===========================
+        // 13. 追加格式化（FormatTo）
+        // ===========================
+        FormatToTest();
+
         logger.Shutdown();
     }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 #include "../LikesProgram/String.hpp"
 using namespace LikesProgram;
 
@@ -52,9 +55,69 @@ namespace StringTest {
         std::cout << std::endl;
     }
 
+    // 检查失败时抛出异常，中止示例
+    inline void Check(bool condition, const char* what) {
+        if (!condition) throw std::runtime_error(std::string("StringTest check failed: ") + what);
+    }
+
+    // 逐个码点比对 At、SubString 与迭代结果（跨越每 64 个码点一个的检查点）
+    void CheckCodePoints(const String& str, const std::u32string& expected, const char* what) {
+        Check(str.Size() == expected.size(), what);
+        for (size_t i = 0; i < expected.size(); ++i) Check(str.At(i) == expected[i], what);
+        for (size_t i = 0; i < expected.size(); i += 7) {
+            size_t count = std::min<size_t>(70, expected.size() - i);
+            Check(str.SubString(i, count) == String(expected.substr(i, count)), what);
+        }
+        size_t index = 0;
+        for (char32_t cp : str) Check(index < expected.size() && cp == expected[index++], what);
+        Check(index == expected.size(), what);
+    }
+
+    // 含代理项（emoji）的长字符串：多次 Append 后码点索引仍正确，
+    // 包括旧结尾的孤立高代理项与追加内容开头的低代理项组成代理对（需要重建索引）
+    void SurrogateIndex() {
+        std::cout << "===== 代理项与码点索引 =====" << std::endl;
+        const char32_t pieces[] = { U'a', U'中', U'😀', U'𐐷', U'z', U'界' };
+        String str;
+        std::u32string expected;
+        for (size_t i = 0; i < 200; ++i) {
+            char32_t cp = pieces[i % 6] + static_cast<char32_t>(i % 3);
+            if (i % 2 == 0) str.Append(String(cp));  // UTF-16 追加
+            else {
+                std::u8string utf8;
+                String(cp).AppendTo(utf8);
+                str.Append(utf8.data(), utf8.size());  // UTF-8 追加
+            }
+            expected.push_back(cp);
+        }
+        CheckCodePoints(str, expected, "200 code points with surrogate pairs after Append");
+
+        // 超过 64 个码点后以孤立高代理项结尾，追加以低代理项开头的内容
+        std::u16string head;
+        std::u32string headExpected;
+        for (size_t i = 0; i < 70; ++i) {
+            head += (i % 5 == 0) ? u"😀" : u"b";
+            headExpected.push_back((i % 5 == 0) ? U'😀' : U'b');
+        }
+        head.push_back(static_cast<char16_t>(0xD83D));
+        String lone(head);
+        headExpected.push_back(static_cast<char32_t>(0xD83D));
+        CheckCodePoints(lone, headExpected, "lone high surrogate at the end");
+
+        std::u16string tail;
+        tail.push_back(static_cast<char16_t>(0xDE01));  // 与 0xD83D 组成 U+1F601
+        tail += u"尾😀x";
+        lone.Append(String(tail));
+        headExpected.back() = U'😁';
+        headExpected += U"尾😀x";
+        CheckCodePoints(lone, headExpected, "appended low surrogate completes the pair");
+        std::cout << "surrogate index checks: ok (size " << lone.Size() << ")" << std::endl;
+    }
+
     void Test() {
         Format();
         OutAndIn();
+        SurrogateIndex();
         std::cout << "===== 其他示例 =====" << std::endl;
         // 构造测试
         String s1(u"Hello 世界");      // UTF-16
@@ -126,5 +189,11 @@ namespace StringTest {
             std::cout << p.ToStdString() << " ";
         }
         std::cout << "\n";
+
+        // 短字符串内联存储
+        String shortStr(u8"短字符串");
+        String longStr(u8"这是一个超过内联容量的较长字符串");
+        std::cout << std::dec << "shortStr inline: " << shortStr.IsInline()
+            << ", longStr inline: " << longStr.IsInline() << "\n";
     }
 }
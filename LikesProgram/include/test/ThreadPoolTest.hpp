@@ -97,6 +97,22 @@ namespace ThreadPoolTest {
         // 输出 注册器 中的 Metrics 内容
         LogWarn(registry->ExportPrometheus());
 
+        // 工作窃取调度：每个工作线程有本地队列，工作线程内提交的子任务优先在本线程执行
+        LikesProgram::ThreadPool::Options stealingOptions(2, 4);
+        stealingOptions.scheduler = LikesProgram::ThreadPool::Scheduler::WorkStealing;
+        LikesProgram::ThreadPool stealingPool(stealingOptions);
+        stealingPool.Start();
+        std::atomic<int> leafTasks{ 0 };
+        for (int i = 0; i < 10; i++) {
+            stealingPool.PostNoArg([&stealingPool, &leafTasks]() {
+                for (int n = 0; n < 10; n++) stealingPool.PostNoArg([&leafTasks]() { leafTasks.fetch_add(1); });
+            });
+        }
+        while (leafTasks.load() < 100) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stealingPool.Shutdown();
+        stealingPool.AwaitTermination(std::chrono::milliseconds(1000));
+        LogWarn(u"工作窃取模式完成子任务数：{}", leafTasks.load());
+
         logger.Shutdown();
 	}
 }
\ No newline at end of file
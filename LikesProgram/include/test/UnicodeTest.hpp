@@ -2,6 +2,10 @@
 #include <iostream>
 #include <iomanip>
 #include "../LikesProgram/unicode/Unicode.hpp"
+#include "../LikesProgram/time/Timer.hpp"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 
 namespace UnicodeTest {
     void TestBMP_AllLatin() {
@@ -145,6 +149,84 @@ namespace UnicodeTest {
             std::cout << std::hex << std::showbase << (int)c << ' ';
         }
         std::cout << std::dec << std::noshowbase << '\n';
+
+        // 混合 1~4 字节文本往返：覆盖向量内核的 2/3/4 字节块与混合块路径
+        std::u32string mixed;
+        for (size_t i = 0; i < 4096; ++i) {
+            switch ((i * 7 + i / 13) % 5) {
+            case 0: mixed.push_back(U'a' + static_cast<char32_t>(i % 26)); break;
+            case 1: mixed.push_back(U'\u0400' + static_cast<char32_t>(i % 256)); break;
+            case 2: mixed.push_back(U'\u4E00' + static_cast<char32_t>(i % 2000)); break;
+            case 3: mixed.push_back(U'\U0001F600' + static_cast<char32_t>(i % 64)); break;
+            default: mixed.push_back(U'\uFFFD'); break;
+            }
+        }
+        std::u16string mixed16 = LikesProgram::Unicode::Convert::Utf32ToUtf16(mixed);
+        bool roundTrip = LikesProgram::Unicode::Convert::Utf8ToUtf16(LikesProgram::Unicode::Convert::Utf16ToUtf8(mixed16)) == mixed16;
+        std::cout << "混合文本往返: " << (roundTrip ? "[对]" : "[错]") << "\n";
+
+        // 非法序列位于长块中间时同样须抛出异常
+        std::u8string padding(40, u8'a');
+        std::u8string cjk = LikesProgram::Unicode::Convert::Utf16ToUtf8(std::u16string(24, u'\u4E2D'));
+        std::vector<std::u8string> invalid = {
+            padding + cjk.substr(0, 21) + u8"\x80" + cjk + padding,           // 孤立后续字节
+            padding + cjk + std::u8string(1, u8'\xE4') + u8"a" + cjk + padding, // 后续字节缺失
+            padding + cjk + std::u8string(1, u8'\xF8') + cjk + padding,        // 非法首字节
+            padding + u8"\xF4\x90\x80\x80" + cjk + padding,                    // 超出 U+10FFFF
+            cjk + std::u8string(1, u8'\xE4'),                                  // 末尾截断
+        };
+        size_t rejected = 0;
+        for (const auto& text : invalid) {
+            try { LikesProgram::Unicode::Convert::Utf8ToUtf16(text); }
+            catch (const std::runtime_error&) { rejected++; }
+        }
+        std::cout << "非法 UTF-8 拒绝: " << rejected << "/" << invalid.size() << (rejected == invalid.size() ? " [对]" : " [错]") << "\n";
+    }
+
+    // 转码吞吐量基准（GB/s，按输入字节计）
+    void Benchmark() {
+        using namespace LikesProgram::Unicode::Convert;
+        std::cout << "\n=== Convert Benchmark (" << ActiveKernel() << ") ===\n";
+
+        struct Corpus {
+            const char* name;
+            std::u32string text;
+        };
+        const size_t codePoints = 1 << 20;
+        std::vector<Corpus> corpora = { { "ASCII", {} }, { "CJK", {} }, { "Emoji", {} } };
+        for (size_t i = 0; i < codePoints; ++i) {
+            corpora[0].text.push_back(U'a' + static_cast<char32_t>(i % 26));
+            corpora[1].text.push_back(i % 8 == 7 ? U' ' : U'\u4E00' + static_cast<char32_t>(i % 2000));
+            corpora[2].text.push_back(i % 4 == 3 ? U' ' : U'\U0001F600' + static_cast<char32_t>(i % 64));
+        }
+
+        const int rounds = 5;
+        auto measure = [&](const char* label, size_t inputBytes, auto&& fn) {
+            uint64_t best = UINT64_MAX;
+            for (int r = 0; r < rounds; ++r) {
+                uint64_t begin = LikesProgram::Time::Timer::NowNs();
+                fn();
+                uint64_t elapsed = LikesProgram::Time::Timer::NowNs() - begin;
+                if (elapsed < best) best = elapsed;
+            }
+            double gbps = best ? static_cast<double>(inputBytes) / static_cast<double>(best) : 0.0; // 字节/纳秒 即 GB/s
+            std::cout << "  " << std::left << std::setw(16) << label << std::fixed << std::setprecision(2) << gbps << " GB/s\n";
+        };
+
+        for (auto& corpus : corpora) {
+            std::u16string u16 = Utf32ToUtf16(corpus.text);
+            std::u8string u8 = Utf16ToUtf8(u16);
+            std::vector<char16_t> out16(std::max(MaxUtf16FromUtf8(u8.size()), MaxUtf16FromUtf32(corpus.text.size())));
+            std::vector<char8_t> out8(MaxUtf8FromUtf16(u16.size()));
+            std::vector<char32_t> out32(MaxUtf32FromUtf16(u16.size()));
+
+            std::cout << corpus.name << ":\n";
+            measure("UTF-8->UTF-16", u8.size(), [&] { Utf8ToUtf16(u8.data(), u8.size(), out16.data(), out16.size()); });
+            measure("UTF-16->UTF-8", u16.size() * sizeof(char16_t), [&] { Utf16ToUtf8(u16.data(), u16.size(), out8.data(), out8.size()); });
+            measure("UTF-16->UTF-32", u16.size() * sizeof(char16_t), [&] { Utf16ToUtf32(u16.data(), u16.size(), out32.data(), out32.size()); });
+            measure("UTF-32->UTF-16", corpus.text.size() * sizeof(char32_t), [&] { Utf32ToUtf16(corpus.text.data(), corpus.text.size(), out16.data(), out16.size()); });
+        }
+        std::cout << std::defaultfloat << std::right;
     }
 
     void Test() {
@@ -152,5 +234,6 @@ namespace UnicodeTest {
         TestSMP();
         ValidateSMP();
         TestConvert();
+        Benchmark();
     }
 }
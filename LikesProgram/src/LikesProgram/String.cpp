@@ -15,6 +15,7 @@
 #include <cctype>
 #include <regex>
 #include <optional>
+#include <charconv>
 #ifdef _WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
@@ -25,13 +26,152 @@
 
 namespace LikesProgram {
     struct String::StringImpl {
+        // 含代理项时，每隔 CheckpointStride 个码点记录一次 UTF-16 偏移
+        static constexpr size_t CheckpointStride = 64;
+
         std::unique_ptr<char16_t[]> m_data;  // UTF-16 数据
-        size_t m_size;                        // UTF-16 单元长度
-        Encoding encoding;                     // 原始编码
-        mutable std::vector<size_t> cp_offsets; // 每个 Unicode code point 在 UTF-16 中的偏移
-        mutable bool cp_cache_valid = false;   // 是否缓存有效
+        size_t m_size = 0;                    // UTF-16 单元长度
+        size_t m_capacity = 0;                // 已分配的 UTF-16 单元数（不含结尾 '\0'）
+        size_t cpCount = 0;                   // Unicode code point 数量
+        bool hasSurrogate = false;            // 是否含代理项（不含时码点索引即 UTF-16 偏移）
+        std::vector<size_t> checkpoints;      // 稀疏码点偏移索引，仅 hasSurrogate 时有效
+
+        // 扫描数据，更新码点数量、代理项标记与稀疏索引
+        void Analyze() {
+            hasSurrogate = false;
+            checkpoints.clear();
+            cpCount = 0;
+            AnalyzeFrom(0);
+        }
+
+        // 追加后增量更新：只扫描 oldSize 之后的新数据
+        void AnalyzeAppended(size_t oldSize) {
+            // 旧结尾为高代理项时可能与新数据组成代理对，需整体重建
+            if (hasSurrogate && oldSize > 0 && m_data[oldSize - 1] >= 0xD800 && m_data[oldSize - 1] <= 0xDBFF) {
+                Analyze();
+                return;
+            }
+            AnalyzeFrom(oldSize);
+        }
+
+        // 确保可容纳 required 个单元，按倍数扩容以摊销连续追加
+        void Reserve(size_t required) {
+            if (required <= m_capacity) return;
+            size_t capacity = std::max(required, m_capacity * 2);
+            auto data = std::make_unique<char16_t[]>(capacity + 1);
+            if (m_size > 0) std::memcpy(data.get(), m_data.get(), m_size * sizeof(char16_t));
+            data[m_size] = u'\0';
+            m_data = std::move(data);
+            m_capacity = capacity;
+        }
+
+    private:
+        // 从码点边界 start 继续扫描（start 之前的统计已有效）
+        void AnalyzeFrom(size_t start) {
+            size_t i = start;
+            if (!hasSurrogate) {
+                for (; i < m_size; ++i) {
+                    if (m_data[i] >= 0xD800 && m_data[i] <= 0xDFFF) break;
+                }
+                cpCount = i;
+                if (i == m_size) return;
+
+                // 首次出现代理项：此前码点与单元一一对应，补齐稀疏索引后按码点遍历
+                hasSurrogate = true;
+                for (size_t cp = 0; cp < i; cp += CheckpointStride) checkpoints.push_back(cp);
+            }
+
+            while (i < m_size) {
+                if (cpCount % CheckpointStride == 0) checkpoints.push_back(i);
+                char16_t c = m_data[i];
+                if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_size && m_data[i + 1] >= 0xDC00 && m_data[i + 1] <= 0xDFFF) {
+                    i += 2; // surrogate pair
+                }
+                else {
+                    ++i; // 普通字符或孤立代理项
+                }
+                ++cpCount;
+            }
+        }
     };
 
+    namespace {
+        // UTF-8 首字节对应的序列长度（0 表示非法首字节）
+        inline size_t Utf8SequenceLength(char8_t lead) {
+            if (lead < 0x80) return 1;
+            if ((lead & 0xE0) == 0xC0) return 2;
+            if ((lead & 0xF0) == 0xE0) return 3;
+            if ((lead & 0xF8) == 0xF0) return 4;
+            return 0;
+        }
+
+        // 严格校验 UTF-8（拒绝过长编码、代理区码点与超出 U+10FFFF 的码点），ascii 返回是否全为 ASCII
+        inline bool ValidateUtf8(const char8_t* s, size_t length, bool& ascii) {
+            ascii = true;
+            size_t i = 0;
+            while (i < length) {
+                char8_t c = s[i];
+                if (c < 0x80) { ++i; continue; }
+                ascii = false;
+                size_t n = Utf8SequenceLength(c);
+                if (n == 0 || i + n > length) return false;
+                char32_t cp = c & (0xFF >> (n + 1));
+                for (size_t j = 1; j < n; ++j) {
+                    char8_t cont = s[i + j];
+                    if ((cont & 0xC0) != 0x80) return false;
+                    cp = (cp << 6) | (cont & 0x3F);
+                }
+                if ((n == 2 && cp < 0x80) || (n == 3 && cp < 0x800) || (n == 4 && cp < 0x10000)) return false;
+                if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) return false;
+                i += n;
+            }
+            return true;
+        }
+
+        // 解码一个合法 UTF-8 序列，i 前进到下一个码点
+        inline char32_t DecodeUtf8(const char8_t* s, size_t& i) {
+            char8_t c = s[i];
+            size_t n = Utf8SequenceLength(c);
+            if (n <= 1) { ++i; return c; }
+            char32_t cp = c & (0xFF >> (n + 1));
+            for (size_t j = 1; j < n; ++j) cp = (cp << 6) | (s[i + j] & 0x3F);
+            i += n;
+            return cp;
+        }
+
+        // 将码点编码为 UTF-8，返回写入的字节数
+        inline size_t EncodeUtf8(char32_t cp, char8_t* out) {
+            if (cp <= 0x7F) {
+                out[0] = static_cast<char8_t>(cp);
+                return 1;
+            }
+            if (cp <= 0x7FF) {
+                out[0] = static_cast<char8_t>(0xC0 | (cp >> 6));
+                out[1] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+                return 2;
+            }
+            if (cp <= 0xFFFF) {
+                out[0] = static_cast<char8_t>(0xE0 | (cp >> 12));
+                out[1] = static_cast<char8_t>(0x80 | ((cp >> 6) & 0x3F));
+                out[2] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+                return 3;
+            }
+            out[0] = static_cast<char8_t>(0xF0 | (cp >> 18));
+            out[1] = static_cast<char8_t>(0x80 | ((cp >> 12) & 0x3F));
+            out[2] = static_cast<char8_t>(0x80 | ((cp >> 6) & 0x3F));
+            out[3] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+            return 4;
+        }
+
+        // 是否全部为 ASCII 字节
+        inline bool IsAscii(const char* s, size_t length) {
+            for (size_t i = 0; i < length; ++i) {
+                if (static_cast<unsigned char>(s[i]) >= 0x80) return false;
+            }
+            return true;
+        }
+    }
+
     bool String::FromAny(const std::any& a, String& outContent) {
         if (!a.has_value()) {
             outContent = String();
@@ -76,56 +216,39 @@ namespace LikesProgram {
         return true;
     }
 
-    String::String(): m_impl(new StringImpl{}) {
-        m_impl->m_data = (std::make_unique<char16_t[]>(1));
-        m_impl->m_size = 0;
-        m_impl->encoding = Encoding::UTF8;
-    }
+    String::String() { }
 
-    String::String(const char* s, Encoding enc): m_impl(new StringImpl{}) {
-        m_impl->encoding = enc;
+    String::String(const char* s, Encoding enc) {
+        m_encoding = enc;
         if (!s) s = "";
 
         switch (enc) {
         case Encoding::UTF8: {
-            size_t len = std::strlen(s);
-            auto utf16 = Unicode::Convert::Utf8ToUtf16(
-                std::u8string(reinterpret_cast<const char8_t*>(s),
-                    reinterpret_cast<const char8_t*>(s) + len)
-            );
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            AssignUtf8(reinterpret_cast<const char8_t*>(s), std::strlen(s));
             break;
         }
         case Encoding::GBK: {
-            auto utf16 = Unicode::Convert::GbkToUtf16(std::string(s));
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            size_t len = std::strlen(s);
+            // GBK 兼容 ASCII，纯 ASCII 内容无需转码
+            if (IsAscii(s, len) && TryStoreInline(reinterpret_cast<const char8_t*>(s), len)) break;
+            auto utf16 = Unicode::Convert::GbkToUtf16(std::string(s, len));
+            AssignUtf16(utf16.data(), utf16.size());
             break;
         }
         case Encoding::UTF16: {
             const char16_t* ps = reinterpret_cast<const char16_t*>(s);
             size_t len = 0;
             while (ps[len] != 0) ++len;
-            m_impl->m_size = len;
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), ps, m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            AssignUtf16(ps, len);
             break;
         }
         case Encoding::UTF32: {
             const char32_t* ps = reinterpret_cast<const char32_t*>(s);
             size_t len = 0;
             while (ps[len] != 0) ++len;
+            if (TryStoreInline(ps, len)) break;
             auto utf16 = Unicode::Convert::Utf32ToUtf16(std::u32string(ps, ps + len));
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            AssignUtf16(utf16.data(), utf16.size());
             break;
         }
         default:
@@ -133,114 +256,85 @@ namespace LikesProgram {
         }
     }
 
-    String::String(const char8_t* s): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF8;
+    String::String(const char8_t* s) {
+        m_encoding = Encoding::UTF8;
         if (!s) s = u8"";
-        auto utf16 = Unicode::Convert::Utf8ToUtf16(std::u8string(s));
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf8(s, std::char_traits<char8_t>::length(s));
     }
 
-    String::String(const char16_t* s): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
+    String::String(const char16_t* s) {
+        m_encoding = Encoding::UTF16;
         if (!s) s = u"";
         size_t len = 0;
         while (s[len] != 0) ++len;
-        m_impl->m_size = len;
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), s, m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(s, len);
     }
 
-    String::String(const char16_t* s, size_t length): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
+    String::String(const char16_t* s, size_t length) {
+        m_encoding = Encoding::UTF16;
         if (!s) {
             s = u"";
             length = 0;
         }
         size_t actualLength = 0;
         while (s[actualLength] != u'\0' && actualLength < length) ++actualLength;
-        m_impl->m_size = actualLength;
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), s, m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(s, actualLength);
     }
 
-    String::String(const char32_t* s): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF32;
+    String::String(const char32_t* s) {
+        m_encoding = Encoding::UTF32;
         if (!s) s = U"";
         size_t len = 0;
         while (s[len] != 0) ++len; // 计算长度
+        if (TryStoreInline(s, len)) return;
         auto utf16 = Unicode::Convert::Utf32ToUtf16(std::u32string(s, s + len));
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(utf16.data(), utf16.size());
     }
 
-    String::String(const String& other): m_impl(new StringImpl{}) {
-
-        if (other.m_impl->m_data) {
-            m_impl->m_data = std::make_unique<char16_t[]>(other.m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), other.m_impl->m_data.get(), (other.m_impl->m_size + 1) * sizeof(char16_t));
-        } else {
-            m_impl->m_data = std::make_unique<char16_t[]>(1);
-            m_impl->m_data[0] = u'\0';
-        }
+    String::String(const String& other)
+        : m_ssoSize(other.m_ssoSize), m_ssoAscii(other.m_ssoAscii), m_encoding(other.m_encoding) {
+        std::memcpy(m_sso, other.m_sso, m_ssoSize);
+        if (!other.m_impl) return;
 
+        m_impl = new StringImpl{};
+        m_impl->m_data = std::make_unique<char16_t[]>(other.m_impl->m_size + 1);
+        std::memcpy(m_impl->m_data.get(), other.m_impl->m_data.get(), (other.m_impl->m_size + 1) * sizeof(char16_t));
         m_impl->m_size = other.m_impl->m_size;
-        m_impl->encoding = other.m_impl->encoding;
-        m_impl->cp_offsets = other.m_impl->cp_offsets;
-        m_impl->cp_cache_valid = other.m_impl->cp_cache_valid;
+        m_impl->m_capacity = other.m_impl->m_size;
+        m_impl->cpCount = other.m_impl->cpCount;
+        m_impl->hasSurrogate = other.m_impl->hasSurrogate;
+        m_impl->checkpoints = other.m_impl->checkpoints;
     }
 
-    String::String(String&& other) noexcept : m_impl(other.m_impl) {
+    String::String(String&& other) noexcept
+        : m_impl(other.m_impl), m_ssoSize(other.m_ssoSize), m_ssoAscii(other.m_ssoAscii), m_encoding(other.m_encoding) {
+        std::memcpy(m_sso, other.m_sso, m_ssoSize);
         other.m_impl = nullptr;
+        other.m_ssoSize = 0;
+        other.m_ssoAscii = true;
     }
 
-    String::String(char c, Encoding enc) : m_impl(new StringImpl{}) {
-        m_impl->encoding = enc;
+    String::String(char c, Encoding enc) {
+        m_encoding = enc;
 
         switch (enc) {
         case Encoding::UTF8: {
-            char s[2] = { c, '\0' };
-            auto utf16 = Unicode::Convert::Utf8ToUtf16(
-                std::u8string(reinterpret_cast<const char8_t*>(s))
-            );
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(),
-                m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            char8_t ch = static_cast<char8_t>(c);
+            AssignUtf8(&ch, c ? 1 : 0);
             break;
         }
         case Encoding::GBK: {
             std::string s(1, c);
+            if (IsAscii(s.data(), s.size()) && TryStoreInline(reinterpret_cast<const char8_t*>(s.data()), s.size())) break;
             auto utf16 = Unicode::Convert::GbkToUtf16(s);
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(),
-                m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
-            break;
-        }
-        case Encoding::UTF16: {
-            m_impl->m_size = 1;
-            m_impl->m_data = std::make_unique<char16_t[]>(2);
-            m_impl->m_data[0] = static_cast<char16_t>(static_cast<unsigned char>(c));
-            m_impl->m_data[1] = u'\0';
+            AssignUtf16(utf16.data(), utf16.size());
             break;
         }
+        case Encoding::UTF16:
         case Encoding::UTF32: {
-            char32_t cp = static_cast<unsigned char>(c);
-            auto utf16 = Unicode::Convert::Utf32ToUtf16(std::u32string(1, cp));
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(),
-                m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            // 单字节值均位于 BMP，UTF-16/UTF-32 结果相同
+            char16_t unit = static_cast<char16_t>(static_cast<unsigned char>(c));
+            AssignUtf16(&unit, 1);
             break;
         }
         default:
@@ -248,83 +342,52 @@ namespace LikesProgram {
         }
     }
 
-    String::String(const char8_t c): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF8;
-        char8_t buf[2] = { c, 0 };
-        auto utf16 = Unicode::Convert::Utf8ToUtf16(std::u8string(buf));
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+    String::String(const char8_t c) {
+        m_encoding = Encoding::UTF8;
+        AssignUtf8(&c, c ? 1 : 0);
     }
 
-    String::String(const char16_t c): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
-        m_impl->m_size = 1;
-        m_impl->m_data = std::make_unique<char16_t[]>(2);
-        m_impl->m_data[0] = c;
-        m_impl->m_data[1] = u'\0';
+    String::String(const char16_t c) {
+        m_encoding = Encoding::UTF16;
+        AssignUtf16(&c, 1);
     }
 
-    String::String(const size_t count, const char16_t c): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
-
-        // 分配存储空间，+1 预留 '\0'
-        m_impl->m_size = count;
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-
-        // 填充内容
-        for (size_t i = 0; i < count; ++i) {
-            m_impl->m_data[i] = c;
-        }
-
-        m_impl->m_data[count] = u'\0';
+    String::String(const size_t count, const char16_t c) {
+        m_encoding = Encoding::UTF16;
+        std::u16string utf16(count, c);
+        AssignUtf16(utf16.data(), utf16.size());
     }
 
-    String::String(const size_t count, const char32_t c) : m_impl(new StringImpl{}) {
-            m_impl->encoding = Encoding::UTF32;
-
-            // 构造一个只含重复字符的 UTF-32 字符串
-            std::u32string utf32(count, c);
+    String::String(const size_t count, const char32_t c) {
+        m_encoding = Encoding::UTF32;
 
-            // 转换为 UTF-16 存储
-            auto utf16 = Unicode::Convert::Utf32ToUtf16(utf32);
+        // 构造一个只含重复字符的 UTF-32 字符串
+        std::u32string utf32(count, c);
+        if (TryStoreInline(utf32.data(), utf32.size())) return;
 
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+        // 转换为 UTF-16 存储
+        auto utf16 = Unicode::Convert::Utf32ToUtf16(utf32);
+        AssignUtf16(utf16.data(), utf16.size());
     }
 
-    String::String(const char32_t c): m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF32;
+    String::String(const char32_t c) {
+        m_encoding = Encoding::UTF32;
+        if (TryStoreInline(&c, 1)) return;
         auto utf16 = Unicode::Convert::Utf32ToUtf16(std::u32string(1, c));
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(utf16.data(), utf16.size());
     }
 
-    String::String(const std::string& s, Encoding enc) : m_impl(new StringImpl{}) {
-        m_impl->encoding = enc;
+    String::String(const std::string& s, Encoding enc) {
+        m_encoding = enc;
         switch (enc) {
         case Encoding::UTF8: {
-            auto utf16 = Unicode::Convert::Utf8ToUtf16(
-                std::u8string(reinterpret_cast<const char8_t*>(s.data()),
-                    reinterpret_cast<const char8_t*>(s.data() + s.size()))
-            );
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            AssignUtf8(reinterpret_cast<const char8_t*>(s.data()), s.size());
             break;
         }
         case Encoding::GBK: {
+            if (IsAscii(s.data(), s.size()) && TryStoreInline(reinterpret_cast<const char8_t*>(s.data()), s.size())) break;
             auto utf16 = Unicode::Convert::GbkToUtf16(s);
-            m_impl->m_size = utf16.size();
-            m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-            std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-            m_impl->m_data[m_impl->m_size] = u'\0';
+            AssignUtf16(utf16.data(), utf16.size());
             break;
         }
         default:
@@ -332,61 +395,53 @@ namespace LikesProgram {
         }
     }
 
-    String::String(const std::u8string& s) : m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF8;
-        auto utf16 = Unicode::Convert::Utf8ToUtf16(s);
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+    String::String(const std::u8string& s) {
+        m_encoding = Encoding::UTF8;
+        AssignUtf8(s.data(), s.size());
     }
 
-    String::String(const std::wstring& s) : m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
+    String::String(const std::wstring& s) {
+        m_encoding = Encoding::UTF16;
 #if WCHAR_MAX == 0xFFFF  // Windows
-        m_impl->m_size = s.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), s.data(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(reinterpret_cast<const char16_t*>(s.data()), s.size());
 #else  // Linux
         std::u32string tmp;
         for (wchar_t c : s) tmp.push_back(static_cast<char32_t>(c));
+        if (TryStoreInline(tmp.data(), tmp.size())) return;
         auto utf16 = Unicode::Convert::Utf32ToUtf16(tmp);
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+        AssignUtf16(utf16.data(), utf16.size());
 #endif
     }
 
-    String::String(const std::u16string& s) : m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF16;
-        m_impl->m_size = s.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), s.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
+    String::String(const std::u16string& s) {
+        m_encoding = Encoding::UTF16;
+        AssignUtf16(s.data(), s.size());
     }
 
-    String::String(const std::u32string& s) : m_impl(new StringImpl{}) {
-        m_impl->encoding = Encoding::UTF32;
+    String::String(const std::u32string& s) {
+        m_encoding = Encoding::UTF32;
+        if (TryStoreInline(s.data(), s.size())) return;
         auto utf16 = Unicode::Convert::Utf32ToUtf16(s);
-        m_impl->m_size = utf16.size();
-        m_impl->m_data = std::make_unique<char16_t[]>(m_impl->m_size + 1);
-        std::memcpy(m_impl->m_data.get(), utf16.c_str(), m_impl->m_size * sizeof(char16_t));
-        m_impl->m_data[m_impl->m_size] = u'\0';
-    }
-
-    String::String(int64_t value) : String([&] {
-        std::wostringstream woss;
-        woss << value;
-        return woss.str();
-        }()) {
-    }
-    String::String(uint64_t value) : String([&] {
-        std::wostringstream woss;
-        woss << value;
-        return woss.str();
-        }()) {
+        AssignUtf16(utf16.data(), utf16.size());
+    }
+
+    String::String(int64_t value) {
+        m_encoding = Encoding::UTF16;
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        char16_t units[24];
+        size_t len = static_cast<size_t>(res.ptr - buf);
+        for (size_t i = 0; i < len; ++i) units[i] = static_cast<char16_t>(buf[i]);
+        AssignUtf16(units, len);
+    }
+    String::String(uint64_t value) {
+        m_encoding = Encoding::UTF16;
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        char16_t units[24];
+        size_t len = static_cast<size_t>(res.ptr - buf);
+        for (size_t i = 0; i < len; ++i) units[i] = static_cast<char16_t>(buf[i]);
+        AssignUtf16(units, len);
     }
     String::String(long double value) : String([&] {
         std::wostringstream woss;
@@ -405,41 +460,151 @@ namespace LikesProgram {
 
     String& String::operator=(const String& other) {
         if (this != &other) {
-            // 拷贝构造临时对象
+            // 拷贝构造临时对象，再移动赋值
             String tmp(other);
-            // 交换 m_impl 指针
-            std::swap(m_impl, tmp.m_impl);
+            *this = std::move(tmp);
         }
         return *this;
     }
 
     String& String::operator=(String&& other) noexcept {
         if (this != &other) {
-            if(m_impl) delete m_impl;
+            if (m_impl) delete m_impl;
             m_impl = other.m_impl;
+            m_ssoSize = other.m_ssoSize;
+            m_ssoAscii = other.m_ssoAscii;
+            m_encoding = other.m_encoding;
+            std::memcpy(m_sso, other.m_sso, m_ssoSize);
             other.m_impl = nullptr;
+            other.m_ssoSize = 0;
+            other.m_ssoAscii = true;
         }
         return *this;
     }
 
-    size_t String::Size() const {
-        size_t count = 0;
-        size_t i = 0;
-        while (i < m_impl->m_size) {
-            char16_t c = m_impl->m_data[i];
-            if (c >= 0xD800 && c <= 0xDBFF) { // 高位 surrogate
-                if (i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF) {
-                    i += 2; // 跳过完整 surrogate pair
-                }
-                else {
-                    // 孤立高位 surrogate，当作单字符处理
-                    ++i;
-                }
+    bool String::TryStoreInline(const char8_t* utf8, size_t length) {
+#if LIKESPROGRAM_STRING_SSO
+        bool ascii = true;
+        if (length > SSOCapacity || !ValidateUtf8(utf8, length, ascii)) return false;
+        std::memmove(m_sso, utf8, length);
+        m_ssoSize = static_cast<uint8_t>(length);
+        m_ssoAscii = ascii;
+        if (m_impl) {
+            delete m_impl;
+            m_impl = nullptr;
+        }
+        return true;
+#else
+        (void)utf8; (void)length;
+        return false;
+#endif
+    }
+
+    bool String::TryStoreInline(const char16_t* utf16, size_t length) {
+#if LIKESPROGRAM_STRING_SSO
+        if (length > SSOCapacity) return false; // 每个 UTF-16 单元至少占 1 字节
+        char8_t buf[SSOCapacity + 4];
+        size_t n = 0;
+        for (size_t i = 0; i < length; ++i) {
+            char32_t cp = utf16[i];
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                if (i + 1 >= length || utf16[i + 1] < 0xDC00 || utf16[i + 1] > 0xDFFF) return false; // 孤立代理项
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (utf16[++i] - 0xDC00);
+            }
+            else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                return false;
+            }
+            n += EncodeUtf8(cp, buf + n);
+            if (n > SSOCapacity) return false;
+        }
+        return TryStoreInline(buf, n);
+#else
+        (void)utf16; (void)length;
+        return false;
+#endif
+    }
+
+    bool String::TryStoreInline(const char32_t* utf32, size_t length) {
+#if LIKESPROGRAM_STRING_SSO
+        if (length > SSOCapacity) return false;
+        char8_t buf[SSOCapacity + 4];
+        size_t n = 0;
+        for (size_t i = 0; i < length; ++i) {
+            char32_t cp = utf32[i];
+            if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) return false;
+            n += EncodeUtf8(cp, buf + n);
+            if (n > SSOCapacity) return false;
+        }
+        return TryStoreInline(buf, n);
+#else
+        (void)utf32; (void)length;
+        return false;
+#endif
+    }
+
+    void String::AssignUtf16(const char16_t* utf16, size_t length) {
+        if (TryStoreInline(utf16, length)) return;
+        auto data = std::make_unique<char16_t[]>(length + 1);
+        if (length > 0) std::memcpy(data.get(), utf16, length * sizeof(char16_t));
+        data[length] = u'\0';
+        if (!m_impl) m_impl = new StringImpl{};
+        m_impl->m_data = std::move(data);
+        m_impl->m_size = length;
+        m_impl->m_capacity = length;
+        m_impl->Analyze();
+    }
+
+    void String::AssignUtf8(const char8_t* utf8, size_t length) {
+        if (TryStoreInline(utf8, length)) return;
+        // 直接转码到最终存储，省去中间的 u8string/u16string
+        size_t capacity = Unicode::Convert::MaxUtf16FromUtf8(length);
+        auto data = std::make_unique<char16_t[]>(capacity + 1);
+        size_t size = Unicode::Convert::Utf8ToUtf16(utf8, length, data.get(), capacity);
+        data[size] = u'\0';
+        if (!m_impl) m_impl = new StringImpl{};
+        m_impl->m_data = std::move(data);
+        m_impl->m_size = size;
+        m_impl->m_capacity = capacity;
+        m_impl->Analyze();
+    }
+
+    const char16_t* String::Utf16Data(std::u16string& buffer, size_t& length) const {
+        if (m_impl) {
+            length = m_impl->m_size;
+            return m_impl->m_data.get();
+        }
+        buffer.clear();
+        buffer.reserve(m_ssoSize);
+        for (size_t i = 0; i < m_ssoSize;) {
+            char32_t cp = DecodeUtf8(m_sso, i);
+            if (cp <= 0xFFFF) {
+                buffer.push_back(static_cast<char16_t>(cp));
             }
             else {
-                ++i;
+                cp -= 0x10000;
+                buffer.push_back(static_cast<char16_t>((cp >> 10) + 0xD800));
+                buffer.push_back(static_cast<char16_t>((cp & 0x3FF) + 0xDC00));
             }
-            ++count;
+        }
+        length = buffer.size();
+        return buffer.data();
+    }
+
+    String String::FromUtf16(const char16_t* utf16, size_t length, Encoding enc) {
+        String result;
+        result.m_encoding = enc;
+        result.AssignUtf16(utf16, length);
+        return result;
+    }
+
+    size_t String::Size() const {
+        if (m_impl) return m_impl->cpCount;
+        if (m_ssoAscii) return m_ssoSize;
+
+        // 合法 UTF-8 中，非续字节的数量即为码点数
+        size_t count = 0;
+        for (size_t i = 0; i < m_ssoSize; ++i) {
+            if ((m_sso[i] & 0xC0) != 0x80) ++count;
         }
         return count;
     }
@@ -449,25 +614,25 @@ namespace LikesProgram {
     }
 
     bool String::Empty() const {
-        return m_impl->m_size == 0;
+        return m_impl ? m_impl->m_size == 0 : m_ssoSize == 0;
+    }
+
+    bool String::IsInline() const noexcept {
+        return m_impl == nullptr;
     }
 
     void String::Clear() {
-        m_impl->m_data = std::make_unique<char16_t[]>(1);
-        m_impl->m_data[0] = u'\0';
-        m_impl->m_size = 0;
+        if (m_impl) delete m_impl;
+        m_impl = nullptr;
+        m_ssoSize = 0;
+        m_ssoAscii = true;
     }
 
     char32_t String::At(size_t index) const {
-        update_cp_cache();
-        if (index >= m_impl->cp_offsets.size()) throw std::out_of_range("index out of range");
-        size_t i = m_impl->cp_offsets[index];
-        char16_t c = m_impl->m_data[i];
-        if (c >= 0xD800 && c <= 0xDBFF) {
-            char16_t low = m_impl->m_data[i + 1];
-            return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
-        }
-        return c;
+        if (index >= Size()) throw std::out_of_range("index out of range");
+        char32_t cp = 0;
+        DecodeAt(CodePointOffset(index), cp);
+        return cp;
     }
 
     char32_t String::operator[](size_t index) const {
@@ -486,17 +651,80 @@ namespace LikesProgram {
 
     String& String::Append(const String& str) {
         if (str.Empty()) return *this;
-        size_t new_size = m_impl->m_size + str.m_impl->m_size;
-        auto new_data = std::make_unique<char16_t[]>(new_size + 1);
-        if (m_impl->m_size > 0) std::memcpy(new_data.get(), m_impl->m_data.get(), m_impl->m_size * sizeof(char16_t));
-        std::memcpy(new_data.get() + m_impl->m_size, str.m_impl->m_data.get(), str.m_impl->m_size * sizeof(char16_t));
-        new_data[new_size] = u'\0';
-        m_impl->m_data = std::move(new_data);
-        m_impl->m_size = new_size;
-        m_impl->cp_cache_valid = false;
+
+        // 两侧均为内联存储且拼接后仍可内联：直接追加 UTF-8 字节
+        if (!m_impl && !str.m_impl && m_ssoSize + str.m_ssoSize <= SSOCapacity) {
+            std::memmove(m_sso + m_ssoSize, str.m_sso, str.m_ssoSize);
+            m_ssoSize = static_cast<uint8_t>(m_ssoSize + str.m_ssoSize);
+            m_ssoAscii = m_ssoAscii && str.m_ssoAscii;
+            return *this;
+        }
+
+        // 自身追加：扩容会释放源数据，先拷贝
+        if (&str == this) {
+            String copy(str);
+            return Append(copy);
+        }
+
+        std::u16string rhsBuffer;
+        size_t rhsSize = 0;
+        const char16_t* rhs = str.Utf16Data(rhsBuffer, rhsSize);
+
+        PromoteToHeap(rhsSize);
+        size_t oldSize = m_impl->m_size;
+        m_impl->Reserve(oldSize + rhsSize);
+        std::memcpy(m_impl->m_data.get() + oldSize, rhs, rhsSize * sizeof(char16_t));
+        m_impl->m_size = oldSize + rhsSize;
+        m_impl->m_data[m_impl->m_size] = u'\0';
+        m_impl->AnalyzeAppended(oldSize);
         return *this;
     }
 
+    String& String::Append(const char8_t* utf8, size_t length) {
+        if (length == 0) return *this;
+
+#if LIKESPROGRAM_STRING_SSO
+        // 内联存储且拼接后仍可内联：校验后直接追加 UTF-8 字节
+        bool ascii = true;
+        if (!m_impl && m_ssoSize + length <= SSOCapacity && ValidateUtf8(utf8, length, ascii)) {
+            std::memcpy(m_sso + m_ssoSize, utf8, length);
+            m_ssoSize = static_cast<uint8_t>(m_ssoSize + length);
+            m_ssoAscii = m_ssoAscii && ascii;
+            return *this;
+        }
+#endif
+
+        // 直接转码到已有存储的尾部，容量足够时不重新分配
+        size_t maxUnits = Unicode::Convert::MaxUtf16FromUtf8(length);
+        PromoteToHeap(maxUnits);
+        size_t oldSize = m_impl->m_size;
+        m_impl->Reserve(oldSize + maxUnits);
+        size_t written = Unicode::Convert::Utf8ToUtf16(utf8, length, m_impl->m_data.get() + oldSize, m_impl->m_capacity - oldSize);
+        m_impl->m_size = oldSize + written;
+        m_impl->m_data[m_impl->m_size] = u'\0';
+        m_impl->AnalyzeAppended(oldSize);
+        return *this;
+    }
+
+    void String::PromoteToHeap(size_t extra) {
+        if (m_impl) return;
+
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+
+        auto impl = std::make_unique<StringImpl>();
+        impl->Reserve(size + extra);
+        if (size > 0) std::memcpy(impl->m_data.get(), data, size * sizeof(char16_t));
+        impl->m_size = size;
+        impl->m_data[size] = u'\0';
+        impl->Analyze();
+
+        m_impl = impl.release();
+        m_ssoSize = 0;
+        m_ssoAscii = true;
+    }
+
     String& String::operator+=(const String& str) {
         return Append(str);
     }
@@ -508,24 +736,33 @@ namespace LikesProgram {
     }
 
     std::ostream& operator<<(std::ostream& os, const String& str) {
-        switch (str.m_impl->encoding) {
+        // 内联 UTF-8 直接输出，无需转码
+        if (!str.m_impl && str.m_encoding == String::Encoding::UTF8) {
+            os.write(reinterpret_cast<const char*>(str.m_sso), str.m_ssoSize);
+            return os;
+        }
+
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = str.Utf16Data(buffer, size);
+        switch (str.m_encoding) {
         case String::Encoding::GBK: {
-            auto gbk = Unicode::Convert::Utf16ToGbk(std::u16string(str.m_impl->m_data.get(), str.m_impl->m_size));
+            auto gbk = Unicode::Convert::Utf16ToGbk(std::u16string(data, size));
             os << gbk;
             break;
         }
         case String::Encoding::UTF8: {
-            auto utf8 = Unicode::Convert::Utf16ToUtf8(std::u16string(str.m_impl->m_data.get(), str.m_impl->m_size));
+            auto utf8 = Unicode::Convert::Utf16ToUtf8(std::u16string(data, size));
             os.write(reinterpret_cast<const char*>(utf8.data()), utf8.size() * sizeof(char8_t));
             break;
         }
         case String::Encoding::UTF16: {
             // 直接输出 UTF-16 编码的原始字节
-            os.write(reinterpret_cast<const char*>(str.m_impl->m_data.get()), str.m_impl->m_size * sizeof(char16_t));
+            os.write(reinterpret_cast<const char*>(data), size * sizeof(char16_t));
             break;
         }
         case String::Encoding::UTF32: {
-            auto utf32 = Unicode::Convert::Utf16ToUtf32(std::u16string(str.m_impl->m_data.get(), str.m_impl->m_size));
+            auto utf32 = Unicode::Convert::Utf16ToUtf32(std::u16string(data, size));
             os.write(reinterpret_cast<const char*>(utf32.data()), utf32.size() * sizeof(char32_t));
             break;
         }
@@ -538,7 +775,7 @@ namespace LikesProgram {
     std::istream& operator>>(std::istream& is, String& str) {
         std::string input;
         std::getline(is, input);  // 读取一行输入
-        str = String(input, str.m_impl->encoding);
+        str = String(input, str.m_encoding);
         return is;
     }
 
@@ -556,21 +793,23 @@ namespace LikesProgram {
     }
 
     String String::SubString(size_t index, size_t count) const {
-        if (count == 0 || index >= Size()) return String(); // 越界或长度为0返回空串
+        size_t total = Size();
+        if (count == 0 || index >= total) return String(); // 越界或长度为0返回空串
 
         size_t start = CodePointOffset(index);
-        size_t end = (index + count >= Size()) ? m_impl->m_size : CodePointOffset(index + count);
-
-        size_t new_len = end - start;
-        auto new_data = std::make_unique<char16_t[]>(new_len + 1);
-        std::memcpy(new_data.get(), m_impl->m_data.get() + start, new_len * sizeof(char16_t));
-        new_data[new_len] = u'\0';
+        size_t end = (count >= total - index) ? UnitCount() : CodePointOffset(index + count);
+
+        if (!m_impl) {
+            // 内联存储：按 UTF-8 字节区间截取
+            String result;
+            result.m_encoding = m_encoding;
+            std::memcpy(result.m_sso, m_sso + start, end - start);
+            result.m_ssoSize = static_cast<uint8_t>(end - start);
+            result.m_ssoAscii = m_ssoAscii || IsAscii(reinterpret_cast<const char*>(result.m_sso), result.m_ssoSize);
+            return result;
+        }
 
-        String result;
-        result.m_impl->m_size = new_len;
-        result.m_impl->m_data = std::move(new_data);
-        result.m_impl->encoding = m_impl->encoding; // 或保持原始 encoding
-        return result;
+        return FromUtf16(m_impl->m_data.get() + start, end - start, m_encoding); // 保持原始 encoding
     }
 
     String String::Left(size_t count) const {
@@ -590,16 +829,20 @@ namespace LikesProgram {
     String String::ToUpper() const {
         if (Empty()) return String();
 
-        auto buf = std::make_unique<char16_t[]>(m_impl->m_size * 2 + 1); // 最多扩大两倍
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+
+        auto buf = std::make_unique<char16_t[]>(size * 2 + 1); // 最多扩大两倍
         size_t i = 0, j = 0;
 
-        while (i < m_impl->m_size) {
-            char16_t c = m_impl->m_data[i];
+        while (i < size) {
+            char16_t c = data[i];
 
-            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF) {
+            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < size && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF) {
                 // SMP
                 char16_t high = c;
-                char16_t low = m_impl->m_data[i + 1];
+                char16_t low = data[i + 1];
                 uint32_t cp = 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
                 uint32_t upper_cp = Unicode::Case::SMPToUpper(cp);
 
@@ -622,28 +865,28 @@ namespace LikesProgram {
             }
         }
 
-        buf[j] = u'\0';
-        String result;
-        result.m_impl->m_size = j;
-        result.m_impl->m_data = std::move(buf);
-        return result;
+        return FromUtf16(buf.get(), j);
     }
 
     String String::ToLower() const {
         if (Empty()) return String();
 
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+
         // 分配两倍空间，保证 SMP 扩展不会越界
-        auto buf = std::make_unique<char16_t[]>(m_impl->m_size * 2 + 1);
+        auto buf = std::make_unique<char16_t[]>(size * 2 + 1);
         size_t i = 0; // 原字符串索引
         size_t j = 0; // 新字符串索引
 
-        while (i < m_impl->m_size) {
-            char16_t c = m_impl->m_data[i];
+        while (i < size) {
+            char16_t c = data[i];
 
-            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF) {
+            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < size && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF) {
                 // SMP surrogate pair
                 char16_t high = c;
-                char16_t low = m_impl->m_data[i + 1];
+                char16_t low = data[i + 1];
                 uint32_t cp = 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
 
                 uint32_t lower_cp = Unicode::Case::SMPToLower(cp);
@@ -666,12 +909,7 @@ namespace LikesProgram {
             }
         }
 
-        buf[j] = u'\0';
-
-        String result;
-        result.m_impl->m_size = j;
-        result.m_impl->m_data = std::move(buf);
-        return result;
+        return FromUtf16(buf.get(), j);
     }
 
 
@@ -785,9 +1023,18 @@ namespace LikesProgram {
     }
 
     bool String::operator==(const String& other) const {
-        if (m_impl->m_size != other.m_impl->m_size) return false;
-        for (size_t i = 0; i < m_impl->m_size; ++i) {
-            if (m_impl->m_data[i] != other.m_impl->m_data[i]) return false;
+        // 内联存储均为规范 UTF-8，可直接按字节比较
+        if (!m_impl && !other.m_impl) {
+            return m_ssoSize == other.m_ssoSize && std::memcmp(m_sso, other.m_sso, m_ssoSize) == 0;
+        }
+
+        std::u16string lhsBuffer, rhsBuffer;
+        size_t lhsSize = 0, rhsSize = 0;
+        const char16_t* lhs = Utf16Data(lhsBuffer, lhsSize);
+        const char16_t* rhs = other.Utf16Data(rhsBuffer, rhsSize);
+        if (lhsSize != rhsSize) return false;
+        for (size_t i = 0; i < lhsSize; ++i) {
+            if (lhs[i] != rhs[i]) return false;
         }
         return true;
     }
@@ -812,22 +1059,31 @@ namespace LikesProgram {
     bool String::operator>=(const String& other) const { return !(*this < other); }
 
     std::string String::ToStdString(Encoding enc) const {
+        // 内联 UTF-8 直接返回，无需转码
+        if (!m_impl && enc == Encoding::UTF8) {
+            return std::string(reinterpret_cast<const char*>(m_sso), m_ssoSize);
+        }
+
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
         switch (enc) {
         case Encoding::GBK: {
-            auto gbk = Unicode::Convert::Utf16ToGbk(std::u16string(m_impl->m_data.get(), m_impl->m_size));
+            auto gbk = Unicode::Convert::Utf16ToGbk(std::u16string(data, size));
             return gbk;
         }
         case Encoding::UTF8: {
-            auto u8 = Unicode::Convert::Utf16ToUtf8(std::u16string(m_impl->m_data.get(), m_impl->m_size));
-            return std::string(reinterpret_cast<const char*>(u8.data()), u8.size());
+            std::string u8(Unicode::Convert::MaxUtf8FromUtf16(size), '\0');
+            u8.resize(Unicode::Convert::Utf16ToUtf8(data, size, reinterpret_cast<char8_t*>(u8.data()), u8.size()));
+            return u8;
         }
         case Encoding::UTF16: {
             // 将 UTF-16 原始数据按字节放入 std::string
-            return std::string(reinterpret_cast<const char*>(m_impl->m_data.get()), m_impl->m_size * sizeof(char16_t));
+            return std::string(reinterpret_cast<const char*>(data), size * sizeof(char16_t));
         }
         case Encoding::UTF32: {
             // 先转换为 UTF-32，再按字节放入 std::string
-            auto utf32 = Unicode::Convert::Utf16ToUtf32(std::u16string(m_impl->m_data.get(), m_impl->m_size));
+            auto utf32 = Unicode::Convert::Utf16ToUtf32(std::u16string(data, size));
             return std::string(reinterpret_cast<const char*>(utf32.data()), utf32.size() * sizeof(char32_t));
         }
         default:
@@ -839,8 +1095,16 @@ namespace LikesProgram {
         std::wstring ws;
 
 #if WCHAR_MAX == 0xFFFF  // Windows wchar_t=16位
-        ws.assign(m_impl->m_data.get(), m_impl->m_data.get() + m_impl->m_size);
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+        ws.assign(data, data + size);
 #else  // Linux wchar_t=32位
+        if (!m_impl) {
+            ws.reserve(m_ssoSize);
+            for (size_t i = 0; i < m_ssoSize;) ws.push_back(static_cast<wchar_t>(DecodeUtf8(m_sso, i)));
+            return ws;
+        }
         for (size_t i = 0; i < m_impl->m_size; ) {
             char16_t c = m_impl->m_data[i];
             uint32_t cp;
@@ -860,13 +1124,34 @@ namespace LikesProgram {
     }
 
     std::u16string String::ToU16String() const {
-        return std::u16string(m_impl->m_data.get(), m_impl->m_size);
+        std::u16string buffer;
+        size_t size = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+        if (!m_impl) return buffer;
+        return std::u16string(data, size);
     }
 
     std::u32string String::ToU32String() const {
+        if (!m_impl) {
+            std::u32string utf32;
+            utf32.reserve(m_ssoSize);
+            for (size_t i = 0; i < m_ssoSize;) utf32.push_back(DecodeUtf8(m_sso, i));
+            return utf32;
+        }
         return Unicode::Convert::Utf16ToUtf32(std::u16string(m_impl->m_data.get(), m_impl->m_size));
     }
 
+    void String::AppendTo(std::u8string& out) const {
+        if (!m_impl) {
+            out.append(m_sso, m_ssoSize);
+            return;
+        }
+        size_t start = out.size();
+        out.resize(start + Unicode::Convert::MaxUtf8FromUtf16(m_impl->m_size));
+        size_t written = Unicode::Convert::Utf16ToUtf8(m_impl->m_data.get(), m_impl->m_size, out.data() + start, out.size() - start);
+        out.resize(start + written);
+    }
+
     std::vector<String> String::Split(const String& sep) const {
         std::vector<String> result;
 
@@ -875,15 +1160,20 @@ namespace LikesProgram {
             return result;
         }
 
+        std::u16string buffer, sepBuffer;
+        size_t size = 0, sepSize = 0;
+        const char16_t* data = Utf16Data(buffer, size);
+        const char16_t* sepData = sep.Utf16Data(sepBuffer, sepSize);
+
         size_t start = 0;       // 当前段落的起始偏移（UTF-16 单元）
         size_t i = 0;           // 遍历偏移
 
-        while (i < m_impl->m_size) {
+        while (i < size) {
             // 尝试匹配分隔符
             bool matched = true;
-            if (i + sep.m_impl->m_size <= m_impl->m_size) {
-                for (size_t j = 0; j < sep.m_impl->m_size; ++j) {
-                    if (m_impl->m_data[i + j] != sep.m_impl->m_data[j]) {
+            if (i + sepSize <= size) {
+                for (size_t j = 0; j < sepSize; ++j) {
+                    if (data[i + j] != sepData[j]) {
                         matched = false;
                         break;
                     }
@@ -894,23 +1184,15 @@ namespace LikesProgram {
             }
 
             if (matched) {
-                size_t sub_len = i - start;
-                auto sub_data = std::make_unique<char16_t[]>(sub_len + 1);
-                std::memcpy(sub_data.get(), m_impl->m_data.get() + start, sub_len * sizeof(char16_t));
-                sub_data[sub_len] = u'\0';
-
-                String part;
-                part.m_impl->m_size = sub_len;
-                part.m_impl->m_data = std::move(sub_data);
-                result.push_back(std::move(part));
+                result.push_back(FromUtf16(data + start, i - start));
 
-                i += sep.m_impl->m_size;
+                i += sepSize;
                 start = i;
             }
             else {
                 // 跳过一个完整 code point
-                char16_t c = m_impl->m_data[i];
-                if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF) {
+                char16_t c = data[i];
+                if (c >= 0xD800 && c <= 0xDBFF && i + 1 < size && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF) {
                     i += 2; // surrogate pair
                 }
                 else {
@@ -920,16 +1202,8 @@ namespace LikesProgram {
         }
 
         // 添加最后一段
-        if (start <= m_impl->m_size) {
-            size_t sub_len = m_impl->m_size - start;
-            auto sub_data = std::make_unique<char16_t[]>(sub_len + 1);
-            std::memcpy(sub_data.get(), m_impl->m_data.get() + start, sub_len * sizeof(char16_t));
-            sub_data[sub_len] = u'\0';
-
-            String part;
-            part.m_impl->m_size = sub_len;
-            part.m_impl->m_data = std::move(sub_data);
-            result.push_back(std::move(part));
+        if (start <= size) {
+            result.push_back(FromUtf16(data + start, size - start));
         }
 
         return result;
@@ -978,39 +1252,50 @@ namespace LikesProgram {
         return String(woss.str());
     }
 
-    size_t String::CodePointOffset(size_t index) const {
-        size_t i = 0;  // UTF-16 偏移
-        size_t cp = 0; // Unicode code point
-        while (i < m_impl->m_size && cp < index) {
-            char16_t c = m_impl->m_data[i];
-            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF) {
-                i += 2; // surrogate pair
-            }
-            else {
-                ++i;
-            }
-            ++cp;
+    size_t String::UnitCount() const {
+        return m_impl ? m_impl->m_size : m_ssoSize;
+    }
+
+    size_t String::DecodeAt(size_t pos, char32_t& cp) const {
+        if (!m_impl) {
+            cp = DecodeUtf8(m_sso, pos);
+            return pos;
         }
-        return i;
+
+        char16_t c = m_impl->m_data[pos];
+        if (c >= 0xD800 && c <= 0xDBFF && pos + 1 < m_impl->m_size && m_impl->m_data[pos + 1] >= 0xDC00 && m_impl->m_data[pos + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((c - 0xD800) << 10) + (m_impl->m_data[pos + 1] - 0xDC00);
+            return pos + 2;
+        }
+        cp = c; // 普通字符或孤立代理项
+        return pos + 1;
     }
 
-    void String::update_cp_cache() const {
-        if (m_impl->cp_cache_valid) return;
-        m_impl->cp_offsets.clear();
-        size_t i = 0;
-        while (i < m_impl->m_size) {
-            m_impl->cp_offsets.push_back(i);
-            char16_t c = m_impl->m_data[i];
-            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < m_impl->m_size && m_impl->m_data[i + 1] >= 0xDC00 && m_impl->m_data[i + 1] <= 0xDFFF)
-                i += 2; // surrogate pair
-            else
-                ++i;
+    size_t String::CodePointOffset(size_t index) const {
+        if (!m_impl) {
+            if (m_ssoAscii) return std::min<size_t>(index, m_ssoSize);
+            size_t i = 0;
+            for (size_t cp = 0; i < m_ssoSize && cp < index; ++cp) i += Utf8SequenceLength(m_sso[i]);
+            return i;
         }
-        m_impl->cp_cache_valid = true;
+
+        // 不含代理项：码点索引即 UTF-16 偏移
+        if (!m_impl->hasSurrogate) return std::min(index, m_impl->m_size);
+        if (index >= m_impl->cpCount) return m_impl->m_size;
+
+        // 含代理项：从最近的检查点开始，最多前进 CheckpointStride - 1 个码点
+        size_t i = m_impl->checkpoints[index / StringImpl::CheckpointStride];
+        size_t cp = index - index % StringImpl::CheckpointStride;
+        char32_t ignored = 0;
+        while (cp < index) {
+            i = DecodeAt(i, ignored);
+            ++cp;
+        }
+        return i;
     }
 
     String String::FormatAny(const String& fmt, const std::vector<Any>& args) {
         auto& instance = StringFormat::FormatInternal::Instance();
         return instance.FormatAny(fmt, args);
     }
-}
\ No newline at end of file
+}
@@ -3,32 +3,165 @@
 #endif
 #include "../../../include/LikesProgram/log/Logger.hpp"
 #include "../../../include/LikesProgram/system/CoreUtils.hpp"
+#include "../../../include/LikesProgram/metrics/Counter.hpp"
+#include "../../../include/LikesProgram/metrics/Gauge.hpp"
+#include "../../../include/LikesProgram/metrics/Registry.hpp"
 #include <iostream>
 #include <mutex>
 #include <shared_mutex>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
-#include <queue>
 #include <atomic>
+#include <vector>
 
 namespace LikesProgram {
     namespace Log {
+        namespace {
+            // 有界无锁环形队列（Vyukov 算法）
+            // 生产者与消费者各自通过 CAS 推进位置；日志线程是唯一的常规消费者，
+            // DropOldest 策略下生产者也会出队丢弃最旧的日志，因此出队同样支持并发
+            class MessageRing {
+            public:
+                explicit MessageRing(size_t capacity) {
+                    size_t size = 2;
+                    while (size < capacity) size <<= 1;
+                    m_mask = size - 1;
+                    m_cells = std::make_unique<Cell[]>(size);
+                    for (size_t i = 0; i < size; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+
+                // 队列已满时返回 false（此时 message 保持不变）
+                bool TryPush(Message&& message) {
+                    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+                    for (;;) {
+                        Cell& cell = m_cells[pos & m_mask];
+                        size_t seq = cell.sequence.load(std::memory_order_acquire);
+                        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                        if (diff == 0) {
+                            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                cell.message = std::move(message);
+                                cell.sequence.store(pos + 1, std::memory_order_release);
+                                return true;
+                            }
+                        }
+                        else if (diff < 0) {
+                            return false;
+                        }
+                        else {
+                            pos = m_enqueuePos.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                // 队列为空时返回 false
+                bool TryPop(Message& out) {
+                    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+                    for (;;) {
+                        Cell& cell = m_cells[pos & m_mask];
+                        size_t seq = cell.sequence.load(std::memory_order_acquire);
+                        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                        if (diff == 0) {
+                            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                out = std::move(cell.message);
+                                cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                                return true;
+                            }
+                        }
+                        else if (diff < 0) {
+                            return false;
+                        }
+                        else {
+                            pos = m_dequeuePos.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                // 队首是否已有可读日志（生产者已占位但尚未写完的不算）
+                bool Empty() const {
+                    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+                    return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+                }
+
+                // 近似长度（含已占位未写完的槽位）
+                size_t ApproxSize() const {
+                    size_t dequeue = m_dequeuePos.load(std::memory_order_relaxed);
+                    size_t enqueue = m_enqueuePos.load(std::memory_order_relaxed);
+                    return enqueue > dequeue ? enqueue - dequeue : 0;
+                }
+
+                size_t Capacity() const { return m_mask + 1; }
+
+            private:
+                struct Cell {
+                    std::atomic<size_t> sequence{ 0 };
+                    Message message;
+                };
+
+                std::unique_ptr<Cell[]> m_cells;
+                size_t m_mask = 0;
+                alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+                alignas(64) std::atomic<size_t> m_dequeuePos{ 0 };
+            };
+
+            // 日志线程每批最多写出的条数，避免长时间持有 Sink 锁
+            constexpr size_t MaxBatchSize = 256;
+
+            // 完成延迟格式化（在写入 Sink 前调用）
+            void Materialize(Message& message) {
+                if (!message.deferred) return;
+                try {
+                    message.msg = message.deferred->Format();
+                }
+                catch (const std::exception& e) {
+                    message.msg = String(u"[Format Error] ") + String(e.what());
+                }
+                message.deferred.reset();
+            }
+
+            // 全局日志级别（宏在求值参数前读取，故不放在 LoggerImpl 中）
+            std::atomic<Level> g_minLevel{ Level::Trace };
+
+            // 当前线程是否为日志线程（Sink 内部记录日志时不能等待自己腾出空间）
+            thread_local bool t_isLogThread = false;
+
+            // 当前线程是否正在以 Synchronous 策略写 Sink（持有 writeMtx，Sink 内部再记录日志时不能重入写入或等待）
+            thread_local bool t_inSyncWrite = false;
+        }
+
         struct Logger::LoggerImpl {
             std::atomic<bool> stop{ false };
-            Level minLevel = Level::Trace;
 
             std::shared_mutex sinkMtx;
             std::vector<std::shared_ptr<Sink>> sinks;
+            std::mutex writeMtx; // 串行化 Sink 写入（日志线程与 Synchronous 策略的调用线程）
 
-            std::mutex queueMtx;
-            std::mutex startMutex;
+            std::unique_ptr<MessageRing> queue = std::make_unique<MessageRing>(DefaultQueueCapacity);
+            std::atomic<OverflowPolicy> overflowPolicy{ OverflowPolicy::Block };
+            std::atomic<bool> deferredFormatting{ false };
+
+            // 日志线程空闲时在 cv 上等待；生产者仅在其等待时加锁唤醒
+            std::mutex waitMtx;
             std::condition_variable cv;
-            std::queue<Message> queue;
+            std::atomic<bool> sleeping{ false };
+
+            std::mutex startMutex;
             std::thread worker;
             String::Encoding encoding = String::Encoding::UTF8;
 
             bool m_debug = false;
+
+            std::shared_ptr<Metrics::Counter> dropped = std::make_shared<Metrics::Counter>(u"likesprogram_log_dropped_total", u"Log messages dropped because the queue was full");
+            std::shared_ptr<Metrics::Gauge> queueDepth = std::make_shared<Metrics::Gauge>(u"likesprogram_log_queue_depth", u"Log messages waiting in the queue");
+
+            // 唤醒等待中的日志线程
+            void Notify() {
+                std::atomic_thread_fence(std::memory_order_seq_cst); // 与日志线程的 sleeping 标记配对
+                if (sleeping.load(std::memory_order_relaxed)) {
+                    std::lock_guard lock(waitMtx);
+                    cv.notify_one();
+                }
+            }
         };
 
         Logger& Logger::Instance() {
@@ -66,17 +199,21 @@ namespace LikesProgram {
             m_impl = new LoggerImpl{};
             m_impl->m_debug = debug;
             m_impl->stop.store(true, std::memory_order_release); // 第一时间打 stop 标记
+            Metrics::Registry::Global().Register(m_impl->dropped);
+            Metrics::Registry::Global().Register(m_impl->queueDepth);
             if (autoStart) Start();
         }
 
         Logger::~Logger() {
             if (m_impl) {
                 m_impl->stop.store(true, std::memory_order_release); // 第一时间打 stop 标记
-                m_impl->cv.notify_all(); // 唤醒阻塞的 worker
+                {
+                    std::lock_guard lock(m_impl->waitMtx);
+                    m_impl->cv.notify_all(); // 唤醒阻塞的 worker
+                }
 
                 if (m_impl->worker.joinable()) m_impl->worker.join(); // 等待线程退出
 
-                while (!m_impl->queue.empty()) m_impl->queue.pop();
                 m_impl->sinks.clear();
 
                 delete m_impl;
@@ -85,30 +222,129 @@ namespace LikesProgram {
         }
 
         void Logger::ProcessLoop() {
-            while (!m_impl->stop) {
-                std::unique_lock<std::mutex> lock(m_impl->queueMtx);
-                m_impl->cv.wait(lock, [this]() { return !m_impl->queue.empty() || m_impl->stop; });
+            t_isLogThread = true;
+            std::vector<Message> batch;
+            batch.reserve(MaxBatchSize);
+            Message msg;
+            for (;;) {
+                // 批量取出，整批交给各个 sink
+                batch.clear();
+                while (batch.size() < MaxBatchSize && m_impl->queue->TryPop(msg)) {
+                    Materialize(msg);
+                    batch.push_back(std::move(msg));
+                }
+                size_t count = batch.size();
+                if (count > 0) {
+                    std::shared_lock sinkLock(m_impl->sinkMtx); // 共享锁，多个 sink 并发读
+                    std::lock_guard writeLock(m_impl->writeMtx);
+                    for (auto& sink : m_impl->sinks) sink->WriteBatch(batch);
+                }
+                if (count > 0) {
+                    m_impl->queueDepth->Set(static_cast<double>(m_impl->queue->ApproxSize()));
+                    continue;
+                }
 
-                if (m_impl->stop && m_impl->queue.empty()) break;
+                // 队列已空：停止时退出，否则等待新日志
+                if (m_impl->stop.load(std::memory_order_acquire)) {
+                    if (m_impl->queue->ApproxSize() == 0) break;
+                    std::this_thread::yield(); // 生产者已占位但尚未写完
+                    continue;
+                }
 
-                while (!m_impl->queue.empty()) {
-                    auto msg = m_impl->queue.front();
-                    m_impl->queue.pop();
-                    lock.unlock();
+                std::unique_lock lock(m_impl->waitMtx);
+                m_impl->sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst); // 与生产者的 Notify 配对
+                m_impl->cv.wait(lock, [this]() { return !m_impl->queue->Empty() || m_impl->stop.load(std::memory_order_acquire); });
+                m_impl->sleeping.store(false, std::memory_order_relaxed);
+            }
+            m_impl->queueDepth->Set(0);
+        }
 
-                    // 多个 sink 并发读
-                    {
-                        std::shared_lock sinkLock(m_impl->sinkMtx); // 共享锁
-                        for (auto& sink : m_impl->sinks) sink->Write(msg);
-                    }
+        void Logger::Enqueue(Message&& message) {
+            MessageRing& queue = *m_impl->queue;
+            if (queue.TryPush(std::move(message))) {
+                m_impl->Notify();
+                return;
+            }
+
+            OverflowPolicy policy = m_impl->overflowPolicy.load(std::memory_order_relaxed);
+            if (t_isLogThread || t_inSyncWrite) policy = OverflowPolicy::DropNewest;
 
-                    lock.lock();
+            switch (policy) {
+            case OverflowPolicy::DropNewest:
+                m_impl->dropped->Increment();
+                return;
+            case OverflowPolicy::DropOldest: {
+                Message oldest;
+                while (!queue.TryPush(std::move(message))) {
+                    if (queue.TryPop(oldest)) m_impl->dropped->Increment();
                 }
+                break;
             }
+            case OverflowPolicy::Synchronous:
+                Materialize(message);
+                WriteToSinks(message);
+                return;
+            case OverflowPolicy::Block:
+            default:
+                // 先自旋让出，仍满时短暂休眠，等待日志线程腾出空间
+                for (int spins = 0; !queue.TryPush(std::move(message)); ++spins) {
+                    if (m_impl->stop.load(std::memory_order_acquire)) return;
+                    m_impl->Notify();
+                    if (spins < 64) std::this_thread::yield();
+                    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+                break;
+            }
+            m_impl->Notify();
+        }
+
+        void Logger::WriteToSinks(const Message& message) {
+            // 写入期间标记当前线程，Sink 抛出异常时也要恢复
+            struct SyncWriteScope {
+                SyncWriteScope() { t_inSyncWrite = true; }
+                ~SyncWriteScope() { t_inSyncWrite = false; }
+            };
+            std::shared_lock sinkLock(m_impl->sinkMtx);
+            std::lock_guard writeLock(m_impl->writeMtx);
+            SyncWriteScope scope;
+            for (auto& sink : m_impl->sinks) sink->Write(message);
+        }
+
+        void Logger::SetDeferredFormatting(bool enable) {
+            m_impl->deferredFormatting.store(enable, std::memory_order_relaxed);
+        }
+
+        bool Logger::IsDeferredFormatting() const {
+            return m_impl->deferredFormatting.load(std::memory_order_relaxed);
+        }
+
+        void Logger::SetOverflowPolicy(OverflowPolicy policy) {
+            m_impl->overflowPolicy.store(policy, std::memory_order_relaxed);
+        }
+
+        bool Logger::SetQueueCapacity(size_t capacity) {
+            std::lock_guard<std::mutex> lock(m_impl->startMutex);
+            if (!m_impl->stop.load(std::memory_order_acquire) || m_impl->worker.joinable()) return false;
+            if (m_impl->queue->ApproxSize() != 0) return false;
+            m_impl->queue = std::make_unique<MessageRing>(capacity);
+            return true;
+        }
+
+        size_t Logger::QueueDepth() const {
+            return m_impl->queue->ApproxSize();
+        }
+
+        uint64_t Logger::DroppedCount() const {
+            return static_cast<uint64_t>(m_impl->dropped->Value());
         }
 
         void Logger::SetLevel(Level level) {
-            m_impl->minLevel = level;
+            g_minLevel.store(level, std::memory_order_relaxed);
+        }
+
+        bool Logger::ShouldLog(Level level) noexcept {
+            return level >= g_minLevel.load(std::memory_order_relaxed);
         }
 
         void Logger::SetEncoding(String::Encoding encoding) {
@@ -152,7 +388,10 @@ namespace LikesProgram {
             }
 
             // 通知所有等待线程
-            m_impl->cv.notify_all();
+            {
+                std::lock_guard lock(m_impl->waitMtx);
+                m_impl->cv.notify_all();
+            }
 
             // 等待 worker 线程退出
             if (m_impl->worker.joinable()) {
@@ -171,30 +410,34 @@ namespace LikesProgram {
         }
 
         void Logger::LogMessageString(Level level, const String& msg, const char* file, int line, const char* func) {
+            Submit(level, String(msg), nullptr, file, line, func);
+        }
+
+        void Logger::LogDeferred(Level level, std::shared_ptr<const DeferredFormat> deferred, const char* file, int line, const char* func) {
+            Submit(level, String(), std::move(deferred), file, line, func);
+        }
+
+        void Logger::Submit(Level level, String&& msg, std::shared_ptr<const DeferredFormat>&& deferred, const char* file, int line, const char* func) {
             if (!m_impl) return;
             if (m_impl->stop.load(std::memory_order_acquire)) return;
-            if (level < m_impl->minLevel) return;
+            Level minLevel = g_minLevel.load(std::memory_order_relaxed);
+            if (level < minLevel) return;
 
             try {
                 Message message;
                 message.level = level;
-                message.msg = String(msg);
-                message.file = (file != nullptr) ? String(file) : String();
+                message.msg = std::move(msg);
+                message.deferred = std::move(deferred);
+                message.file = file;
                 message.line = line;
                 message.tid = std::this_thread::get_id();
-                message.threadName = CoreUtils::GetCurrentThreadName();
+                message.threadName = CoreUtils::GetCurrentThreadNameShared();
                 message.timestamp = std::chrono::system_clock::now();
-                message.func = (func != nullptr) ? String(func) : String();
+                message.func = func;
                 message.debug = m_impl->m_debug;
-                message.minLevel = m_impl->minLevel;
+                message.minLevel = minLevel;
                 message.encoding = m_impl->encoding;
-                // 使用 queueMtx 同步 stop 和 queue push
-                {
-                    std::lock_guard<std::mutex> lock(m_impl->queueMtx);
-                    if (m_impl->stop.load(std::memory_order_acquire)) return;
-                    m_impl->queue.push(std::move(message));
-                }
-                m_impl->cv.notify_one();
+                Enqueue(std::move(message));
             }
             catch (const std::exception& e) {
                 std::cerr << "[Logger Error] Failed to log message: " << e.what() << std::endl;
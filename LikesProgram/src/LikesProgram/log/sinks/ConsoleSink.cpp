@@ -5,10 +5,60 @@
 #endif
 #ifdef __linux__
 #include <unistd.h>
+#include <cerrno>
 #endif
 
 namespace LikesProgram {
 	namespace Log {
+        namespace {
+#ifdef _WIN32
+            WORD LevelColor(Level level, WORD defaultColor) {
+                switch (level) {
+                case Level::Info:  return FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED;
+                case Level::Warn:  return FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+                case Level::Error: return FOREGROUND_RED | FOREGROUND_INTENSITY;
+                case Level::Fatal: return BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+                case Level::Debug: return FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+                case Level::Trace: return FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+                }
+                return defaultColor;
+            }
+#else
+            const char8_t* LevelColor(Level level) {
+                switch (level) {
+                case Level::Info:  return u8"\033[0m";
+                case Level::Warn:  return u8"\033[33m";
+                case Level::Error: return u8"\033[31m";
+                case Level::Fatal: return u8"\033[41;97m";
+                case Level::Debug: return u8"\033[32m";
+                case Level::Trace: return u8"\033[34m";
+                }
+                return u8"";
+            }
+#endif
+
+            // 写出缓冲区（先刷新 std::cout 中已有的内容，保证顺序）
+            void WriteStdout(const std::u8string& buffer) {
+                std::cout.flush();
+#ifdef __linux__
+                const char8_t* data = buffer.data();
+                size_t remaining = buffer.size();
+                while (remaining > 0) {
+                    ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+                    if (written < 0) {
+                        if (errno == EINTR) continue;
+                        return; // 输出失败，丢弃本批
+                    }
+                    data += written;
+                    remaining -= static_cast<size_t>(written);
+                }
+#else
+                std::cout.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                std::cout.flush();
+#endif
+            }
+        }
+
 		std::shared_ptr<Sink> ConsoleSink::CreateSink() {
 			return std::make_shared<ConsoleSink>();
 		}
@@ -16,37 +66,40 @@ namespace LikesProgram {
         ConsoleSink::ConsoleSink() : Sink(u"ConsoleSink") { }
 
         void ConsoleSink::Write(const Message& message) {
-            String formatted = FormatLogMessage(message);
+            WriteBatch(std::span<const Message>(&message, 1));
+        }
+
+        void ConsoleSink::WriteBatch(std::span<const Message> messages) {
+            thread_local std::u8string buffer;
+            buffer.clear();
 
 #ifdef _WIN32
             HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
             CONSOLE_SCREEN_BUFFER_INFO info;
             GetConsoleScreenBufferInfo(hConsole, &info);
 
-            WORD color = info.wAttributes;
-            switch (message.level) {
-            case Level::Info:  color = FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED; break;
-            case Level::Warn:  color = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY; break;
-            case Level::Error: color = FOREGROUND_RED | FOREGROUND_INTENSITY; break;
-            case Level::Fatal: color = BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY; break;
-            case Level::Debug: color = FOREGROUND_GREEN | FOREGROUND_INTENSITY; break;
-            case Level::Trace: color = FOREGROUND_BLUE | FOREGROUND_INTENSITY; break;
+            // 颜色需通过控制台 API 设置，相同级别的连续日志合并为一次写出
+            size_t i = 0;
+            while (i < messages.size()) {
+                Level level = messages[i].level;
+                buffer.clear();
+                for (; i < messages.size() && messages[i].level == level; ++i) {
+                    if (!buffer.empty()) buffer.push_back(u8'\n');
+                    AppendEncodedLogMessage(buffer, messages[i]);
+                }
+                buffer.push_back(u8' ');
+                SetConsoleTextAttribute(hConsole, LevelColor(level, info.wAttributes));
+                WriteStdout(buffer);
+                SetConsoleTextAttribute(hConsole, info.wAttributes);
+                std::cout << "\b" << std::endl;
             }
-            SetConsoleTextAttribute(hConsole, color);
-            std::cout << formatted.ToStdString(message.encoding) << ' ';
-            SetConsoleTextAttribute(hConsole, info.wAttributes);
-            std::cout << "\b" << std::endl;
 #else
-            const char* colorCode = "";
-            switch (message.level) {
-            case Level::Info:  colorCode = "\033[0m"; break;
-            case Level::Warn:  colorCode = "\033[33m"; break;
-            case Level::Error: colorCode = "\033[31m"; break;
-            case Level::Fatal: colorCode = "\033[41;97m"; break;
-            case Level::Debug: colorCode = "\033[32m"; break;
-            case Level::Trace: colorCode = "\033[34m"; break;
+            for (const Message& message : messages) {
+                buffer.append(LevelColor(message.level));
+                AppendEncodedLogMessage(buffer, message);
+                buffer.append(u8"\033[0m\n");
             }
-            std::cout << colorCode << formatted.ToStdString(message.encoding) << "\033[0m" << std::endl;
+            WriteStdout(buffer);
 #endif
         }
 	}
@@ -1,31 +1,143 @@
 ﻿#include "../../../../include/LikesProgram/log/sinks/FileSink.hpp"
 #include "../../../../include/LikesProgram/time/Time.hpp"
-#include <fstream>
+#include <cstdio>
 #include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace LikesProgram {
 	namespace Log {
+		namespace {
+			using FileHandle = std::shared_ptr<std::FILE>;
+
+			// 将内核缓冲写入磁盘
+			void SyncFile(std::FILE* file) {
+#ifdef _WIN32
+				_commit(_fileno(file));
+#else
+				fsync(fileno(file));
+#endif
+			}
+		}
+
 		class FileSink::FileSinkImpl {
 		public:
-			explicit FileSinkImpl(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB = 30)
-				: m_path(path), m_filename(filename), m_current_size(0), m_max_file_size(maxFileSizeMB * 1024 * 1024) {
+			explicit FileSinkImpl(const LikesProgram::String& path, const LikesProgram::String& filename, const Options& options)
+				: m_path(path), m_filename(filename), m_options(options), m_max_file_size(options.maxFileSizeMB * 1024 * 1024) {
 				if (m_path.Empty()) m_path = u"./logs"; // 默认路径
 				if (m_filename.Empty()) m_filename = u"Logger.log"; // 默认文件名
+				m_pending.reserve(m_options.flushBytes);
 				OpenNewFile();
+				m_last_flush_time = std::chrono::steady_clock::now();
+
+				// 定时写入 / fsync 由后台线程完成，不占用日志线程
+				if (m_options.flushInterval.count() > 0 || m_options.fsyncInterval.count() > 0) {
+					m_flusher = std::thread([this]() { FlusherLoop(); });
+				}
+			}
+
+			~FileSinkImpl() {
+				{
+					std::lock_guard lock(m_mutex);
+					m_stop = true;
+				}
+				m_cv.notify_all();
+				if (m_flusher.joinable()) m_flusher.join();
+
+				std::lock_guard lock(m_mutex);
+				FlushLocked();
+				for (const FileHandle& file : m_retired) SyncFile(file.get()); // 后台线程未及同步的旧文件
 			}
 
-			void Write(const String& formatted, String::Encoding encoding, std::chrono::system_clock::time_point timestamp) {
-				if (NeedRotate(timestamp)) OpenNewFile(); // 切分新文件
-				if (!m_file.is_open()) return; // 打开失败，丢弃本次输出
+			std::mutex& Mutex() { return m_mutex; }
+			Level FlushLevel() const { return m_options.flushLevel; }
+
+			// 追加一条已编码的日志（含换行）到缓冲区，需要轮转时先写出已有内容（调用方持有锁）
+			void Append(const std::u8string& line, std::chrono::system_clock::time_point timestamp) {
+				if (NeedRotate(timestamp)) {
+					FlushLocked();
+					// 旧文件还有未 fsync 的写入时交给后台线程同步（持有句柄直到同步完成），新文件从头计算
+					if (m_unsynced && m_options.fsyncInterval.count() > 0) {
+						m_retired.push_back(m_file);
+						m_cv.notify_all();
+					}
+					m_unsynced = false;
+					OpenNewFile(); // 切分新文件
+				}
+				if (!m_file) return; // 打开失败，丢弃本次输出
+
+				m_pending.append(line);
+				m_current_size += line.size();
+			}
+
+			// 一批结束：按刷新策略决定是否写入文件（调用方持有锁）
+			void EndBatch(bool urgent) {
+				if (m_pending.empty()) return;
+				if (urgent || m_pending.size() >= m_options.flushBytes ||
+					(m_options.flushInterval.count() > 0 && std::chrono::steady_clock::now() - m_last_flush_time >= m_options.flushInterval)) {
+					FlushLocked();
+				}
+			}
 
-				// 执行记录
-				m_file << formatted.ToStdString(encoding) << std::endl;
-				m_current_size += formatted.Size();
+			// 将缓冲区一次写入文件（调用方持有锁）
+			void FlushLocked() {
+				m_last_flush_time = std::chrono::steady_clock::now();
+				if (m_pending.empty()) return;
+				if (m_file) {
+					std::fwrite(m_pending.data(), 1, m_pending.size(), m_file.get());
+					std::fflush(m_file.get());
+					m_unsynced = true;
+				}
+				m_pending.clear();
 			}
 		private:
+			void FlusherLoop() {
+				auto period = std::chrono::milliseconds::max();
+				if (m_options.flushInterval.count() > 0) period = std::min(period, m_options.flushInterval);
+				if (m_options.fsyncInterval.count() > 0) period = std::min(period, m_options.fsyncInterval);
+				auto lastSync = std::chrono::steady_clock::now();
+
+				std::unique_lock lock(m_mutex);
+				while (!m_stop) {
+					m_cv.wait_for(lock, period, [this]() { return m_stop || !m_retired.empty(); });
+					if (m_stop) break;
+
+					// 轮转下来的旧文件在锁外同步后关闭
+					if (!m_retired.empty()) {
+						std::vector<FileHandle> retired;
+						retired.swap(m_retired);
+						lock.unlock();
+						for (const FileHandle& file : retired) SyncFile(file.get());
+						retired.clear();
+						lock.lock();
+						if (m_stop) break;
+					}
+
+					auto now = std::chrono::steady_clock::now();
+					if (m_options.flushInterval.count() > 0 && now - m_last_flush_time >= m_options.flushInterval) FlushLocked();
+
+					if (m_options.fsyncInterval.count() > 0 && m_unsynced && now - lastSync >= m_options.fsyncInterval) {
+						// fsync 可能较慢，持有文件引用后在锁外执行（轮转关闭文件时不会失效）
+						FileHandle file = m_file;
+						m_unsynced = false;
+						lastSync = now;
+						lock.unlock();
+						if (file) SyncFile(file.get());
+						lock.lock();
+					}
+				}
+			}
+
 			// 打开新日志文件
 			void OpenNewFile() {
-				if (m_file.is_open()) m_file.close();
+				m_file.reset();
 
 				// 生成新文件名
 				m_last_rotate_time = std::chrono::system_clock::now();
@@ -36,29 +148,35 @@ namespace LikesProgram {
 				std::filesystem::create_directories(dir); // 创建文件夹
 
 				std::string file;
+				size_t existingSize = 0;
 				while (true)
 				{
 					file = BuildLogFileName(dir, m_filename.ToStdString(), m_file_index);
 
 					// 文件不存在，直接使用
-					if (!std::filesystem::exists(file)) break;
+					if (!std::filesystem::exists(file)) {
+						existingSize = 0;
+						break;
+					}
 
-					auto size = std::filesystem::file_size(file);
+					existingSize = std::filesystem::file_size(file);
 
-					if (m_max_file_size == 0 || size < m_max_file_size) break;
+					if (m_max_file_size == 0 || existingSize < m_max_file_size) break;
 
 					// 已满，尝试下一个
 					++m_file_index;
 				}
 
-				// 打开文件
-				m_file.open(file, std::ios::out | std::ios::app);
-				if (!m_file) throw std::runtime_error("Failed to open log file: " + file);
+				// 打开文件（二进制追加，按实际写入字节计算大小）
+				std::FILE* handle = std::fopen(file.c_str(), "ab");
+				if (!handle) throw std::runtime_error("Failed to open log file: " + file);
+				m_file = FileHandle(handle, [](std::FILE* f) { std::fclose(f); });
+				m_current_size = existingSize;
 			}
 
 			// 是否需要切换文件
 			bool NeedRotate(std::chrono::system_clock::time_point time) {
-				if (!m_file.is_open()) return false;
+				if (!m_file) return false;
 
 				// 按文件大小轮转
 				if (m_max_file_size > 0 && m_current_size >= m_max_file_size) return true;
@@ -82,18 +200,32 @@ namespace LikesProgram {
 				return (dir / (std::to_string(index) + "_" + base)).string();
 			}
 		private:
-			std::ofstream m_file;
+			FileHandle m_file;
+			std::u8string m_pending; // 待写入的内容
 			LikesProgram::String m_path; // 文件路径
 			size_t m_file_index = 0; // 文件索引（同一日期多个文件时使用）
 			LikesProgram::String m_filename; // 当前文件名
-			size_t m_current_size = 0; // 当前文件大小
+			Options m_options;
+			size_t m_current_size = 0; // 当前文件大小（字节，含未写入的缓冲）
 			size_t m_max_file_size = 0; // 最大文件大小
 			std::chrono::system_clock::time_point m_last_rotate_time; // 上次切换文件的时间
+			std::chrono::steady_clock::time_point m_last_flush_time; // 上次写入文件的时间
+
+			std::mutex m_mutex; // 日志线程与后台刷新线程互斥
+			std::condition_variable m_cv;
+			std::thread m_flusher;
+			bool m_stop = false;
+			bool m_unsynced = false; // 上次 fsync 后是否有新写入
+			std::vector<FileHandle> m_retired; // 轮转后等待后台线程 fsync 的旧文件
 		};
 
 		FileSink::FileSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB)
+			: FileSink(path, filename, Options{ maxFileSizeMB }) {
+		}
+
+		FileSink::FileSink(const LikesProgram::String& path, const LikesProgram::String& filename, const Options& options)
 		: Sink(u"FileSink") {
-			m_impl = new FileSinkImpl(path, filename, maxFileSizeMB);
+			m_impl = new FileSinkImpl(path, filename, options);
 		}
 		FileSink::~FileSink() {
 			if(m_impl) delete m_impl;
@@ -101,12 +233,38 @@ namespace LikesProgram {
 		}
 
 		void FileSink::Write(const Message& message) {
-			LikesProgram::String formatted = FormatLogMessage(message);
-			m_impl->Write(formatted, message.encoding, message.timestamp);
+			WriteBatch(std::span<const Message>(&message, 1));
+		}
+
+		void FileSink::WriteBatch(std::span<const Message> messages) {
+			thread_local std::u8string line;
+			bool urgent = false;
+			std::lock_guard lock(m_impl->Mutex());
+			for (const Message& message : messages) {
+				line.clear();
+				AppendEncodedLogMessage(line, message);
+#ifdef _WIN32
+				line.append(u8"\r\n");
+#else
+				line.push_back(u8'\n');
+#endif
+				m_impl->Append(line, message.timestamp);
+				if (message.level >= m_impl->FlushLevel()) urgent = true;
+			}
+			m_impl->EndBatch(urgent);
+		}
+
+		void FileSink::Flush() {
+			std::lock_guard lock(m_impl->Mutex());
+			m_impl->FlushLocked();
 		}
 
 		std::shared_ptr<Sink> FileSink::CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB) {
 			return std::make_shared<FileSink>(path, filename, maxFileSizeMB);
 		}
+
+		std::shared_ptr<Sink> FileSink::CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, const Options& options) {
+			return std::make_shared<FileSink>(path, filename, options);
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,444 @@
+﻿#include "../../../../include/LikesProgram/log/sinks/MmapFileSink.hpp"
+#include "../../../../include/LikesProgram/time/Time.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace LikesProgram {
+	namespace Log {
+		namespace {
+			// 日志分段：预分配并映射的定长文件
+			struct Segment {
+				std::filesystem::path path;
+				int day = 0;                        // 所属日期（YYYYMMDD）
+				std::chrono::system_clock::time_point dayEnd; // 所属日期的结束时间，写入时据此判断是否跨日
+				size_t size = 0;                    // 分段容量（字节）
+				char8_t* base = nullptr;            // 映射地址
+				std::atomic<size_t> cursor{ 0 };    // 已分配的写入位置（可能超过 size）
+				std::atomic<size_t> committed{ 0 }; // 已完成拷贝的字节数
+				size_t used = 0;                    // 封存时的有效长度
+				std::atomic<bool> sealed{ false };  // 是否已完成切换
+#ifdef _WIN32
+				HANDLE file = INVALID_HANDLE_VALUE;
+				HANDLE mapping = nullptr;
+#else
+				int fd = -1;
+#endif
+			};
+
+			// 写入者登记槽位：按线程分散到多个缓存行，避免所有写入者竞争同一个计数器
+			constexpr size_t WriterSlotCount = 16;
+
+			struct alignas(64) WriterSlot {
+				std::atomic<size_t> count{ 0 };
+			};
+
+			size_t CurrentWriterSlot() noexcept {
+				static std::atomic<size_t> next{ 0 };
+				thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed) % WriterSlotCount;
+				return slot;
+			}
+
+			int DayKey(const std::tm& tm) {
+				return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+			}
+
+			// 创建、预分配并映射分段文件
+			bool MapSegment(Segment& seg) {
+#ifdef _WIN32
+				seg.file = CreateFileW(seg.path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (seg.file == INVALID_HANDLE_VALUE) return false;
+				LARGE_INTEGER size;
+				size.QuadPart = static_cast<LONGLONG>(seg.size);
+				seg.mapping = CreateFileMappingW(seg.file, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr); // 同时扩展文件
+				if (!seg.mapping) return false;
+				seg.base = static_cast<char8_t*>(MapViewOfFile(seg.mapping, FILE_MAP_WRITE, 0, 0, seg.size));
+				return seg.base != nullptr;
+#else
+				seg.fd = ::open(seg.path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+				if (seg.fd < 0) return false;
+#ifdef __linux__
+				if (posix_fallocate(seg.fd, 0, static_cast<off_t>(seg.size)) != 0 && ftruncate(seg.fd, static_cast<off_t>(seg.size)) != 0) return false;
+#else
+				if (ftruncate(seg.fd, static_cast<off_t>(seg.size)) != 0) return false;
+#endif
+				void* base = mmap(nullptr, seg.size, PROT_READ | PROT_WRITE, MAP_SHARED, seg.fd, 0);
+				if (base == MAP_FAILED) return false;
+				seg.base = static_cast<char8_t*>(base);
+				return true;
+#endif
+			}
+
+			// 解除映射，截断到有效长度并关闭；空分段直接删除
+			void CloseSegment(Segment& seg) {
+#ifdef _WIN32
+				if (seg.base) UnmapViewOfFile(seg.base);
+				if (seg.mapping) CloseHandle(seg.mapping);
+				if (seg.file != INVALID_HANDLE_VALUE) {
+					LARGE_INTEGER size;
+					size.QuadPart = static_cast<LONGLONG>(seg.used);
+					SetFilePointerEx(seg.file, size, nullptr, FILE_BEGIN);
+					SetEndOfFile(seg.file);
+					CloseHandle(seg.file);
+				}
+				seg.mapping = nullptr;
+				seg.file = INVALID_HANDLE_VALUE;
+#else
+				if (seg.base) munmap(seg.base, seg.size);
+				if (seg.fd >= 0) {
+					if (ftruncate(seg.fd, static_cast<off_t>(seg.used)) != 0) { /* 截断失败时保留预分配的尾部 */ }
+					::close(seg.fd);
+				}
+				seg.fd = -1;
+#endif
+				seg.base = nullptr;
+				if (seg.used == 0) {
+					std::error_code ec;
+					std::filesystem::remove(seg.path, ec);
+				}
+			}
+		}
+
+		class MmapFileSink::MmapFileSinkImpl {
+		public:
+			// 写入区间：区间内可安全访问 m_current 指向的分段。
+			// 后台线程回收分段前推进纪元，并等待在旧纪元登记的写入者全部离开
+			class WriteScope {
+			public:
+				explicit WriteScope(MmapFileSinkImpl& impl) {
+					size_t slot = CurrentWriterSlot();
+					for (;;) {
+						uint64_t epoch = impl.m_epoch.load(std::memory_order_seq_cst);
+						m_counter = &impl.m_writers[epoch & 1][slot].count;
+						m_counter->fetch_add(1, std::memory_order_seq_cst);
+						if (impl.m_epoch.load(std::memory_order_seq_cst) == epoch) return;
+						m_counter->fetch_sub(1, std::memory_order_release); // 纪元已推进，改在新纪元登记
+					}
+				}
+				~WriteScope() { m_counter->fetch_sub(1, std::memory_order_release); }
+
+				WriteScope(const WriteScope&) = delete;
+				WriteScope& operator=(const WriteScope&) = delete;
+			private:
+				std::atomic<size_t>* m_counter = nullptr;
+			};
+
+			MmapFileSinkImpl(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB)
+				: m_path(path), m_filename(filename), m_segment_size((maxFileSizeMB ? maxFileSizeMB : 30) * 1024 * 1024) {
+				if (m_path.Empty()) m_path = u"./logs"; // 默认路径
+				if (m_filename.Empty()) m_filename = u"Logger.log"; // 默认文件名
+
+				Segment* first = CreateSegment();
+				if (!first) throw std::runtime_error("Failed to map log segment: " + m_path.ToStdString());
+				m_current.store(first, std::memory_order_release);
+				m_worker = std::thread([this]() { WorkerLoop(); });
+			}
+
+			~MmapFileSinkImpl() {
+				{
+					std::lock_guard lock(m_mutex);
+					m_stop = true;
+				}
+				m_cv.notify_all();
+				if (m_worker.joinable()) m_worker.join();
+
+				// 此时已无写入者：封存当前分段，删除未使用的预备分段
+				// （切换失败时当前分段已封存，保留切换时记录的有效长度）
+				Segment* seg = m_current.load(std::memory_order_acquire);
+				if (!seg->sealed.load(std::memory_order_acquire)) seg->used = std::min(seg->cursor.load(std::memory_order_acquire), seg->size);
+				CloseSegment(*seg);
+				if (m_next) CloseSegment(*m_next);
+				for (Segment* retired : m_retired) CloseSegment(*retired);
+				m_segments.clear();
+			}
+
+			// 追加一条记录（可多线程并发调用）
+			void Append(const char8_t* data, size_t length) {
+				for (;;) {
+					Segment* seg = m_current.load(std::memory_order_acquire);
+					size_t len = std::min(length, seg->size); // 超过分段大小的记录被截断
+					size_t offset = seg->cursor.fetch_add(len, std::memory_order_relaxed);
+					if (offset + len <= seg->size) {
+						std::memcpy(seg->base + offset, data, len);
+						seg->committed.fetch_add(len, std::memory_order_release);
+						return;
+					}
+					// 跨越分段末尾的写入者负责切换，其余写入者等待新分段
+					if (offset <= seg->size) Rotate(seg, offset);
+					else WaitRotated(seg);
+					if (m_current.load(std::memory_order_acquire) == seg && !RecoverFailedRotate(seg)) {
+						// 无法创建新分段且后台尚未准备好，丢弃
+						m_dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+				}
+			}
+
+			uint64_t DroppedCount() const {
+				return m_dropped.load(std::memory_order_relaxed);
+			}
+
+			// 跨日时切换分段（timestamp 属于新的一天时）
+			void CheckDate(std::chrono::system_clock::time_point timestamp) {
+				Segment* seg = m_current.load(std::memory_order_acquire);
+				if (timestamp < seg->dayEnd) return;
+				if (seg->day == DayKey(LikesProgram::Time::ToLocalTime(std::chrono::system_clock::to_time_t(timestamp)))) return;
+				// 占满剩余空间，成为唯一的切换者
+				size_t offset = seg->cursor.fetch_add(seg->size + 1, std::memory_order_relaxed);
+				if (offset <= seg->size) Rotate(seg, offset);
+				else WaitRotated(seg);
+			}
+
+			void Flush() {
+				Segment* seg = m_current.load(std::memory_order_acquire);
+				size_t used = std::min(seg->committed.load(std::memory_order_acquire), seg->size);
+				if (used == 0) return;
+#ifdef _WIN32
+				FlushViewOfFile(seg->base, used);
+#else
+				msync(seg->base, used, MS_ASYNC);
+#endif
+			}
+		private:
+			// 封存 seg（有效长度 used）并切换到下一个分段
+			void Rotate(Segment* seg, size_t used) {
+				// 等待位于 used 之前的写入完成
+				while (seg->committed.load(std::memory_order_acquire) < used) std::this_thread::yield();
+				seg->used = used;
+
+				Segment* next = nullptr;
+				{
+					std::lock_guard lock(m_mutex);
+					next = m_next;
+					m_next = nullptr;
+				}
+				int today = DayKey(LikesProgram::Time::ToLocalTime(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())));
+				if (next && next->day != today) {
+					// 预备分段属于前一天，丢弃
+					std::lock_guard lock(m_mutex);
+					m_retired.push_back(next);
+					next = nullptr;
+				}
+				if (!next) next = CreateSegment(); // 后台尚未准备好，同步创建
+				if (!next) {
+					// 无法创建新分段：旧分段已满，在后台准备好新分段前写入的日志被丢弃
+					std::cerr << "[MmapFileSink Error] Failed to map next log segment" << std::endl;
+					seg->sealed.store(true, std::memory_order_release);
+					m_cv.notify_one(); // 让后台重试创建
+					return;
+				}
+
+				// 先切换 m_current 再交给后台回收：回收时推进纪元后进入的写入者不会再取到旧分段
+				m_current.store(next, std::memory_order_seq_cst);
+				seg->sealed.store(true, std::memory_order_release);
+				{
+					std::lock_guard lock(m_mutex);
+					m_retired.push_back(seg);
+				}
+				m_cv.notify_one();
+			}
+
+			void WaitRotated(Segment* seg) {
+				while (!seg->sealed.load(std::memory_order_acquire)) std::this_thread::yield();
+			}
+
+			// 切换失败后 seg 已封存但仍为当前分段：若后台已准备好新分段则换上（返回是否已切换）
+			bool RecoverFailedRotate(Segment* seg) {
+				std::lock_guard lock(m_mutex);
+				return InstallPrepared(seg);
+			}
+
+			// 调用方持有 m_mutex
+			bool InstallPrepared(Segment* seg) {
+				if (m_current.load(std::memory_order_acquire) != seg) return true; // 已由其他线程换上
+				if (!seg->sealed.load(std::memory_order_acquire) || !m_next) return false;
+				int today = DayKey(LikesProgram::Time::ToLocalTime(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())));
+				if (m_next->day != today) {
+					// 预备分段属于前一天，丢弃并由后台重新准备
+					m_retired.push_back(m_next);
+					m_next = nullptr;
+					m_cv.notify_one();
+					return false;
+				}
+				m_current.store(m_next, std::memory_order_seq_cst);
+				m_next = nullptr;
+				m_retired.push_back(seg);
+				m_cv.notify_one();
+				return true;
+			}
+
+			// 后台：关闭已封存的分段，并预先准备下一个分段
+			void WorkerLoop() {
+				std::unique_lock lock(m_mutex);
+				while (!m_stop) {
+					std::vector<Segment*> retired;
+					retired.swap(m_retired);
+					bool needNext = (m_next == nullptr);
+					lock.unlock();
+
+					if (!retired.empty()) {
+						// 等待可能仍持有旧分段指针的写入者离开后再关闭并释放
+						WaitForWriters();
+						for (Segment* seg : retired) CloseSegment(*seg);
+						ReleaseSegments(retired);
+					}
+					Segment* prepared = needNext ? CreateSegment() : nullptr;
+
+					lock.lock();
+					if (prepared) {
+						if (m_next) m_retired.push_back(prepared);
+						else m_next = prepared;
+					}
+					// 之前的切换失败时由后台换上新分段，写入随即恢复
+					InstallPrepared(m_current.load(std::memory_order_acquire));
+					if (needNext && !prepared) m_cv.wait_for(lock, std::chrono::seconds(1)); // 创建失败，稍后重试
+					else m_cv.wait_for(lock, std::chrono::seconds(1), [this]() { return m_stop || !m_retired.empty() || !m_next; });
+				}
+			}
+
+			// 推进纪元，等待在旧纪元登记的写入者全部离开（仅后台线程调用）
+			void WaitForWriters() {
+				uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+				for (WriterSlot& slot : m_writers[epoch & 1]) {
+					while (slot.count.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+				}
+			}
+
+			// 释放已关闭分段的对象
+			void ReleaseSegments(const std::vector<Segment*>& closed) {
+				std::lock_guard lock(m_create_mutex);
+				std::erase_if(m_segments, [&closed](const std::unique_ptr<Segment>& seg) {
+					return std::find(closed.begin(), closed.end(), seg.get()) != closed.end();
+				});
+			}
+
+			// 在今天的目录下创建并映射新的分段（失败返回 nullptr）
+			Segment* CreateSegment() {
+				std::lock_guard lock(m_create_mutex);
+				auto now = std::chrono::system_clock::now();
+				std::tm tm = LikesProgram::Time::ToLocalTime(std::chrono::system_clock::to_time_t(now));
+				int day = DayKey(tm);
+				if (day != m_index_day) {
+					m_index_day = day;
+					m_file_index = 0;
+				}
+
+				LikesProgram::String timeDir = LikesProgram::String::Format(u"{:tYYYY-MM-DD}", now);
+				std::filesystem::path dir = std::filesystem::path(m_path.ToStdString()) / timeDir.ToStdString();
+				std::error_code ec;
+				std::filesystem::create_directories(dir, ec);
+
+				// 分段写入后不再追加，跳过已存在的文件
+				std::filesystem::path file;
+				std::string base = m_filename.ToStdString();
+				do {
+					file = m_file_index == 0 ? dir / base : dir / (std::to_string(m_file_index) + "_" + base);
+					++m_file_index;
+				} while (std::filesystem::exists(file, ec));
+
+				m_segments.push_back(std::make_unique<Segment>());
+				Segment& seg = *m_segments.back();
+				seg.path = file;
+				seg.day = day;
+				seg.size = m_segment_size;
+				if (!MapSegment(seg)) {
+					CloseSegment(seg);
+					m_segments.pop_back();
+					return nullptr;
+				}
+
+				// 记录当天结束时间，写入时据此判断是否跨日
+				tm.tm_hour = 0;
+				tm.tm_min = 0;
+				tm.tm_sec = 0;
+				tm.tm_mday += 1;
+				tm.tm_isdst = -1;
+				seg.dayEnd = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+				return &seg;
+			}
+
+			LikesProgram::String m_path;
+			LikesProgram::String m_filename;
+			size_t m_segment_size;
+
+			std::atomic<Segment*> m_current{ nullptr };
+			std::atomic<uint64_t> m_dropped{ 0 }; // 无可用分段时丢弃的日志条数
+
+			// 切换后仍可能有写入者读取旧分段的游标，Segment 对象在写入者离开（纪元推进）后才释放
+			std::atomic<uint64_t> m_epoch{ 0 };
+			WriterSlot m_writers[2][WriterSlotCount];
+
+			std::mutex m_create_mutex;
+			std::vector<std::unique_ptr<Segment>> m_segments;
+			int m_index_day = 0;
+			size_t m_file_index = 0;
+
+			std::mutex m_mutex; // 保护 m_next / m_retired
+			std::condition_variable m_cv;
+			Segment* m_next = nullptr;
+			std::vector<Segment*> m_retired;
+			std::thread m_worker;
+			bool m_stop = false;
+		};
+
+		MmapFileSink::MmapFileSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB)
+			: Sink(u"MmapFileSink") {
+			m_impl = new MmapFileSinkImpl(path, filename, maxFileSizeMB);
+		}
+
+		MmapFileSink::~MmapFileSink() {
+			if (m_impl) delete m_impl;
+			m_impl = nullptr;
+		}
+
+		void MmapFileSink::Write(const Message& message) {
+			WriteBatch(std::span<const Message>(&message, 1));
+		}
+
+		void MmapFileSink::WriteBatch(std::span<const Message> messages) {
+			thread_local std::u8string line;
+			MmapFileSinkImpl::WriteScope scope(*m_impl);
+			for (const Message& message : messages) {
+				m_impl->CheckDate(message.timestamp);
+				line.clear();
+				AppendEncodedLogMessage(line, message);
+#ifdef _WIN32
+				line.append(u8"\r\n");
+#else
+				line.push_back(u8'\n');
+#endif
+				m_impl->Append(line.data(), line.size());
+			}
+		}
+
+		uint64_t MmapFileSink::DroppedCount() const {
+			return m_impl->DroppedCount();
+		}
+
+		void MmapFileSink::Flush() {
+			MmapFileSinkImpl::WriteScope scope(*m_impl);
+			m_impl->Flush();
+		}
+
+		std::shared_ptr<Sink> MmapFileSink::CreateSink(const LikesProgram::String& path, const LikesProgram::String& filename, size_t maxFileSizeMB) {
+			return std::make_shared<MmapFileSink>(path, filename, maxFileSizeMB);
+		}
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#include "../../../../include/LikesProgram/log/sinks/Sink.hpp"
 #include "../../../../include/LikesProgram/time/Time.hpp"
-#include <iomanip>
+#include <ctime>
+#include <sstream>
 
 namespace LikesProgram {
     namespace Log {
@@ -8,40 +9,58 @@ namespace LikesProgram {
             m_sinkName = sinkName.Empty() ? u"UnknownSink" : sinkName;
         }
 
+        void Sink::WriteBatch(std::span<const Message> messages) {
+            for (const Message& message : messages) Write(message);
+        }
+
         const String Sink::FormatLogMessage(const Message& message) {
+            // 按线程复用行缓冲区（不与 String::Format 的线程缓冲区共用，避免嵌套格式化时互相覆盖）
+            thread_local std::u8string line;
+            line.clear();
+            FormatLogMessageTo(line, message);
+            return String(line);
+        }
+
+        void Sink::FormatLogMessageTo(std::u8string& out, const Message& message) {
             auto time_tc = std::chrono::system_clock::to_time_t(message.timestamp);
             auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(message.timestamp.time_since_epoch()) % 1000;
 
-            std::wostringstream woss;
             // 时间
             std::tm tm = LikesProgram::Time::ToLocalTime(time_tc);
-            woss << L"[" << std::put_time(&tm, L"%F %T") << L"." << std::setw(3) << std::setfill(L'0') << time_ms.count() << L"] ";
+            char timeText[32];
+            std::strftime(timeText, sizeof(timeText), "%F %T", &tm);
+            String::FormatTo(out, u8"[{}.{:03}] ", timeText, static_cast<long long>(time_ms.count()));
 
             // 线程信息
-            woss << L"[T:";
-            if (!message.threadName.Empty()) woss << message.threadName.ToWString();
-            else woss << message.tid;
-            woss << L"] ";
-
-            // 输出器名称
-            woss << L"[" << (m_sinkName.Empty() ? L"UnknownSink" : m_sinkName.ToWString()) << L"] ";
+            if (message.threadName && !message.threadName->Empty()) {
+                String::FormatTo(out, u8"[T:{}] ", *message.threadName);
+            }
+            else {
+                std::ostringstream oss;
+                oss << message.tid;
+                String::FormatTo(out, u8"[T:{}] ", oss.str());
+            }
 
-            // 日志级别
-            woss << L"[" << LevelToString(message.level).ToWString() << L"] ";
+            // 输出器名称、日志级别
+            String::FormatTo(out, u8"[{}] [{}] ", m_sinkName, LevelToString(message.level));
 
             // 是否输出 调试信息
             if (message.debug) {
-                // 函数信息
-                woss << L"[Function:" << message.func << L"] ";
-
-                // 文件信息
-                woss << L"(" << message.file << L":" << message.line << L") ";
+                // 函数信息、文件信息
+                String::FormatTo(out, u8"[Function:{}] ({}:{}) ", message.func ? message.func : "", message.file ? message.file : "", message.line);
             }
 
             // 日志消息
-            woss << message.msg.ToWString();
+            message.msg.AppendTo(out);
+        }
 
-            return String(woss.str());
+        void Sink::AppendEncodedLogMessage(std::u8string& out, const Message& message) {
+            if (message.encoding == String::Encoding::UTF8) {
+                FormatLogMessageTo(out, message);
+                return;
+            }
+            std::string encoded = FormatLogMessage(message).ToStdString(message.encoding);
+            out.append(reinterpret_cast<const char8_t*>(encoded.data()), encoded.size());
         }
     }
 }
\ No newline at end of file
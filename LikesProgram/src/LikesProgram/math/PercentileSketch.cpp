@@ -1,6 +1,7 @@
 ﻿#include "../../../include/LikesProgram/math/PercentileSketch.hpp"
 #include <algorithm>
 #include <stdexcept>
+#include <climits>
 #include <cmath>
 #include <cstring>
 #include <mutex>
@@ -11,15 +12,81 @@
 #include <utility>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 
 namespace LikesProgram {
     namespace Math {
+        namespace {
+            constexpr uint32_t ThreadBufferSize = 128;
+
+            // 实例编号只增不复用，线程缓存中已销毁实例的条目不会被误用
+            std::atomic<uint64_t> g_nextSketchId{ 1 };
+
+            // 实例的线程缓冲登记表：线程缓存以弱引用持有，实例销毁后自动失效
+            struct BufferRegistry {
+                std::mutex mutex;             // 保护实例的缓冲列表与 orphaned
+                std::vector<void*> orphaned;  // 所属线程已退出的缓冲，供新线程复用
+            };
+        }
+
+        // 单生产者（所属线程）/ 单消费者（持所属分片独占锁的一方）环形缓冲
+        struct PercentileSketch::ThreadBuffer {
+            size_t shard = 0;
+            std::atomic<uint32_t> head{ 0 };
+            std::atomic<uint32_t> tail{ 0 };
+            double values[ThreadBufferSize];
+        };
+
         struct PercentileSketch::PercentileSketchImpl {
             std::vector<std::unique_ptr<Shard>> m_shardData;
+
+            Ingest m_ingest = Ingest::Shared;
+            uint64_t m_id = g_nextSketchId.fetch_add(1, std::memory_order_relaxed);
+            std::shared_ptr<BufferRegistry> m_registry = std::make_shared<BufferRegistry>();
+            // 由 m_registry->mutex 保护；线程退出后缓冲转为闲置并由新线程复用，数量不超过同时写入的线程数
+            std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
         };
 
-        PercentileSketch::PercentileSketch(size_t compression, size_t shards)
+        namespace {
+            // 线程缓存已析构（线程退出过程中），此后本线程改走共享分片路径
+            thread_local bool t_bufferCacheTornDown = false;
+
+            // 线程内缓存：实例编号 → 本线程的缓冲
+            struct ThreadBufferCache {
+                struct Entry {
+                    std::weak_ptr<BufferRegistry> registry;
+                    void* buffer = nullptr;
+                };
+
+                uint64_t lastId = 0;
+                void* last = nullptr;
+                std::unordered_map<uint64_t, Entry> all;
+                size_t sweepAt = 16;
+
+                // 线程退出：把缓冲交还仍存活的实例（缓冲中的值照常由读取方合并）
+                ~ThreadBufferCache() {
+                    t_bufferCacheTornDown = true;
+                    for (auto& [id, entry] : all) {
+                        if (auto registry = entry.registry.lock()) {
+                            std::lock_guard lock(registry->mutex);
+                            registry->orphaned.push_back(entry.buffer);
+                        }
+                    }
+                }
+
+                // 清理已销毁实例的条目（条目数翻倍时才扫描，均摊开销为常数）
+                void Sweep() {
+                    if (all.size() < sweepAt) return;
+                    std::erase_if(all, [](const auto& item) { return item.second.registry.expired(); });
+                    sweepAt = std::max<size_t>(16, all.size() * 2);
+                }
+            };
+            thread_local ThreadBufferCache t_bufferCache;
+        }
+
+        PercentileSketch::PercentileSketch(size_t compression, size_t shards, Ingest ingest)
             : m_compression(compression), m_shards(shards), m_impl(new PercentileSketchImpl{}) {
+            m_impl->m_ingest = ingest;
             if (compression < 20) compression = 20;
             if (shards == 0) shards = 1;
             m_impl->m_shardData.reserve(shards);
@@ -29,7 +96,9 @@ namespace LikesProgram {
         }
         PercentileSketch::PercentileSketch(const PercentileSketch& other)
             : m_compression(other.m_compression), m_shards(other.m_shards) {
+            other.drainThreadBuffers();
             m_impl = new PercentileSketchImpl{};
+            m_impl->m_ingest = other.m_impl->m_ingest;
             m_impl->m_shardData.reserve(m_shards);
             for (const auto& shardPtr : other.m_impl->m_shardData) {
                 auto newShard = std::make_unique<Shard>();
@@ -46,7 +115,9 @@ namespace LikesProgram {
             m_compression = other.m_compression;
             m_shards = other.m_shards;
 
+            other.drainThreadBuffers();
             PercentileSketchImpl* newImpl = new PercentileSketchImpl{};
+            newImpl->m_ingest = other.m_impl->m_ingest;
             newImpl->m_shardData.reserve(m_shards);
             for (const auto& shardPtr : other.m_impl->m_shardData) {
                 auto newShard = std::make_unique<Shard>();
@@ -86,6 +157,21 @@ namespace LikesProgram {
         }
 
         void PercentileSketch::Add(double x) {
+            ThreadBuffer* local = m_impl->m_ingest == Ingest::ThreadLocal ? LocalBuffer() : nullptr;
+            if (local) {
+                ThreadBuffer& buffer = *local;
+                uint32_t head = buffer.head.load(std::memory_order_relaxed);
+                if (head - buffer.tail.load(std::memory_order_acquire) >= ThreadBufferSize) {
+                    // 缓冲已满，整体交给分片
+                    Shard& shard = *(m_impl->m_shardData[buffer.shard]);
+                    std::unique_lock lock(shard.mtx); // 独占锁
+                    drainBuffer(buffer, shard);
+                }
+                buffer.values[head % ThreadBufferSize] = x;
+                buffer.head.store(head + 1, std::memory_order_release);
+                return;
+            }
+
             size_t shardId = std::hash<std::thread::id>{}(std::this_thread::get_id()) % m_shards;
             Shard& shard = *(m_impl->m_shardData[shardId]);
             {
@@ -101,6 +187,65 @@ namespace LikesProgram {
             for (double v : xs) Add(v);
         }
 
+        PercentileSketch::ThreadBuffer* PercentileSketch::LocalBuffer() {
+            if (t_bufferCacheTornDown) return nullptr;
+            ThreadBufferCache& cache = t_bufferCache;
+            if (cache.lastId == m_impl->m_id) return static_cast<ThreadBuffer*>(cache.last);
+
+            auto it = cache.all.find(m_impl->m_id);
+            if (it == cache.all.end()) {
+                cache.Sweep();
+                void* slot = nullptr;
+                {
+                    std::lock_guard lock(m_impl->m_registry->mutex);
+                    if (!m_impl->m_registry->orphaned.empty()) {
+                        // 复用已退出线程的缓冲：交接经由互斥锁同步，仍保持单生产者
+                        slot = m_impl->m_registry->orphaned.back();
+                        m_impl->m_registry->orphaned.pop_back();
+                    }
+                    else {
+                        auto buffer = std::make_unique<ThreadBuffer>();
+                        buffer->shard = m_impl->m_buffers.size() % m_shards; // 轮流分配到各分片
+                        slot = buffer.get();
+                        m_impl->m_buffers.push_back(std::move(buffer));
+                    }
+                }
+                it = cache.all.emplace(m_impl->m_id, ThreadBufferCache::Entry{ m_impl->m_registry, slot }).first;
+            }
+            cache.lastId = m_impl->m_id;
+            cache.last = it->second.buffer;
+            return static_cast<ThreadBuffer*>(cache.last);
+        }
+
+        void PercentileSketch::drainBuffer(ThreadBuffer& buffer, Shard& shard) const {
+            uint32_t tail = buffer.tail.load(std::memory_order_relaxed);
+            uint32_t head = buffer.head.load(std::memory_order_acquire);
+            if (tail == head) return;
+            for (; tail != head; ++tail) {
+                shard.centroids.push_back({ buffer.values[tail % ThreadBufferSize], 1 });
+                shard.totalCount++;
+            }
+            buffer.tail.store(head, std::memory_order_release);
+
+            if (shard.centroids.size() > m_compression * 4) {
+                compressCentroids(shard.centroids, m_compression);
+            }
+        }
+
+        void PercentileSketch::drainThreadBuffers() const {
+            if (!m_impl || m_impl->m_ingest != Ingest::ThreadLocal) return;
+            std::lock_guard buffersLock(m_impl->m_registry->mutex);
+            for (auto& buffer : m_impl->m_buffers) {
+                Shard& shard = *(m_impl->m_shardData[buffer->shard]);
+                std::unique_lock lock(shard.mtx); // 独占锁
+                drainBuffer(*buffer, shard);
+            }
+        }
+
+        PercentileSketch::Ingest PercentileSketch::GetIngest() const {
+            return m_impl->m_ingest;
+        }
+
         void PercentileSketch::flushShard(Shard& shard) {
             if (shard.buffer.empty()) return;
             std::sort(shard.buffer.begin(), shard.buffer.end());
@@ -119,6 +264,7 @@ namespace LikesProgram {
         }
 
         void PercentileSketch::Compress() {
+            drainThreadBuffers();
             for (auto& shard : m_impl->m_shardData) {
                 std::unique_lock lock(shard->mtx); // 独占锁
                 flushShard(*shard);
@@ -128,6 +274,7 @@ namespace LikesProgram {
 
         double PercentileSketch::Quantile(double q) const {
             if (q < 0.0 || q > 1.0) throw std::invalid_argument("Quantile q must be between 0 and 1");
+            drainThreadBuffers();
 
             // 收集所有分片
             std::vector<Centroid> merged;
@@ -154,8 +301,10 @@ namespace LikesProgram {
 
         void PercentileSketch::compressCentroids(std::vector<Centroid>& centroids, size_t compression) {
             if (centroids.empty()) return;
-            std::sort(centroids.begin(), centroids.end(),
-                [](auto& a, auto& b) { return a.mean < b.mean; });
+            auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+            if (!std::is_sorted(centroids.begin(), centroids.end(), byMean)) { // 已有序（如归并结果）时跳过排序
+                std::sort(centroids.begin(), centroids.end(), byMean);
+            }
 
             std::vector<Centroid> out;
             out.reserve(centroids.size());
@@ -184,17 +333,49 @@ namespace LikesProgram {
             centroids.swap(out);
         }
 
-        void PercentileSketch::Merge(const PercentileSketch& other) {
-            for (size_t i = 0; i < other.m_shards; ++i) {
-                const Shard& src = *other.m_impl->m_shardData[i];
-                std::shared_lock lock(src.mtx); // 共享锁
-                for (auto& c : src.centroids) {
-                    Add(c.mean); // 简化：逐点合并
-                }
+        int PercentileSketch::collectCentroids(std::vector<Centroid>& out) const {
+            drainThreadBuffers();
+            int totalCount = 0;
+            for (auto& shard : m_impl->m_shardData) {
+                std::shared_lock lock(shard->mtx); // 共享锁
+                out.insert(out.end(), shard->centroids.begin(), shard->centroids.end());
+                for (double v : shard->buffer) out.push_back({ v, 1 });
+                totalCount += shard->totalCount + static_cast<int>(shard->buffer.size());
             }
+            auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+            if (!std::is_sorted(out.begin(), out.end(), byMean)) std::sort(out.begin(), out.end(), byMean);
+            return totalCount;
+        }
+
+        void PercentileSketch::mergeSorted(std::vector<Centroid>& incoming, int incomingCount) {
+            if (incoming.empty()) return;
+            auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+
+            Shard& shard = *(m_impl->m_shardData[0]);
+            std::unique_lock lock(shard.mtx); // 独占锁
+            if (incomingCount > INT_MAX - shard.totalCount) throw std::overflow_error("PercentileSketch total count overflow");
+            if (!std::is_sorted(shard.centroids.begin(), shard.centroids.end(), byMean)) {
+                std::sort(shard.centroids.begin(), shard.centroids.end(), byMean);
+            }
+
+            std::vector<Centroid> merged(shard.centroids.size() + incoming.size());
+            std::merge(shard.centroids.begin(), shard.centroids.end(), incoming.begin(), incoming.end(), merged.begin(), byMean);
+            shard.centroids.swap(merged);
+            shard.totalCount += incomingCount;
+
+            if (shard.centroids.size() > m_compression * 4) {
+                compressCentroids(shard.centroids, m_compression);
+            }
+        }
+
+        void PercentileSketch::Merge(const PercentileSketch& other) {
+            std::vector<Centroid> incoming;
+            int incomingCount = other.collectCentroids(incoming); // 先收集再加锁本实例，允许与自身合并
+            mergeSorted(incoming, incomingCount);
         }
 
         void PercentileSketch::Serialize(std::ostream& os) const {
+            drainThreadBuffers();
             uint64_t magic = 0x5444494745534B; // "TDIGESK"
             os.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
             os.write(reinterpret_cast<const char*>(&m_compression), sizeof(m_compression));
@@ -236,7 +417,117 @@ namespace LikesProgram {
             return sketch;
         }
 
+        namespace {
+            // 紧凑格式：'L' 'P' 'T' 'D' | 版本(1 字节) | varint compression | varint 质心数 | 每个质心：varint 均值键差分、varint 计数
+            constexpr uint8_t CompactMagic[4] = { 'L', 'P', 'T', 'D' };
+            constexpr uint8_t CompactVersion = 1;
+
+            // double 映射为保序的 uint64（有序均值的键单调不减，差分非负）
+            uint64_t OrderedKey(double value) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+            }
+
+            double FromOrderedKey(uint64_t key) {
+                uint64_t bits = (key & 0x8000000000000000ULL) ? (key & ~0x8000000000000000ULL) : ~key;
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+                while (value >= 0x80) {
+                    out.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                out.push_back(static_cast<uint8_t>(value));
+            }
+
+            uint64_t GetVarint(std::span<const uint8_t> data, size_t& pos) {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    if (pos >= data.size()) throw std::runtime_error("Invalid sketch format: truncated varint");
+                    uint8_t byte = data[pos++];
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) return value;
+                }
+                throw std::runtime_error("Invalid sketch format: varint too long");
+            }
+        }
+
+        void PercentileSketch::SerializeTo(std::vector<uint8_t>& out) const {
+            std::vector<Centroid> centroids;
+            collectCentroids(centroids);
+            compressCentroids(centroids, m_compression);
+
+            out.insert(out.end(), std::begin(CompactMagic), std::end(CompactMagic));
+            out.push_back(CompactVersion);
+            PutVarint(out, m_compression);
+            PutVarint(out, centroids.size());
+            uint64_t previous = 0;
+            for (const auto& c : centroids) {
+                uint64_t key = OrderedKey(c.mean);
+                PutVarint(out, key - previous);
+                PutVarint(out, static_cast<uint64_t>(c.count));
+                previous = key;
+            }
+        }
+
+        void PercentileSketch::decodeCentroids(std::span<const uint8_t> data, size_t& compression, std::vector<Centroid>& out, int& totalCount) {
+            if (data.size() < sizeof(CompactMagic) + 1 || !std::equal(std::begin(CompactMagic), std::end(CompactMagic), data.begin())) {
+                throw std::runtime_error("Invalid sketch format");
+            }
+            if (data[4] != CompactVersion) throw std::runtime_error("Unsupported sketch format version");
+
+            size_t pos = sizeof(CompactMagic) + 1;
+            compression = static_cast<size_t>(GetVarint(data, pos));
+            if (compression == 0) throw std::runtime_error("Invalid sketch format: compression");
+            uint64_t n = GetVarint(data, pos);
+            if (n > data.size() - pos) throw std::runtime_error("Invalid sketch format: centroid count"); // 每个质心至少 2 字节
+
+            out.reserve(out.size() + n);
+            int64_t total = 0;
+            uint64_t key = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                uint64_t delta = GetVarint(data, pos);
+                if (delta > UINT64_MAX - key) throw std::runtime_error("Invalid sketch format: mean overflow");
+                key += delta;
+                double mean = FromOrderedKey(key);
+                if (std::isnan(mean)) throw std::runtime_error("Invalid sketch format: mean is NaN");
+
+                uint64_t count = GetVarint(data, pos);
+                if (count == 0 || count > static_cast<uint64_t>(INT_MAX)) throw std::runtime_error("Invalid sketch format: centroid weight");
+                total += static_cast<int64_t>(count);
+                if (total > INT_MAX) throw std::runtime_error("Invalid sketch format: total count overflow");
+                out.push_back({ mean, static_cast<int>(count) });
+            }
+            totalCount = static_cast<int>(total);
+        }
+
+        PercentileSketch PercentileSketch::Deserialize(std::span<const uint8_t> data) {
+            size_t compression = 0;
+            std::vector<Centroid> centroids;
+            int totalCount = 0;
+            decodeCentroids(data, compression, centroids, totalCount);
+
+            PercentileSketch sketch(compression);
+            Shard& shard = *(sketch.m_impl->m_shardData[0]);
+            shard.centroids = std::move(centroids);
+            shard.totalCount = totalCount;
+            return sketch;
+        }
+
+        void PercentileSketch::MergeSerialized(std::span<const uint8_t> data) {
+            size_t compression = 0;
+            std::vector<Centroid> incoming;
+            int totalCount = 0;
+            decodeCentroids(data, compression, incoming, totalCount);
+            mergeSorted(incoming, totalCount);
+        }
+
         std::vector<std::pair<double, int>> PercentileSketch::GetCentroids() const {
+            drainThreadBuffers();
             std::vector<std::pair<double, int>> res;
             for (auto& shard : m_impl->m_shardData) {
                 std::shared_lock lock(shard->mtx); // 共享锁
@@ -248,6 +539,7 @@ namespace LikesProgram {
         }
 
         void PercentileSketch::Reset() {
+            drainThreadBuffers(); // 丢弃线程缓冲中尚未合并的值
             for (auto& shardPtr : m_impl->m_shardData) {
                 std::unique_lock lock(shardPtr->mtx);
                 shardPtr->buffer.clear();
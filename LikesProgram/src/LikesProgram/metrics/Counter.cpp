@@ -1,27 +1,25 @@
 ﻿#include "../../../include/LikesProgram/metrics/Counter.hpp"
-#include <atomic>
+#include "../../../include/LikesProgram/metrics/StripedValue.hpp"
 
 namespace LikesProgram {
 	namespace Metrics {
 		struct Counter::CounterImpl {
-			std::atomic<double> m_value{ 0.0 };
+			StripedValue m_value;
 		};
 
 		Counter::Counter(const LikesProgram::String& name, const LikesProgram::String& help,
-			const std::map<LikesProgram::String, LikesProgram::String>& labels)
-		: MetricsObject(name, help, labels), m_impl(new CounterImpl{}) { }
-		Counter::Counter(const Counter& other) : MetricsObject(other), m_impl(other.m_impl ? new CounterImpl{} : nullptr) {
+			const std::map<LikesProgram::String, LikesProgram::String>& labels, Storage storage)
+		: MetricsObject(name, help, labels), m_impl(new CounterImpl{ StripedValue(storage) }) { }
+		Counter::Counter(const Counter& other) : MetricsObject(other), m_impl(other.m_impl ? new CounterImpl{ StripedValue(other.m_impl->m_value.GetStorage()) } : nullptr) {
 			if (other.m_impl)
-			m_impl->m_value.store(other.m_impl->m_value.load(std::memory_order_relaxed),
-				std::memory_order_relaxed);
+			m_impl->m_value.Set(other.m_impl->m_value.Sum());
 		}
 		Counter& Counter::operator=(const Counter& other) {
 			if (this != &other) {
 				MetricsObject::operator=(other);
 				if (other.m_impl) {
-					if (!m_impl) m_impl = new CounterImpl{};
-					m_impl->m_value.store(other.m_impl->m_value.load(std::memory_order_relaxed),
-						std::memory_order_relaxed);
+					if (!m_impl) m_impl = new CounterImpl{ StripedValue(other.m_impl->m_value.GetStorage()) };
+					m_impl->m_value.Set(other.m_impl->m_value.Sum());
 				}
 				else {
 					delete m_impl;
@@ -47,16 +45,28 @@ namespace LikesProgram {
 			m_impl = nullptr;
 		}
 
+		void Counter::Increment() {
+			m_impl->m_value.Add(int64_t{ 1 });
+		}
+
 		void Counter::Increment(double value) {
-			m_impl->m_value.fetch_add(value, std::memory_order_relaxed);
+			m_impl->m_value.Add(value);
+		}
+
+		void Counter::IncrementInteger(int64_t value) {
+			m_impl->m_value.Add(value);
 		}
 
 		double Counter::Value() const {
-			return m_impl->m_value.load(std::memory_order_relaxed);
+			return m_impl->m_value.Sum();
+		}
+
+		Storage Counter::GetStorage() const {
+			return m_impl->m_value.GetStorage();
 		}
 
 		void Counter::Reset() {
-            m_impl->m_value.store(0.0, std::memory_order_relaxed);
+            m_impl->m_value.Set(0.0);
 		}
 
 		LikesProgram::String Counter::Name() const {
@@ -93,12 +103,17 @@ namespace LikesProgram {
 			}
 
 			result.Append(u" ");
-			String value = LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.load(std::memory_order_relaxed));
+			String value = LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.Sum());
 			result.Append(value);
 			result.Append(u"\n");
 			return result;
 		}
 
+		void Counter::Collect(MetricData& data) const {
+			data.kind = MetricData::Kind::Counter;
+			data.value = m_impl->m_value.Sum();
+		}
+
 		LikesProgram::String Counter::ToJson() const {
 			LikesProgram::String json = u"{";
 			json.Append(u"\"name\":\"").Append(LikesProgram::String::EscapeJson(m_name)).Append(u"\",");
@@ -116,7 +131,7 @@ namespace LikesProgram {
 			json.Append(u"},");
 
 			json.Append(u"\"value\":");
-			json.Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.load(std::memory_order_relaxed)));
+			json.Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.Sum()));
 			json.Append(u"}");
 
 			return json;
@@ -0,0 +1,428 @@
+﻿#include "../../../include/LikesProgram/metrics/Exporter.hpp"
+#include "../../../include/LikesProgram/metrics/LocalHandle.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace LikesProgram {
+	namespace Metrics {
+        namespace {
+            constexpr size_t ChunkSize = 64 * 1024;
+
+            void AppendAscii(std::u8string& out, std::string_view text) {
+                out.append(reinterpret_cast<const char8_t*>(text.data()), text.size());
+            }
+
+            void AppendInteger(std::u8string& out, int64_t value) {
+                char buffer[24];
+                auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                AppendAscii(out, std::string_view(buffer, result.ptr - buffer));
+            }
+
+            // 最短可往返表示，特殊值按 Prometheus 约定输出
+            void AppendDouble(std::u8string& out, double value) {
+                if (std::isnan(value)) return AppendAscii(out, "NaN");
+                if (std::isinf(value)) return AppendAscii(out, value > 0 ? "+Inf" : "-Inf");
+                char buffer[32];
+                auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                AppendAscii(out, std::string_view(buffer, result.ptr - buffer));
+            }
+
+            // 追加 UTF-8 文本并转义：标签值转义 \ " 换行，HELP 只转义 \ 与换行
+            void AppendEscaped(std::u8string& out, const LikesProgram::String& text, bool quote) {
+                size_t start = out.size();
+                text.AppendTo(out);
+                std::u8string_view special = quote ? u8"\\\"\n" : u8"\\\n";
+                if (out.find_first_of(special, start) == std::u8string::npos) return;
+
+                std::u8string raw = out.substr(start);
+                out.resize(start);
+                for (char8_t c : raw) {
+                    if (c == u8'\\') out.append(u8"\\\\");
+                    else if (c == u8'\n') out.append(u8"\\n");
+                    else if (c == u8'"' && quote) out.append(u8"\\\"");
+                    else out.push_back(c);
+                }
+            }
+
+            // --- protobuf 编码 ---
+            void PutVarint(std::u8string& out, uint64_t value) {
+                while (value >= 0x80) {
+                    out.push_back(static_cast<char8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                out.push_back(static_cast<char8_t>(value));
+            }
+
+            void PutTag(std::u8string& out, uint32_t field, uint32_t wireType) {
+                PutVarint(out, (static_cast<uint64_t>(field) << 3) | wireType);
+            }
+
+            void PutUint64(std::u8string& out, uint32_t field, uint64_t value) {
+                PutTag(out, field, 0);
+                PutVarint(out, value);
+            }
+
+            void PutDouble(std::u8string& out, uint32_t field, double value) {
+                PutTag(out, field, 1);
+                uint64_t bits = std::bit_cast<uint64_t>(value);
+                for (int i = 0; i < 8; ++i) out.push_back(static_cast<char8_t>(bits >> (i * 8))); // 小端
+            }
+
+            void PutBytes(std::u8string& out, uint32_t field, const std::u8string& bytes) {
+                PutTag(out, field, 2);
+                PutVarint(out, bytes.size());
+                out.append(bytes);
+            }
+
+            bool WriteAll(int fd, const char8_t* data, size_t size) {
+                while (size > 0) {
+#ifdef _WIN32
+                    int written = _write(fd, data, static_cast<unsigned int>(std::min<size_t>(size, 1u << 30)));
+                    if (written <= 0) return false;
+#else
+                    ssize_t written = ::write(fd, data, size);
+                    if (written < 0 && errno == EINTR) continue;
+                    if (written <= 0) return false;
+#endif
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                }
+                return true;
+            }
+        }
+
+        struct Exporter::ExporterImpl {
+            Format m_format;
+
+            // 复用的缓冲，多次导出之间保留容量
+            std::u8string m_chunk;
+            std::u8string m_family;
+            std::u8string m_metric;
+            std::u8string m_inner;
+            std::u8string m_item;
+            std::u8string m_text;
+            MetricData m_data;
+            std::vector<std::shared_ptr<MetricsObject>> m_metrics;
+            std::vector<std::pair<size_t, size_t>> m_order;           // (同名指标中第一个的下标, 下标)
+            std::unordered_multimap<size_t, size_t> m_firstByHash;  // 名称哈希 → 该名称第一次出现的下标
+
+            using FlushFn = std::function<bool(std::u8string&)>;
+
+            // 遍历快照并写入 out；flush 不为空时每写满一块调用一次（由其清空 out）
+            bool Write(Registry& registry, std::u8string& out, const FlushFn& flush) {
+                LocalHandle::FlushAll(); // 先合并线程本地句柄中的更新
+                m_metrics = registry.Snapshot();
+                GroupByName();
+
+                bool ok = true;
+                for (size_t begin = 0; begin < m_order.size() && ok;) {
+                    size_t end = begin + 1;
+                    while (end < m_order.size() && m_order[end].first == m_order[begin].first) ++end;
+
+                    if (m_format == Format::Protobuf) WriteProtobufFamily(out, begin, end);
+                    else WriteTextFamily(out, begin, end);
+
+                    if (flush && out.size() >= ChunkSize) ok = flush(out);
+                    begin = end;
+                }
+                if (ok && m_format == Format::OpenMetrics) out.append(u8"# EOF\n");
+                if (ok && flush && !out.empty()) ok = flush(out);
+                m_metrics.clear(); // 释放对指标的引用
+                return ok;
+            }
+
+            // 同名指标归为一组，组按首次出现的顺序排列（按哈希分组，避免逐码点比较名称排序）
+            void GroupByName() {
+                m_order.clear();
+                m_firstByHash.clear();
+                for (size_t i = 0; i < m_metrics.size(); ++i) {
+                    const LikesProgram::String& name = m_metrics[i]->NameRef();
+                    size_t hash = std::hash<LikesProgram::String>{}(name);
+                    size_t group = i;
+                    auto [it, last] = m_firstByHash.equal_range(hash);
+                    for (; it != last; ++it) {
+                        if (m_metrics[it->second]->NameRef() == name) {
+                            group = it->second;
+                            break;
+                        }
+                    }
+                    if (group == i) m_firstByHash.emplace(hash, i);
+                    m_order.emplace_back(group, i);
+                }
+                std::sort(m_order.begin(), m_order.end());
+            }
+
+            const MetricsObject& At(size_t position) const {
+                return *m_metrics[m_order[position].second];
+            }
+
+            // --- 文本格式 ---
+            static const char* TypeName(MetricData::Kind kind) {
+                switch (kind) {
+                case MetricData::Kind::Counter: return "counter";
+                case MetricData::Kind::Gauge: return "gauge";
+                case MetricData::Kind::Histogram: return "histogram";
+                case MetricData::Kind::Summary: return "summary";
+                default: return "untyped";
+                }
+            }
+
+            // 样本行：name + suffix + {labels, extraName="extraValue"} + 值
+            void AppendLabels(std::u8string& out, const MetricsObject& metric, std::string_view extraName, double extraValue) {
+                const auto& labels = metric.LabelsRef();
+                if (labels.empty() && extraName.empty()) return;
+                out.push_back(u8'{');
+                bool first = true;
+                for (const auto& [key, value] : labels) {
+                    if (!first) out.push_back(u8',');
+                    key.AppendTo(out);
+                    out.append(u8"=\"");
+                    AppendEscaped(out, value, true);
+                    out.push_back(u8'"');
+                    first = false;
+                }
+                if (!extraName.empty()) {
+                    if (!first) out.push_back(u8',');
+                    AppendAscii(out, extraName);
+                    out.append(u8"=\"");
+                    AppendDouble(out, extraValue);
+                    out.push_back(u8'"');
+                }
+                out.push_back(u8'}');
+            }
+
+            void AppendSampleName(std::u8string& out, const std::u8string& name, std::string_view suffix) {
+                out.append(name);
+                AppendAscii(out, suffix);
+            }
+
+            void WriteTextFamily(std::u8string& out, size_t begin, size_t end) {
+                const MetricsObject& head = At(begin);
+                m_data.Clear();
+                head.Collect(m_data);
+                MetricData::Kind kind = m_data.kind;
+
+                // 未提供结构化数据的指标回退到其自身的文本输出
+                if (kind == MetricData::Kind::Unknown) {
+                    for (size_t i = begin; i < end; ++i) At(i).ToPrometheus().AppendTo(out);
+                    return;
+                }
+
+                // OpenMetrics 中计数器的指标族名不带 _total，样本名带 _total
+                m_text.clear();
+                head.NameRef().AppendTo(m_text);
+                bool openMetrics = m_format == Format::OpenMetrics;
+                std::string_view counterSuffix;
+                if (openMetrics && kind == MetricData::Kind::Counter) {
+                    std::u8string_view total = u8"_total";
+                    if (m_text.size() > total.size() && m_text.compare(m_text.size() - total.size(), total.size(), total) == 0) {
+                        m_text.resize(m_text.size() - total.size());
+                    }
+                    counterSuffix = "_total";
+                }
+
+                out.append(u8"# HELP ").append(m_text).push_back(u8' ');
+                AppendEscaped(out, head.HelpRef(), false);
+                out.append(u8"\n# TYPE ").append(m_text).push_back(u8' ');
+                AppendAscii(out, TypeName(kind));
+                out.push_back(u8'\n');
+
+                for (size_t i = begin; i < end; ++i) {
+                    const MetricsObject& metric = At(i);
+                    if (i != begin) {
+                        m_data.Clear();
+                        metric.Collect(m_data);
+                    }
+                    switch (m_data.kind) {
+                    case MetricData::Kind::Counter:
+                    case MetricData::Kind::Gauge:
+                        AppendSampleName(out, m_text, counterSuffix);
+                        AppendLabels(out, metric, {}, 0.0);
+                        out.push_back(u8' ');
+                        AppendDouble(out, m_data.value);
+                        out.push_back(u8'\n');
+                        break;
+                    case MetricData::Kind::Histogram:
+                        for (size_t b = 0; b <= m_data.bounds.size(); ++b) {
+                            bool inf = b == m_data.bounds.size();
+                            AppendSampleName(out, m_text, "_bucket");
+                            AppendLabels(out, metric, "le", inf ? HUGE_VAL : m_data.bounds[b]);
+                            out.push_back(u8' ');
+                            AppendInteger(out, inf ? m_data.count : m_data.counts[b]);
+                            out.push_back(u8'\n');
+                        }
+                        WriteSumCount(out, metric);
+                        break;
+                    case MetricData::Kind::Summary:
+                        for (size_t q = 0; q < m_data.quantiles.size(); ++q) {
+                            AppendSampleName(out, m_text, "");
+                            AppendLabels(out, metric, "quantile", m_data.quantiles[q]);
+                            out.push_back(u8' ');
+                            AppendDouble(out, m_data.quantileValues[q]);
+                            out.push_back(u8'\n');
+                        }
+                        WriteSumCount(out, metric);
+                        break;
+                    default:
+                        metric.ToPrometheus().AppendTo(out);
+                        break;
+                    }
+                }
+            }
+
+            void WriteSumCount(std::u8string& out, const MetricsObject& metric) {
+                AppendSampleName(out, m_text, "_sum");
+                AppendLabels(out, metric, {}, 0.0);
+                out.push_back(u8' ');
+                AppendDouble(out, m_data.sum);
+                out.push_back(u8'\n');
+                AppendSampleName(out, m_text, "_count");
+                AppendLabels(out, metric, {}, 0.0);
+                out.push_back(u8' ');
+                AppendInteger(out, m_data.count);
+                out.push_back(u8'\n');
+            }
+
+            // --- protobuf ---
+            void PutString(std::u8string& out, uint32_t field, const LikesProgram::String& text) {
+                m_text.clear();
+                text.AppendTo(m_text);
+                PutBytes(out, field, m_text);
+            }
+
+            void WriteProtobufFamily(std::u8string& out, size_t begin, size_t end) {
+                const MetricsObject& head = At(begin);
+                m_data.Clear();
+                head.Collect(m_data);
+                if (m_data.kind == MetricData::Kind::Unknown) return; // 无结构化数据，无法编码
+
+                // MetricType：COUNTER=0, GAUGE=1, SUMMARY=2, UNTYPED=3, HISTOGRAM=4
+                uint64_t type = 3;
+                switch (m_data.kind) {
+                case MetricData::Kind::Counter: type = 0; break;
+                case MetricData::Kind::Gauge: type = 1; break;
+                case MetricData::Kind::Summary: type = 2; break;
+                case MetricData::Kind::Histogram: type = 4; break;
+                default: break;
+                }
+
+                m_family.clear();
+                PutString(m_family, 1, head.NameRef());
+                if (!head.HelpRef().Empty()) PutString(m_family, 2, head.HelpRef());
+                PutUint64(m_family, 3, type);
+
+                for (size_t i = begin; i < end; ++i) {
+                    const MetricsObject& metric = At(i);
+                    if (i != begin) {
+                        m_data.Clear();
+                        metric.Collect(m_data);
+                    }
+
+                    m_metric.clear();
+                    for (const auto& [key, value] : metric.LabelsRef()) {
+                        m_item.clear();
+                        PutString(m_item, 1, key);
+                        PutString(m_item, 2, value);
+                        PutBytes(m_metric, 1, m_item);
+                    }
+
+                    m_inner.clear();
+                    switch (m_data.kind) {
+                    case MetricData::Kind::Counter:
+                        PutDouble(m_inner, 1, m_data.value);
+                        PutBytes(m_metric, 3, m_inner);
+                        break;
+                    case MetricData::Kind::Gauge:
+                        PutDouble(m_inner, 1, m_data.value);
+                        PutBytes(m_metric, 2, m_inner);
+                        break;
+                    case MetricData::Kind::Summary:
+                        PutUint64(m_inner, 1, static_cast<uint64_t>(m_data.count));
+                        PutDouble(m_inner, 2, m_data.sum);
+                        for (size_t q = 0; q < m_data.quantiles.size(); ++q) {
+                            m_item.clear();
+                            PutDouble(m_item, 1, m_data.quantiles[q]);
+                            PutDouble(m_item, 2, m_data.quantileValues[q]);
+                            PutBytes(m_inner, 3, m_item);
+                        }
+                        PutBytes(m_metric, 4, m_inner);
+                        break;
+                    case MetricData::Kind::Histogram:
+                        PutUint64(m_inner, 1, static_cast<uint64_t>(m_data.count));
+                        PutDouble(m_inner, 2, m_data.sum);
+                        for (size_t b = 0; b < m_data.bounds.size(); ++b) {
+                            m_item.clear();
+                            PutUint64(m_item, 1, static_cast<uint64_t>(m_data.counts[b]));
+                            PutDouble(m_item, 2, m_data.bounds[b]);
+                            PutBytes(m_inner, 3, m_item);
+                        }
+                        PutBytes(m_metric, 7, m_inner);
+                        break;
+                    default:
+                        continue; // 同名但无结构化数据的指标跳过
+                    }
+                    PutBytes(m_family, 4, m_metric);
+                }
+
+                PutVarint(out, m_family.size());
+                out.append(m_family);
+            }
+        };
+
+        Exporter::Exporter(Format format) : m_impl(new ExporterImpl{}) {
+            m_impl->m_format = format;
+        }
+
+        Exporter::~Exporter() {
+            if (m_impl) delete m_impl;
+            m_impl = nullptr;
+        }
+
+        Exporter::Format Exporter::GetFormat() const {
+            return m_impl->m_format;
+        }
+
+        const char* Exporter::ContentType() const {
+            switch (m_impl->m_format) {
+            case Format::OpenMetrics: return "application/openmetrics-text; version=1.0.0; charset=utf-8";
+            case Format::Protobuf: return "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited";
+            default: return "text/plain; version=0.0.4; charset=utf-8";
+            }
+        }
+
+        void Exporter::Export(Registry& registry, std::u8string& out) {
+            m_impl->Write(registry, out, nullptr);
+        }
+
+        void Exporter::Export(Registry& registry, Net::Buffer& out) {
+            m_impl->m_chunk.clear();
+            m_impl->Write(registry, m_impl->m_chunk, [&out](std::u8string& chunk) {
+                out.Append(chunk.data(), chunk.size());
+                chunk.clear();
+                return true;
+            });
+        }
+
+        bool Exporter::Export(Registry& registry, int fd) {
+            m_impl->m_chunk.clear();
+            return m_impl->Write(registry, m_impl->m_chunk, [fd](std::u8string& chunk) {
+                bool ok = WriteAll(fd, chunk.data(), chunk.size());
+                chunk.clear();
+                return ok;
+            });
+        }
+	}
+}
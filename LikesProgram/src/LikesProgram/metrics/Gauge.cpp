@@ -1,26 +1,26 @@
 ﻿#include "../../../include/LikesProgram/metrics/Gauge.hpp"
-#include <atomic>
+#include "../../../include/LikesProgram/metrics/StripedValue.hpp"
 
 namespace LikesProgram {
 	namespace Metrics {
         struct Gauge::GaugeImpl {
-            std::atomic<double> m_value{ 0.0 };
+            StripedValue m_value;
         };
 
 		Gauge::Gauge(const LikesProgram::String& name, const LikesProgram::String& help,
-			const std::map<LikesProgram::String, LikesProgram::String>& labels)
-        : MetricsObject(name, help, labels), m_impl(new GaugeImpl{}) { }
-        Gauge::Gauge(const Gauge& other) : MetricsObject(other), m_impl(other.m_impl ? new GaugeImpl{} : nullptr) {
+			const std::map<LikesProgram::String, LikesProgram::String>& labels, Storage storage)
+        : MetricsObject(name, help, labels), m_impl(new GaugeImpl{ StripedValue(storage) }) { }
+        Gauge::Gauge(const Gauge& other) : MetricsObject(other), m_impl(other.m_impl ? new GaugeImpl{ StripedValue(other.m_impl->m_value.GetStorage()) } : nullptr) {
             if (other.m_impl) {
-                m_impl->m_value.store(other.m_impl->m_value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                m_impl->m_value.Set(other.m_impl->m_value.Sum());
             }
         }
         Gauge& Gauge::operator=(const Gauge& other) {
             if (this != &other) {
                 MetricsObject::operator=(other);
                 if (other.m_impl) {
-                    if (!m_impl) m_impl = new GaugeImpl{};
-                    m_impl->m_value.store(other.m_impl->m_value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    if (!m_impl) m_impl = new GaugeImpl{ StripedValue(other.m_impl->m_value.GetStorage()) };
+                    m_impl->m_value.Set(other.m_impl->m_value.Sum());
                 }
                 else {
                     delete m_impl;
@@ -47,23 +47,39 @@ namespace LikesProgram {
         }
 
 		void Gauge::Set(double value) {
-            m_impl->m_value.store(value, std::memory_order_relaxed);
+            m_impl->m_value.Set(value);
+		}
+
+		void Gauge::Increment() {
+            m_impl->m_value.Add(int64_t{ 1 });
 		}
 
 		void Gauge::Increment(double value) {
-            m_impl->m_value.fetch_add(value, std::memory_order_relaxed);
+            m_impl->m_value.Add(value);
+		}
+
+		void Gauge::Decrement() {
+            m_impl->m_value.Add(int64_t{ -1 });
 		}
 
 		void Gauge::Decrement(double value) {
-            m_impl->m_value.fetch_sub(value, std::memory_order_relaxed);
+            m_impl->m_value.Add(-value);
 		}
 
+        void Gauge::IncrementInteger(int64_t value) {
+            m_impl->m_value.Add(value);
+        }
+
         double Gauge::Value() const {
-			return m_impl->m_value.load(std::memory_order_relaxed);
+			return m_impl->m_value.Sum();
 		}
 
+        Storage Gauge::GetStorage() const {
+            return m_impl->m_value.GetStorage();
+        }
+
         void Gauge::Reset() {
-            m_impl->m_value.store(0.0, std::memory_order_relaxed);
+            m_impl->m_value.Set(0.0);
         }
 
 		LikesProgram::String Gauge::Name() const {
@@ -100,12 +116,17 @@ namespace LikesProgram {
                 result.Append(u"}");
             }
 
-            result.Append(u" ").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.load(std::memory_order_relaxed)));
+            result.Append(u" ").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.Sum()));
             result.Append(u"\n");
 
             return result;
         }
 
+        void Gauge::Collect(MetricData& data) const {
+            data.kind = MetricData::Kind::Gauge;
+            data.value = m_impl->m_value.Sum();
+        }
+
         LikesProgram::String Gauge::ToJson() const {
             LikesProgram::String json;
             json.Append(u"{");
@@ -125,7 +146,7 @@ namespace LikesProgram {
             json.Append(u"},");
 
             // 只保留原始值
-            json.Append(u" ").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.load(std::memory_order_relaxed)));
+            json.Append(u" ").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_value.Sum()));
             json.Append(u"}");
             return json;
         }
@@ -1,59 +1,171 @@
 ﻿#include "../../../include/LikesProgram/metrics/Histogram.hpp"
 #include "../../../include/LikesProgram/math/Math.hpp"
 #include "../../../include/LikesProgram/time/Time.hpp"
+#include "../../../include/LikesProgram/metrics/StripedValue.hpp"
 #include <algorithm>
-#include <sstream>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
 
 namespace LikesProgram {
 	namespace Metrics {
+        namespace {
+            // 计数按缓存行分配，各分片的计数互不共享缓存行
+            constexpr size_t CountsPerLine = 8;
+            struct alignas(64) CountLine {
+                std::atomic<int64_t> counts[CountsPerLine];
+            };
+            struct alignas(64) ShardSum {
+                std::atomic<double> sum{ 0.0 }; // 秒累积
+            };
+        }
+
         struct Histogram::HistogramImpl {
-            std::vector<double> m_buckets;
-            std::vector<std::unique_ptr<std::atomic<int64_t>>> m_counts;
-            std::atomic<int64_t> m_count{ 0 };
-            std::atomic<double> m_sum{ 0 }; // 秒累积
-        };
+            BucketLayout m_layout;
+            double m_invLogFactor = 0.0;  // Exponential：1 / ln(factor)
+            Storage m_storage = Storage::Single;
+            size_t m_shardCount = 1;
+            size_t m_linesPerShard = 1;   // 每个分片 bounds.size() + 1 个计数（最后一个为 +Inf 桶）
+            std::unique_ptr<CountLine[]> m_lines;
+            std::unique_ptr<ShardSum[]> m_sums;
+
+            void Init(const BucketLayout& layout, Storage storage) {
+                m_layout = layout;
+                std::sort(m_layout.bounds.begin(), m_layout.bounds.end());
+                if (m_layout.kind == BucketLayout::Kind::Exponential) m_invLogFactor = 1.0 / std::log(m_layout.step);
+
+                m_storage = storage;
+                m_shardCount = StripeCount(storage);
+                m_linesPerShard = (m_layout.bounds.size() + 1 + CountsPerLine - 1) / CountsPerLine;
+                m_lines = std::make_unique<CountLine[]>(m_shardCount * m_linesPerShard);
+                m_sums = std::make_unique<ShardSum[]>(m_shardCount);
+            }
 
-        Histogram::Histogram(const LikesProgram::String& name, const std::vector<double>& buckets,
-            const LikesProgram::String& help,
-            const std::map<LikesProgram::String, LikesProgram::String>& labels)
-            : MetricsObject(name, help, labels), m_impl(new HistogramImpl{}) {
+            std::atomic<int64_t>& Slot(size_t shard, size_t bucket) const noexcept {
+                return m_lines[shard * m_linesPerShard + bucket / CountsPerLine].counts[bucket % CountsPerLine];
+            }
 
-            m_impl->m_buckets = std::vector<double>(buckets.begin(), buckets.end());
-            std::sort(m_impl->m_buckets.begin(), m_impl->m_buckets.end());
+            // 汇总所有分片中某个桶的计数（非累计）
+            int64_t Load(size_t bucket) const noexcept {
+                int64_t total = 0;
+                for (size_t shard = 0; shard < m_shardCount; ++shard) total += Slot(shard, bucket).load(std::memory_order_relaxed);
+                return total;
+            }
 
-            m_impl->m_counts.reserve(m_impl->m_buckets.size());
-            for (size_t i = 0; i < m_impl->m_buckets.size(); ++i) {
-                m_impl->m_counts.emplace_back(std::make_unique<std::atomic<int64_t>>(0));
+            double LoadSum() const noexcept {
+                double total = 0.0;
+                for (size_t shard = 0; shard < m_shardCount; ++shard) total += m_sums[shard].sum.load(std::memory_order_relaxed);
+                return total;
             }
-        }
-        Histogram::Histogram(const Histogram& other) : MetricsObject(other), m_impl(other.m_impl ? new HistogramImpl{} : nullptr) {
-            if (other.m_impl) {
-                m_impl->m_buckets = other.m_impl->m_buckets;
 
-                m_impl->m_counts.reserve(other.m_impl->m_counts.size());
-                for (const auto& cptr : other.m_impl->m_counts) {
-                    m_impl->m_counts.emplace_back(std::make_unique<std::atomic<int64_t>>(cptr->load(std::memory_order_relaxed)));
+            // 第一个上界不小于 value 的桶下标，超出所有上界（或 NaN）返回 bounds.size()
+            size_t BucketIndex(double value) const noexcept {
+                const std::vector<double>& bounds = m_layout.bounds;
+                size_t n = bounds.size();
+                if (n == 0 || std::isnan(value) || value > bounds[n - 1]) return n;
+                if (value <= bounds[0]) return 0;
+
+                size_t index = 0;
+                switch (m_layout.kind) {
+                case BucketLayout::Kind::Linear:
+                    index = static_cast<size_t>(std::ceil((value - m_layout.start) / m_layout.step));
+                    break;
+                case BucketLayout::Kind::Exponential:
+                    index = static_cast<size_t>(std::ceil(std::log(value / m_layout.start) * m_invLogFactor));
+                    break;
+                case BucketLayout::Kind::LogLinear: {
+                    // value / start = m * 2^exp，m ∈ [0.5, 1)，落在第 exp - 1 个 2 倍区间
+                    int exp = 0;
+                    double m = std::frexp(value / m_layout.start, &exp);
+                    size_t sub = static_cast<size_t>(std::ceil((m * 2.0 - 1.0) * static_cast<double>(m_layout.subBuckets)));
+                    index = static_cast<size_t>(exp - 1) * m_layout.subBuckets + sub;
+                    break;
+                }
+                default:
+                    return static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
                 }
 
-                m_impl->m_count.store(other.m_impl->m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
-                m_impl->m_sum.store(other.m_impl->m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                // 修正浮点误差，保证与 bounds 中的上界一致
+                if (index >= n) index = n - 1;
+                while (index > 0 && value <= bounds[index - 1]) --index;
+                while (value > bounds[index]) ++index;
+                return index;
             }
+
+            // 从另一个实例拷贝布局与数据（数据汇总到第 0 个分片）
+            void CopyFrom(const HistogramImpl& other) {
+                Init(other.m_layout, other.m_storage);
+                for (size_t bucket = 0; bucket <= m_layout.bounds.size(); ++bucket) {
+                    Slot(0, bucket).store(other.Load(bucket), std::memory_order_relaxed);
+                }
+                m_sums[0].sum.store(other.LoadSum(), std::memory_order_relaxed);
+            }
+        };
+
+        Histogram::BucketLayout Histogram::Linear(double start, double width, size_t count) {
+            if (!(width > 0.0) || count == 0) throw std::invalid_argument("Histogram::Linear: width must be positive and count non-zero");
+            BucketLayout layout;
+            layout.kind = BucketLayout::Kind::Linear;
+            layout.start = start;
+            layout.step = width;
+            layout.bounds.reserve(count);
+            for (size_t i = 0; i < count; ++i) layout.bounds.push_back(start + width * static_cast<double>(i));
+            return layout;
+        }
+
+        Histogram::BucketLayout Histogram::Exponential(double start, double factor, size_t count) {
+            if (!(start > 0.0) || !(factor > 1.0) || count == 0) throw std::invalid_argument("Histogram::Exponential: start must be positive, factor greater than 1 and count non-zero");
+            BucketLayout layout;
+            layout.kind = BucketLayout::Kind::Exponential;
+            layout.start = start;
+            layout.step = factor;
+            layout.bounds.reserve(count);
+            double bound = start;
+            for (size_t i = 0; i < count; ++i, bound *= factor) layout.bounds.push_back(bound);
+            return layout;
+        }
+
+        Histogram::BucketLayout Histogram::LogLinear(double start, size_t octaves, size_t subBuckets) {
+            if (!(start > 0.0) || octaves == 0 || subBuckets == 0) throw std::invalid_argument("Histogram::LogLinear: start must be positive, octaves and subBuckets non-zero");
+            BucketLayout layout;
+            layout.kind = BucketLayout::Kind::LogLinear;
+            layout.start = start;
+            layout.subBuckets = subBuckets;
+            layout.bounds.reserve(1 + octaves * subBuckets);
+            layout.bounds.push_back(start);
+            double base = start;
+            for (size_t octave = 0; octave < octaves; ++octave, base *= 2.0) {
+                for (size_t sub = 1; sub <= subBuckets; ++sub) {
+                    layout.bounds.push_back(base * (1.0 + static_cast<double>(sub) / static_cast<double>(subBuckets)));
+                }
+            }
+            return layout;
+        }
+
+        Histogram::Histogram(const LikesProgram::String& name, const std::vector<double>& buckets,
+            const LikesProgram::String& help,
+            const std::map<LikesProgram::String, LikesProgram::String>& labels, Storage storage)
+            : MetricsObject(name, help, labels), m_impl(new HistogramImpl{}) {
+            BucketLayout layout;
+            layout.bounds = buckets;
+            m_impl->Init(layout, storage);
+        }
+        Histogram::Histogram(const LikesProgram::String& name, const BucketLayout& layout,
+            const LikesProgram::String& help,
+            const std::map<LikesProgram::String, LikesProgram::String>& labels, Storage storage)
+            : MetricsObject(name, help, labels), m_impl(new HistogramImpl{}) {
+            m_impl->Init(layout, storage);
+        }
+        Histogram::Histogram(const Histogram& other) : MetricsObject(other), m_impl(other.m_impl ? new HistogramImpl{} : nullptr) {
+            if (other.m_impl) m_impl->CopyFrom(*other.m_impl);
         }
         Histogram& Histogram::operator=(const Histogram& other) {
             if (this != &other) {
                 MetricsObject::operator=(other);
                 if (other.m_impl) {
                     if (!m_impl) m_impl = new HistogramImpl{};
-                    m_impl->m_buckets = other.m_impl->m_buckets;
-
-                    m_impl->m_counts.clear();
-                    m_impl->m_counts.reserve(other.m_impl->m_counts.size());
-                    for (const auto& cptr : other.m_impl->m_counts) {
-                        m_impl->m_counts.emplace_back(std::make_unique<std::atomic<int64_t>>(cptr->load(std::memory_order_relaxed)));
-                    }
-
-                    m_impl->m_count.store(other.m_impl->m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
-                    m_impl->m_sum.store(other.m_impl->m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    m_impl->CopyFrom(*other.m_impl);
                 }
                 else {
                     delete m_impl;
@@ -80,16 +192,10 @@ namespace LikesProgram {
         }
 
         void Histogram::Observe(double value) {
-            // 更新总数
-            m_impl->m_count.fetch_add(1, std::memory_order_relaxed);
-            m_impl->m_sum.fetch_add(value, std::memory_order_relaxed);
-
-            // 找到合适的桶并增加计数
-            for (size_t i = 0; i < m_impl->m_buckets.size(); ++i) {
-                if (value <= m_impl->m_buckets[i]) {
-                    m_impl->m_counts[i]->fetch_add(1, std::memory_order_relaxed);
-                }
-            }
+            // 每次观测只更新所在桶与所在分片的总和，累计计数在读取时计算
+            size_t shard = m_impl->m_shardCount == 1 ? 0 : (ThreadStripe() & (m_impl->m_shardCount - 1));
+            m_impl->Slot(shard, m_impl->BucketIndex(value)).fetch_add(1, std::memory_order_relaxed);
+            m_impl->m_sums[shard].sum.fetch_add(value, std::memory_order_relaxed);
         }
 
         void Histogram::ObserveDuration(const LikesProgram::Time::Timer& timer) {
@@ -97,36 +203,57 @@ namespace LikesProgram {
             Observe(value_s);
         }
 
+        size_t Histogram::BucketIndex(double value) const {
+            return m_impl->BucketIndex(value);
+        }
+
+        void Histogram::Merge(std::span<const int64_t> bucketCounts, double sum) {
+            size_t shard = m_impl->m_shardCount == 1 ? 0 : (ThreadStripe() & (m_impl->m_shardCount - 1));
+            size_t n = std::min(bucketCounts.size(), m_impl->m_layout.bounds.size() + 1);
+            for (size_t i = 0; i < n; ++i) {
+                if (bucketCounts[i] != 0) m_impl->Slot(shard, i).fetch_add(bucketCounts[i], std::memory_order_relaxed);
+            }
+            m_impl->m_sums[shard].sum.fetch_add(sum, std::memory_order_relaxed);
+        }
+
         std::vector<double> Histogram::Buckets() const {
-            return m_impl->m_buckets;
+            return m_impl->m_layout.bounds;
         }
 
         std::vector<int64_t> Histogram::Counts() const {
             std::vector<int64_t> result;
 
-            result.reserve(m_impl->m_counts.size());
-            for (const auto& c : m_impl->m_counts) {
-                result.push_back(c->load(std::memory_order_relaxed));
+            result.reserve(m_impl->m_layout.bounds.size());
+            int64_t cumulative = 0;
+            for (size_t i = 0; i < m_impl->m_layout.bounds.size(); ++i) {
+                cumulative += m_impl->Load(i);
+                result.push_back(cumulative);
             }
 
             return result;
         }
 
         int64_t Histogram::Count() const {
-            return m_impl->m_count.load(std::memory_order_relaxed);
+            int64_t total = 0;
+            for (size_t i = 0; i <= m_impl->m_layout.bounds.size(); ++i) total += m_impl->Load(i);
+            return total;
         }
 
         double Histogram::Sum() const {
-            return m_impl->m_sum.load(std::memory_order_relaxed);
+            return m_impl->LoadSum();
+        }
+
+        Storage Histogram::GetStorage() const {
+            return m_impl->m_storage;
         }
 
         void Histogram::Reset() {
-            for (auto& cptr : m_impl->m_counts) {
-                cptr->store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i < m_impl->m_shardCount * m_impl->m_linesPerShard; ++i) {
+                for (auto& count : m_impl->m_lines[i].counts) count.store(0, std::memory_order_relaxed);
+            }
+            for (size_t shard = 0; shard < m_impl->m_shardCount; ++shard) {
+                m_impl->m_sums[shard].sum.store(0.0, std::memory_order_relaxed);
             }
-
-            m_impl->m_count.store(0, std::memory_order_relaxed);
-            m_impl->m_sum.store(0.0, std::memory_order_relaxed);
         }
 
         LikesProgram::String Histogram::Name() const {
@@ -148,27 +275,44 @@ namespace LikesProgram {
             result.Append(Type()).Append(u"\n");
 
             LikesProgram::String base = m_name;
-            for (size_t i = 0; i < m_impl->m_buckets.size(); ++i) {
+            const std::vector<double>& bounds = m_impl->m_layout.bounds;
+            std::vector<int64_t> counts = Counts();
+            int64_t count = Count();
+            for (size_t i = 0; i < bounds.size(); ++i) {
                 result.Append(base).Append(u"{le=\"")
-                    .Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_buckets[i]))
+                    .Append(LikesProgram::String::Format(u"{:.6f}", bounds[i]))
                     .Append(u"\"} ")
-                    .Append(LikesProgram::String::Format(u"{}", m_impl->m_counts[i]->load(std::memory_order_relaxed)))
+                    .Append(LikesProgram::String::Format(u"{}", counts[i]))
                     .Append(u"\n");
             }
 
             result.Append(base).Append(u"{le=\"+Inf\"} ")
-                .Append(LikesProgram::String::Format(u"{}", m_impl->m_count.load(std::memory_order_relaxed))).Append(u"\n");
+                .Append(LikesProgram::String::Format(u"{}", count)).Append(u"\n");
 
             result.Append(base).Append(u"_sum ")
-                .Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_sum.load(std::memory_order_relaxed))).Append(u"\n");
+                .Append(LikesProgram::String::Format(u"{:.6f}", m_impl->LoadSum())).Append(u"\n");
 
             result.Append(base).Append(u"_count ")
-                .Append(LikesProgram::String::Format(u"{}", m_impl->m_count.load(std::memory_order_relaxed))).Append(u"\n");
+                .Append(LikesProgram::String::Format(u"{}", count)).Append(u"\n");
 
             return result;
         }
 
 
+        void Histogram::Collect(MetricData& data) const {
+            data.kind = MetricData::Kind::Histogram;
+            const std::vector<double>& bounds = m_impl->m_layout.bounds;
+            data.bounds.assign(bounds.begin(), bounds.end());
+            data.counts.resize(bounds.size());
+            int64_t cumulative = 0;
+            for (size_t i = 0; i < bounds.size(); ++i) {
+                cumulative += m_impl->Load(i);
+                data.counts[i] = cumulative;
+            }
+            data.count = cumulative + m_impl->Load(bounds.size());
+            data.sum = m_impl->LoadSum();
+        }
+
         LikesProgram::String Histogram::ToJson() const {
             LikesProgram::String json;
             json.Append(u"{");
@@ -187,15 +331,18 @@ namespace LikesProgram {
             json.Append(u"},");
 
             json.Append(u"\"buckets\":{");
-            for (size_t i = 0; i < m_impl->m_buckets.size(); ++i) {
+            const std::vector<double>& bounds = m_impl->m_layout.bounds;
+            std::vector<int64_t> counts = Counts();
+            int64_t count = Count();
+            for (size_t i = 0; i < bounds.size(); ++i) {
                 if (i > 0) json.Append(u",");
-                json.Append(u"\"").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_buckets[i])).Append(u"\":")
-                    .Append(LikesProgram::String::Format(u"{}", m_impl->m_counts[i]->load(std::memory_order_relaxed)));
+                json.Append(u"\"").Append(LikesProgram::String::Format(u"{:.6f}", bounds[i])).Append(u"\":")
+                    .Append(LikesProgram::String::Format(u"{}", counts[i]));
             }
             json.Append(u"},");
 
-            json.Append(u"\"sum\":").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->m_sum.load(std::memory_order_relaxed))).Append(u",");
-            json.Append(u"\"count\":").Append(LikesProgram::String::Format(u"{}", m_impl->m_count.load(std::memory_order_relaxed)));
+            json.Append(u"\"sum\":").Append(LikesProgram::String::Format(u"{:.6f}", m_impl->LoadSum())).Append(u",");
+            json.Append(u"\"count\":").Append(LikesProgram::String::Format(u"{}", count));
             json.Append(u"}");
 
             return json;
@@ -0,0 +1,126 @@
+﻿#include "../../../include/LikesProgram/metrics/LocalHandle.hpp"
+#include "../../../include/LikesProgram/time/Time.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace LikesProgram {
+	namespace Metrics {
+        namespace {
+            // 所有存活句柄，供 FlushAll 遍历
+            std::mutex& HandlesMutex() {
+                static std::mutex mutex;
+                return mutex;
+            }
+            std::unordered_set<LocalHandle*>& Handles() {
+                static std::unordered_set<LocalHandle*> handles;
+                return handles;
+            }
+        }
+
+        LocalHandle::LocalHandle(const Options& options) : m_options(options),
+            m_nextFlush(std::chrono::steady_clock::now() + options.flushInterval) {
+            std::lock_guard lock(HandlesMutex());
+            Handles().insert(this);
+            m_attached = true;
+        }
+
+        LocalHandle::~LocalHandle() {
+            // 派生类应已调用 Detach，这里仅兜底从列表中移除
+            if (m_attached) {
+                std::lock_guard lock(HandlesMutex());
+                Handles().erase(this);
+            }
+        }
+
+        void LocalHandle::Detach() {
+            {
+                std::lock_guard lock(HandlesMutex());
+                Handles().erase(this);
+                m_attached = false;
+            }
+            Flush();
+        }
+
+        void LocalHandle::Flush() {
+            std::lock_guard lock(m_flushMutex);
+            FlushPending();
+        }
+
+        void LocalHandle::FlushAll() {
+            std::lock_guard lock(HandlesMutex());
+            for (LocalHandle* handle : Handles()) handle->Flush();
+        }
+
+        void LocalHandle::MaybeFlush() {
+            auto now = std::chrono::steady_clock::now();
+            if (now < m_nextFlush) return;
+            m_nextFlush = now + m_options.flushInterval;
+            Flush();
+        }
+
+        // --- LocalCounter ---
+        LocalCounter::LocalCounter(std::shared_ptr<Counter> counter, const Options& options)
+            : LocalHandle(options), m_counter(std::move(counter)) { }
+
+        LocalCounter::~LocalCounter() {
+            Detach();
+        }
+
+        void LocalCounter::FlushPending() {
+            int64_t integer = m_integer.load(std::memory_order_relaxed);
+            double real = m_real.load(std::memory_order_relaxed);
+            if (integer != m_flushedInteger) m_counter->Increment(integer - m_flushedInteger);
+            if (real != m_flushedReal) m_counter->Increment(real - m_flushedReal);
+            m_flushedInteger = integer;
+            m_flushedReal = real;
+        }
+
+        // --- LocalHistogram ---
+        LocalHistogram::LocalHistogram(std::shared_ptr<Histogram> histogram, const Options& options)
+            : LocalHandle(options), m_histogram(std::move(histogram)) {
+            size_t slots = m_histogram->Buckets().size() + 1;
+            m_counts = std::make_unique<std::atomic<int64_t>[]>(slots);
+            m_flushedCounts.assign(slots, 0);
+            m_delta.assign(slots, 0);
+        }
+
+        LocalHistogram::~LocalHistogram() {
+            Detach();
+        }
+
+        void LocalHistogram::ObserveDuration(const LikesProgram::Time::Timer& timer) {
+            Observe(LikesProgram::Time::NsToS(timer.GetLastElapsed().count()));
+        }
+
+        void LocalHistogram::FlushPending() {
+            // 先读和再读计数：计数可能多于和所含的观测（其和在下次刷新时补上），但和不会先于计数被合并后丢失
+            double sum = m_sum.load(std::memory_order_acquire);
+            bool changed = false;
+            for (size_t i = 0; i < m_delta.size(); ++i) {
+                int64_t count = m_counts[i].load(std::memory_order_relaxed);
+                m_delta[i] = count - m_flushedCounts[i];
+                m_flushedCounts[i] = count;
+                changed = changed || m_delta[i] != 0;
+            }
+            if (!changed) return;
+            m_histogram->Merge(m_delta, sum - m_flushedSum);
+            m_flushedSum = sum;
+        }
+
+        // --- LocalSummary ---
+        LocalSummary::LocalSummary(std::shared_ptr<Summary> summary, const Options& options)
+            : LocalHandle(options), m_summary(std::move(summary)),
+            m_capacity(std::max<size_t>(options.bufferSize, 1)), m_values(std::make_unique<double[]>(m_capacity)) { }
+
+        LocalSummary::~LocalSummary() {
+            Detach();
+        }
+
+        void LocalSummary::FlushPending() {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            for (; tail < head; ++tail) m_summary->Observe(m_values[tail % m_capacity]);
+            m_tail.store(head, std::memory_order_release);
+        }
+	}
+}
@@ -0,0 +1,137 @@
+﻿#include "../../../include/LikesProgram/metrics/MetricVec.hpp"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace LikesProgram {
+	namespace Metrics {
+        namespace {
+            struct Child {
+                std::vector<LikesProgram::String> values;
+                size_t hash = 0;
+                std::shared_ptr<MetricsObject> metric;
+            };
+
+            // 开放寻址哈希表：槽位只写入一次，扩容时发布新表，旧表保留到指标族析构（读方可能仍在访问）
+            struct Table {
+                size_t mask = 0;
+                std::unique_ptr<std::atomic<Child*>[]> slots;
+
+                explicit Table(size_t capacity) : mask(capacity - 1), slots(std::make_unique<std::atomic<Child*>[]>(capacity)) { }
+            };
+
+            size_t HashValues(std::span<const LikesProgram::String> values) {
+                size_t h = 0;
+                for (const auto& value : values) {
+                    h ^= std::hash<LikesProgram::String>{}(value) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                }
+                // std::hash<String> 低位分布不均，取槽位前再混合一次
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                return h;
+            }
+
+            bool SameValues(const Child& child, std::span<const LikesProgram::String> values) {
+                if (child.values.size() != values.size()) return false;
+                for (size_t i = 0; i < values.size(); ++i) {
+                    if (!(child.values[i] == values[i])) return false;
+                }
+                return true;
+            }
+
+            Child* Find(const Table& table, std::span<const LikesProgram::String> values, size_t hash) {
+                for (size_t index = hash & table.mask;; index = (index + 1) & table.mask) {
+                    Child* child = table.slots[index].load(std::memory_order_acquire);
+                    if (!child) return nullptr;
+                    if (child->hash == hash && SameValues(*child, values)) return child;
+                }
+            }
+
+            void Insert(Table& table, Child* child) {
+                size_t index = child->hash & table.mask;
+                while (table.slots[index].load(std::memory_order_relaxed)) index = (index + 1) & table.mask;
+                table.slots[index].store(child, std::memory_order_release);
+            }
+        }
+
+        struct MetricFamily::MetricFamilyImpl {
+            std::vector<LikesProgram::String> m_labelNames;
+            Factory m_factory;
+            Registry* m_registry = nullptr;
+
+            std::atomic<Table*> m_table{ nullptr };
+            mutable std::mutex m_mutex; // 保护创建子指标与扩容
+            std::vector<std::unique_ptr<Table>> m_tables;
+            std::vector<std::unique_ptr<Child>> m_children;
+        };
+
+        MetricFamily::MetricFamily(std::vector<LikesProgram::String> labelNames, Factory factory, Registry* registry)
+            : m_impl(new MetricFamilyImpl{}) {
+            m_impl->m_labelNames = std::move(labelNames);
+            m_impl->m_factory = std::move(factory);
+            m_impl->m_registry = registry;
+            m_impl->m_tables.push_back(std::make_unique<Table>(16));
+            m_impl->m_table.store(m_impl->m_tables.back().get(), std::memory_order_release);
+        }
+
+        MetricFamily::~MetricFamily() {
+            if (m_impl) {
+                if (m_impl->m_registry) {
+                    for (const auto& child : m_impl->m_children) {
+                        m_impl->m_registry->Unregister(child->metric->Name(), child->metric->Labels());
+                    }
+                }
+                delete m_impl;
+            }
+            m_impl = nullptr;
+        }
+
+        MetricsObject& MetricFamily::WithLabelValues(std::span<const LikesProgram::String> values) {
+            if (values.size() != m_impl->m_labelNames.size()) {
+                throw std::invalid_argument("MetricFamily::WithLabelValues: label value count does not match label names");
+            }
+
+            // 快速路径：无锁查找
+            size_t hash = HashValues(values);
+            if (Child* child = Find(*m_impl->m_table.load(std::memory_order_acquire), values, hash)) return *child->metric;
+
+            std::lock_guard lock(m_impl->m_mutex);
+            Table* table = m_impl->m_table.load(std::memory_order_relaxed);
+            if (Child* child = Find(*table, values, hash)) return *child->metric; // 其他线程已创建
+
+            std::map<LikesProgram::String, LikesProgram::String> labels;
+            for (size_t i = 0; i < values.size(); ++i) labels[m_impl->m_labelNames[i]] = values[i];
+
+            auto child = std::make_unique<Child>();
+            child->values.assign(values.begin(), values.end());
+            child->hash = hash;
+            child->metric = m_impl->m_factory(labels);
+            if (!child->metric) throw std::runtime_error("MetricFamily::WithLabelValues: factory returned null");
+            if (m_impl->m_registry) m_impl->m_registry->Register(child->metric);
+
+            // 负载因子超过 1/2 时扩容：新表填好后再发布
+            if ((m_impl->m_children.size() + 1) * 2 > table->mask + 1) {
+                auto grown = std::make_unique<Table>((table->mask + 1) * 2);
+                for (const auto& existing : m_impl->m_children) Insert(*grown, existing.get());
+                table = grown.get();
+                m_impl->m_tables.push_back(std::move(grown));
+                m_impl->m_table.store(table, std::memory_order_release);
+            }
+
+            Child* created = child.get();
+            m_impl->m_children.push_back(std::move(child));
+            Insert(*table, created);
+            return *created->metric;
+        }
+
+        size_t MetricFamily::Size() const {
+            std::lock_guard lock(m_impl->m_mutex);
+            return m_impl->m_children.size();
+        }
+
+        const std::vector<LikesProgram::String>& MetricFamily::LabelNames() const {
+            return m_impl->m_labelNames;
+        }
+	}
+}
@@ -63,6 +63,23 @@ namespace LikesProgram {
 			return result.Append(u"}");
 		}
 
+		void MetricsObject::Collect(MetricData& data) const {
+			data.kind = MetricData::Kind::Unknown;
+		}
+
+		const LikesProgram::String& MetricsObject::NameRef() const noexcept {
+			return m_name;
+		}
+
+		const LikesProgram::String& MetricsObject::HelpRef() const noexcept {
+			return m_help;
+		}
+
+		const std::map<LikesProgram::String, LikesProgram::String>& MetricsObject::LabelsRef() const noexcept {
+			static const std::map<LikesProgram::String, LikesProgram::String> empty;
+			return m_impl ? m_impl->m_labels : empty;
+		}
+
 		std::map<LikesProgram::String, LikesProgram::String>& MetricsObject::GetLabels() {
 			if (!m_impl) m_impl = new MetricsObjectImpl{};
 			return m_impl->m_labels;
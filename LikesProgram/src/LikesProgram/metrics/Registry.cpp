@@ -1,4 +1,5 @@
 ﻿#include "../../../include/LikesProgram/metrics/Registry.hpp"
+#include "../../../include/LikesProgram/metrics/LocalHandle.hpp"
 #include <mutex>
 #include <shared_mutex>
 #include <list>
@@ -72,7 +73,13 @@ namespace LikesProgram {
 			return (it != m_impl->m_metrics_map.end()) ? *(it->second) : nullptr;
 		}
 
+		std::vector<std::shared_ptr<MetricsObject>> Registry::Snapshot() const {
+			std::shared_lock lock(m_impl->m_mutex); // 共享锁
+			return std::vector<std::shared_ptr<MetricsObject>>(m_impl->m_metrics_list.begin(), m_impl->m_metrics_list.end());
+		}
+
 		LikesProgram::String Registry::ExportPrometheus() {
+			LocalHandle::FlushAll(); // 先合并线程本地句柄中的更新
 			std::shared_lock lock(m_impl->m_mutex); // 共享锁
 			String result;
 			for (auto& m : m_impl->m_metrics_list) result.Append(m->ToPrometheus()).Append(u"\n");
@@ -80,6 +87,7 @@ namespace LikesProgram {
 		}
 
 		LikesProgram::String Registry::ExportJson() {
+			LocalHandle::FlushAll(); // 先合并线程本地句柄中的更新
 			std::shared_lock lock(m_impl->m_mutex); // 共享锁
 			String result = u"[";
 			bool first = true;
@@ -1,6 +1,9 @@
 ﻿#include "../../../include/LikesProgram/metrics/Summary.hpp"
 #include "../../../include/LikesProgram/math/Math.hpp"
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace LikesProgram {
 	namespace Metrics {
@@ -10,11 +13,73 @@ namespace LikesProgram {
             std::atomic<double> m_emAverage{ 0.0 };
             std::atomic<double> m_min{ std::numeric_limits<double>::infinity() };
             std::atomic<double> m_max{ -std::numeric_limits<double>::infinity() };
+
+            // 滑动窗口的一个时间桶，epoch 为桶当前对应的时间片序号（-1 表示未使用）
+            struct WindowBucket {
+                Math::PercentileSketch sketch{ 400, 8, Math::PercentileSketch::Ingest::ThreadLocal };
+                std::atomic<int64_t> epoch{ -1 };
+            };
+            std::chrono::steady_clock::duration m_bucketDuration{ 0 };
+            std::vector<std::unique_ptr<WindowBucket>> m_window; // 环形数组，按 epoch % size 取桶
+            std::mutex m_rotateMutex;
+
+            void InitWindow(std::chrono::steady_clock::duration bucketDuration, size_t bucketCount) {
+                m_bucketDuration = bucketDuration;
+                m_window.clear();
+                for (size_t i = 0; i < bucketCount; i++) m_window.push_back(std::make_unique<WindowBucket>());
+            }
+
+            void CopyWindow(const SummaryImpl& other) {
+                InitWindow(other.m_bucketDuration, other.m_window.size());
+                for (size_t i = 0; i < m_window.size(); i++) {
+                    m_window[i]->sketch = other.m_window[i]->sketch;
+                    m_window[i]->epoch.store(other.m_window[i]->epoch.load(std::memory_order_acquire), std::memory_order_release);
+                }
+            }
+
+            int64_t CurrentEpoch() const {
+                return std::chrono::steady_clock::now().time_since_epoch() / m_bucketDuration;
+            }
+
+            // 写入当前时间桶，桶已过期时先清空再复用
+            void WindowAdd(double value) {
+                int64_t epoch = CurrentEpoch();
+                WindowBucket& bucket = *m_window[static_cast<size_t>(epoch) % m_window.size()];
+                if (bucket.epoch.load(std::memory_order_acquire) != epoch) {
+                    std::lock_guard lock(m_rotateMutex);
+                    if (bucket.epoch.load(std::memory_order_relaxed) < epoch) {
+                        bucket.sketch.Reset();
+                        bucket.epoch.store(epoch, std::memory_order_release);
+                    }
+                }
+                bucket.sketch.Add(value);
+            }
+
+            // 合并仍在窗口内的桶
+            void WindowMerge(Math::PercentileSketch& merged) const {
+                int64_t epoch = CurrentEpoch();
+                int64_t oldest = epoch - static_cast<int64_t>(m_window.size()) + 1;
+                for (const auto& bucket : m_window) {
+                    int64_t bucketEpoch = bucket->epoch.load(std::memory_order_acquire);
+                    if (bucketEpoch >= oldest && bucketEpoch <= epoch) merged.Merge(bucket->sketch);
+                }
+            }
         };
         Summary::Summary(const LikesProgram::String& name,
             size_t maxWindow, const LikesProgram::String& help,
             const std::map<LikesProgram::String, LikesProgram::String>& labels)
-            : MetricsObject(name, help, labels), m_maxWindow(maxWindow), m_impl(new SummaryImpl{}) {
+            : MetricsObject(name, help, labels), m_maxWindow(maxWindow),
+            m_sketch(400, 8, Math::PercentileSketch::Ingest::ThreadLocal), m_impl(new SummaryImpl{}) {
+        }
+        Summary::Summary(const LikesProgram::String& name,
+            std::chrono::milliseconds bucketDuration, size_t bucketCount, const LikesProgram::String& help,
+            const std::map<LikesProgram::String, LikesProgram::String>& labels)
+            : MetricsObject(name, help, labels), m_maxWindow(bucketCount),
+            m_sketch(400, 1), m_impl(new SummaryImpl{}) {
+            if (bucketDuration.count() <= 0 || bucketCount == 0) {
+                throw std::invalid_argument("Summary window requires a positive bucket duration and bucket count");
+            }
+            m_impl->InitWindow(bucketDuration, bucketCount);
         }
         Summary::Summary(const Summary& other) : MetricsObject(other),
         m_maxWindow(other.m_maxWindow), m_alpha(other.m_alpha), m_sketch(other.m_sketch), m_impl(other.m_impl ? new SummaryImpl{} : nullptr) {
@@ -24,6 +89,7 @@ namespace LikesProgram {
                 m_impl->m_emAverage.store(other.m_impl->m_emAverage.load(std::memory_order_relaxed), std::memory_order_relaxed);
                 m_impl->m_min.store(other.m_impl->m_min.load(std::memory_order_relaxed), std::memory_order_relaxed);
                 m_impl->m_max.store(other.m_impl->m_max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                m_impl->CopyWindow(*other.m_impl);
             }
         }
         Summary& Summary::operator=(const Summary& other) {
@@ -39,6 +105,7 @@ namespace LikesProgram {
                     m_impl->m_emAverage.store(other.m_impl->m_emAverage.load(std::memory_order_relaxed), std::memory_order_relaxed);
                     m_impl->m_min.store(other.m_impl->m_min.load(std::memory_order_relaxed), std::memory_order_relaxed);
                     m_impl->m_max.store(other.m_impl->m_max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    m_impl->CopyWindow(*other.m_impl);
                 }
                 else {
                     delete m_impl;
@@ -71,13 +138,21 @@ namespace LikesProgram {
         void Summary::Observe(double value) {
             UpdateStats(value);
 
-            m_sketch.Add(value);
+            if (!m_impl->m_window.empty()) m_impl->WindowAdd(value);
+            else m_sketch.Add(value);
         }
 
         double Summary::Quantile(double q) const {
             if (q < 0.0 || q > 1.0) {
                 throw std::invalid_argument("Quantile q must be between 0 and 1");
             }
+            if (!m_impl->m_window.empty()) {
+                // 只合并窗口内的桶，窗口内无数据时返回 0
+                Math::PercentileSketch merged(400, 1);
+                m_impl->WindowMerge(merged);
+                double val = merged.Quantile(q);
+                return std::isnan(val) ? 0.0 : val;
+            }
             // 确保 centroids 包含最新数据
             const_cast<Math::PercentileSketch&>(m_sketch).Compress();
             double val = m_sketch.Quantile(q);
@@ -101,6 +176,10 @@ namespace LikesProgram {
             m_impl->m_min.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
             m_impl->m_max.store(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
             m_sketch.Reset();
+            for (auto& bucket : m_impl->m_window) {
+                bucket->sketch.Reset();
+                bucket->epoch.store(-1, std::memory_order_release);
+            }
         }
 
         void Summary::SetEMAAlpha(double alpha) {
@@ -119,6 +198,10 @@ namespace LikesProgram {
             return Count() ? m_impl->m_max.load(std::memory_order_relaxed) : std::numeric_limits<double>::lowest();
         }
 
+        bool Summary::IsWindowed() const {
+            return m_impl && !m_impl->m_window.empty();
+        }
+
         void Summary::UpdateStats(double value) {
             m_impl->m_count.fetch_add(1, std::memory_order_relaxed);
             m_impl->m_sum.fetch_add(value, std::memory_order_relaxed);
@@ -207,6 +290,16 @@ namespace LikesProgram {
             return result;
         }
 
+        void Summary::Collect(MetricData& data) const {
+            data.kind = MetricData::Kind::Summary;
+            data.count = m_impl->m_count.load(std::memory_order_relaxed);
+            data.sum = m_impl->m_sum.load(std::memory_order_relaxed);
+            for (double q : { 0.5, 0.9, 0.99 }) {
+                data.quantiles.push_back(q);
+                data.quantileValues.push_back(Quantile(q));
+            }
+        }
+
         LikesProgram::String Summary::ToJson() const {
             LikesProgram::String json;
             json.Append(u"{");
@@ -0,0 +1,184 @@
+﻿#include "../../../include/LikesProgram/stringFormat/FormatCache.hpp"
+#include "../../../include/LikesProgram/metrics/Counter.hpp"
+#include "../../../include/LikesProgram/metrics/Registry.hpp"
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace LikesProgram {
+    namespace StringFormat {
+        namespace {
+            struct Entry {
+                String text;
+                size_t hash = 0;
+                FormatCache::Program program;
+            };
+
+            // 索引键指向链表节点中的格式串，查找时指向调用方的格式串，命中无需拷贝
+            struct KeyRef {
+                const String* text;
+                size_t hash;
+            };
+            struct KeyHash {
+                size_t operator()(const KeyRef& key) const noexcept { return key.hash; }
+            };
+            struct KeyEqual {
+                bool operator()(const KeyRef& a, const KeyRef& b) const { return a.hash == b.hash && *a.text == *b.text; }
+            };
+
+            struct alignas(64) Shard {
+                std::mutex mutex;
+                std::list<Entry> lru; // 头部为最近使用
+                std::unordered_map<KeyRef, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+            };
+
+            // 解析结果与格式串副本放在同一块内存中，FormatSpec 绑定到副本，
+            // 调用方的格式串失效或条目被淘汰后，返回的 Program 仍可安全读取文本
+            struct OwnedProgram {
+                String text;
+                FormatParser::Result result;
+            };
+
+            FormatCache::Program ParseOwned(const String& fmt) {
+                auto owned = std::make_shared<OwnedProgram>();
+                owned->text = fmt;
+                owned->result = FormatParser().Parse(owned->text);
+                return FormatCache::Program(owned, &owned->result);
+            }
+
+            size_t MixHash(size_t h) {
+                // std::hash<String> 为多项式哈希，低位分布不均，选择分片前再混合一次
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                return h;
+            }
+        }
+
+        struct FormatCache::FormatCacheImpl {
+            Shard m_shards[ShardCount];
+            std::atomic<size_t> m_capacity{ 0 };
+
+            // 命中、未命中由所有格式化线程高频更新，使用分散存储；淘汰只在插入时发生
+            std::shared_ptr<Metrics::Counter> m_hits = std::make_shared<Metrics::Counter>(u"likesprogram_format_cache_hits_total", u"Format cache hits",
+                std::map<String, String>{}, Metrics::Storage::Striped);
+            std::shared_ptr<Metrics::Counter> m_misses = std::make_shared<Metrics::Counter>(u"likesprogram_format_cache_misses_total", u"Format cache misses",
+                std::map<String, String>{}, Metrics::Storage::Striped);
+            std::shared_ptr<Metrics::Counter> m_evictions = std::make_shared<Metrics::Counter>(u"likesprogram_format_cache_evictions_total", u"Format cache evictions");
+
+            // 每个分片的容量（向上取整，保证总容量不小于设定值）
+            size_t ShardCapacity() const {
+                size_t capacity = m_capacity.load(std::memory_order_relaxed);
+                return (capacity + ShardCount - 1) / ShardCount;
+            }
+
+            // 淘汰超出容量的条目（调用方持有分片锁）
+            void Trim(Shard& shard, size_t capacity) {
+                while (shard.lru.size() > capacity) {
+                    Entry& last = shard.lru.back();
+                    shard.index.erase(KeyRef{ &last.text, last.hash });
+                    shard.lru.pop_back();
+                    m_evictions->Increment();
+                }
+            }
+        };
+
+        FormatCache::FormatCache(size_t capacity) : m_impl(new FormatCacheImpl()) {
+            m_impl->m_capacity.store(capacity, std::memory_order_relaxed);
+        }
+
+        FormatCache::~FormatCache() {
+            if (m_impl) delete m_impl;
+            m_impl = nullptr;
+        }
+
+        FormatCache::Program FormatCache::Get(const String& fmt) {
+            size_t shardCapacity = m_impl->ShardCapacity();
+            if (shardCapacity == 0 || fmt.Size() > MaxKeyLength) {
+                m_impl->m_misses->Increment();
+                return ParseOwned(fmt);
+            }
+
+            size_t hash = std::hash<String>{}(fmt);
+            Shard& shard = m_impl->m_shards[MixHash(hash) % ShardCount];
+            {
+                std::lock_guard lock(shard.mutex);
+                auto it = shard.index.find(KeyRef{ &fmt, hash });
+                if (it != shard.index.end()) {
+                    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                    m_impl->m_hits->Increment();
+                    return it->second->program;
+                }
+            }
+
+            // 解析在锁外进行，避免阻塞同一分片上的其他格式串
+            m_impl->m_misses->Increment();
+            Program program = ParseOwned(fmt);
+
+            std::lock_guard lock(shard.mutex);
+            auto it = shard.index.find(KeyRef{ &fmt, hash });
+            if (it != shard.index.end()) return it->second->program; // 其他线程已插入
+
+            shard.lru.push_front(Entry{ fmt, hash, program });
+            shard.index.emplace(KeyRef{ &shard.lru.front().text, hash }, shard.lru.begin());
+            m_impl->Trim(shard, shardCapacity);
+            return program;
+        }
+
+        void FormatCache::SetCapacity(size_t capacity) {
+            m_impl->m_capacity.store(capacity, std::memory_order_relaxed);
+            size_t shardCapacity = m_impl->ShardCapacity();
+            for (Shard& shard : m_impl->m_shards) {
+                std::lock_guard lock(shard.mutex);
+                m_impl->Trim(shard, shardCapacity);
+            }
+        }
+
+        size_t FormatCache::Capacity() const {
+            return m_impl->m_capacity.load(std::memory_order_relaxed);
+        }
+
+        size_t FormatCache::Size() const {
+            size_t size = 0;
+            for (Shard& shard : m_impl->m_shards) {
+                std::lock_guard lock(shard.mutex);
+                size += shard.lru.size();
+            }
+            return size;
+        }
+
+        void FormatCache::Clear() {
+            for (Shard& shard : m_impl->m_shards) {
+                std::lock_guard lock(shard.mutex);
+                shard.index.clear();
+                shard.lru.clear();
+            }
+        }
+
+        uint64_t FormatCache::Hits() const {
+            return static_cast<uint64_t>(m_impl->m_hits->Value());
+        }
+
+        uint64_t FormatCache::Misses() const {
+            return static_cast<uint64_t>(m_impl->m_misses->Value());
+        }
+
+        uint64_t FormatCache::Evictions() const {
+            return static_cast<uint64_t>(m_impl->m_evictions->Value());
+        }
+
+        void FormatCache::RegisterMetrics(Metrics::Registry& registry) {
+            registry.Register(m_impl->m_hits);
+            registry.Register(m_impl->m_misses);
+            registry.Register(m_impl->m_evictions);
+        }
+
+        void FormatCache::UnregisterMetrics(Metrics::Registry& registry) {
+            registry.Unregister(m_impl->m_hits->Name(), m_impl->m_hits->Labels());
+            registry.Unregister(m_impl->m_misses->Name(), m_impl->m_misses->Labels());
+            registry.Unregister(m_impl->m_evictions->Name(), m_impl->m_evictions->Labels());
+        }
+    }
+}
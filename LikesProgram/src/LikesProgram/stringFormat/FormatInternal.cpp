@@ -1,5 +1,6 @@
 ﻿#include "../../../include/LikesProgram/stringFormat/FormatInternal.hpp"
 #include "../../../include/LikesProgram/time/Time.hpp"
+#include "../../../include/LikesProgram/metrics/Registry.hpp"
 #include <sstream>
 #include <iomanip>
 #include <atomic>
@@ -58,6 +59,7 @@ namespace LikesProgram {
                 inst = instance.load(std::memory_order_relaxed);
                 if (!inst) {
                     inst = new FormatInternal(); // 构造函数为私有或受限时，这里也可以访问
+                    inst->m_impl->m_cache.RegisterMetrics(Metrics::Registry::Global());
                     instance.store(inst, std::memory_order_release);
                 }
             }
@@ -84,11 +86,15 @@ namespace LikesProgram {
             return m_impl->m_nameFormatters.find(name) != m_impl->m_nameFormatters.end();
         }
 
+        FormatCache& FormatInternal::Cache() {
+            return m_impl->m_cache;
+        }
+
         // 格式化
         String FormatInternal::FormatAny(const String& fmt, const std::vector<Any>& args) {
-            // 解析格式字符串
-            FormatParser parser;
-            auto res = parser.Parse(fmt);
+            // 解析格式字符串（命中缓存时复用已解析的 token）
+            FormatCache::Program program = m_impl->m_cache.Get(fmt);
+            const FormatParser::Result& res = *program;
 
             if (res.hasFatalError) {
                 // 语法错误：直接返回错误标志
@@ -113,12 +119,15 @@ namespace LikesProgram {
             // 逐个处理 token
             for (const auto& tok : res.tokens) {
                 if (!tok.isPlaceholder) {
-                    // 普通文本直接拼接
-                    output = output + tok.literal;
+                    // 普通文本直接拼接（无效占位符输出 {!}）
+                    if (tok.isInvalid) output = output + String(U"{!}");
+                    else output = output + fmt.SubString(tok.literal.offset, tok.literal.length);
                     continue;
                 }
 
-                const FormatSpec& spec = tok.spec;
+                // 缓存中的 token 可能来自另一个相同内容的格式串，重新绑定到本次的 fmt
+                FormatSpec spec = tok.spec;
+                spec.Bind(fmt);
                 int chosenIndex = -1;
 
                 // 显式参数索引
@@ -223,6 +232,7 @@ namespace LikesProgram {
                         if (spec.GetAlternateForm()) oss << (upperHex ? L"0X" : L"0x");
                         oss << std::hex << (upperHex ? std::uppercase : std::nouppercase)
                             << static_cast<unsigned long long>(v);
+                        return oss.str();
                     }
                     // 二进制
                     if (type == U'b' || type == U'B') {
@@ -269,6 +279,7 @@ namespace LikesProgram {
                     if (type == U'x' || type == U'X') {
                         if (spec.GetAlternateForm()) oss << (type == U'X' ? L"0X" : L"0x");
                         oss << std::hex << (type == U'X' ? std::uppercase : std::nouppercase) << v;
+                        return oss.str();
                     }
                     // 二进制
                     if (type == U'b' || type == U'B') {
@@ -32,7 +32,7 @@ namespace LikesProgram {
             }
 
             size_t pos = 0;
-            String content;
+            TextRange range;
             bool isPh = false;
 
             std::set<int> usedIndices;      // 已使用索引
@@ -41,7 +41,7 @@ namespace LikesProgram {
             while (true) {
                 size_t tokenStart = pos;
                 try {
-                    bool ok = ExtractNextToken(fmt, pos, content, isPh);
+                    bool ok = ExtractNextToken(fmt, pos, range, isPh);
                     if (!ok) break;
 
                     Token t;
@@ -51,7 +51,7 @@ namespace LikesProgram {
                     if (isPh) {
                         try {
                             // ParsePlaceholder 可能抛出异常 -> 捕获并记录到 res
-                            FormatSpec spec = ParsePlaceholder(content);
+                            FormatSpec spec = ParsePlaceholder(fmt, range);
 
                             // 智能索引逻辑
                             if (spec.HasExplicitIndex()) {
@@ -63,29 +63,30 @@ namespace LikesProgram {
                                 usedIndices.insert(nextAutoIndex++);
                             }
 
-                            spec.SetRaw(content);
-                            t.spec = std::move(spec);
+                            spec.SetRaw(range);
+                            t.spec = spec;
                         }
                         catch (const std::exception& ex) {
                             // 将解析错误作为非致命错误记录，并尝试继续（或根据需要标记致命）
                             res.errors.push_back({ tokenStart, String(std::string("ParsePlaceholder error: ") + ex.what()) });
                             // 将该 token 标记为无效占位符，以便后续 Format 执行阶段输出占位符占位符（例如 "{!}"）
                             t.spec.SetValid(false);
-                            t.literal = String("{!}");
+                            t.isInvalid = true;
                             t.isPlaceholder = false; // treat as literal fallback
                         }
                         catch (...) {
                             res.errors.push_back({ tokenStart, String("ParsePlaceholder threw unknown exception") });
                             t.spec.SetValid(false);
-                            t.literal = String("{!}");
+                            t.isInvalid = true;
                             t.isPlaceholder = false;
                         }
                     }
                     else {
-                        t.literal = content;
+                        t.literal = range;
                     }
 
-                    res.tokens.push_back(std::move(t));
+                    t.spec.Bind(fmt);
+                    res.tokens.push_back(t);
                 }
                 catch (const std::exception& ex) {
                     // ExtractNextToken 或其他底层函数抛出异常，记录为致命错误并停止解析
@@ -121,101 +122,84 @@ namespace LikesProgram {
         }
 
         // 提取下一个 token
-        bool FormatParser::ExtractNextToken(const String& fmt, size_t& pos, String& outContent, bool& outIsPlaceholder) {
-            if (pos >= fmt.Size()) return false;
-            outContent.Clear();
+        bool FormatParser::ExtractNextToken(const String& fmt, size_t& pos, TextRange& outRange, bool& outIsPlaceholder) {
+            size_t size = fmt.Size();
+            if (pos >= size) return false;
+            size_t start = pos;
+            outIsPlaceholder = false;
 
-            while (pos < fmt.Size()) {
+            while (pos < size) {
                 char32_t c = fmt[pos];
 
-                if (c == U'{') {
-                    if (pos + 1 < fmt.Size() && fmt[pos + 1] == U'{') {
-                        // 转义 {{
-                        outContent.Append(U'{');
+                if (c == U'{' || c == U'}') {
+                    if (pos + 1 < size && fmt[pos + 1] == c) {
+                        // 转义 {{ / }}：文本保留第一个括号，跳过第二个
+                        outRange = { static_cast<uint32_t>(start), static_cast<uint32_t>(pos + 1 - start) };
                         pos += 2;
-                    }
-                    else {
-                        // 占位符开始
-                        if (!outContent.Empty()) {
-                            // 先返回前面的文本
-                            outIsPlaceholder = false;
-                            return true;
-                        }
-                        ++pos;
-                        // 找闭合 }
-                        size_t phStart = pos;
-                        while (pos < fmt.Size() && fmt[pos] != U'}') ++pos;
-                        if (pos >= fmt.Size()) ThrowFormatError(U"缺少 '}' 结束符", fmt, phStart - 1);
-                        outIsPlaceholder = true;
-                        outContent = fmt.SubString(phStart, pos - phStart);
-                        ++pos;
                         return true;
                     }
-                }
-                else if (c == U'}') {
-                    if (pos + 1 < fmt.Size() && fmt[pos + 1] == U'}') {
-                        // 转义 }}
-                        outContent.Append(U'}');
-                        pos += 2;
+                    if (pos > start) {
+                        // 先返回前面的文本
+                        outRange = { static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start) };
+                        return true;
                     }
-                    else {
-                        // 单独的闭括号，说明文本结束
-                        if (!outContent.Empty()) {
-                            outIsPlaceholder = false;
-                            return true;
-                        }
-                        // 不合法的单 } 在 ValidateBraces 会检查
+                    if (c == U'}') {
+                        // 单独的闭括号（不合法的单 } 在 ValidateBraces 会检查）
                         ++pos;
-                        outContent.Append(U'}');
-                        outIsPlaceholder = false;
+                        outRange = { static_cast<uint32_t>(start), 1 };
                         return true;
                     }
-                }
-                else {
-                    outContent.Append(c);
+
+                    // 占位符开始，找闭合 }
                     ++pos;
+                    size_t phStart = pos;
+                    while (pos < size && fmt[pos] != U'}') ++pos;
+                    if (pos >= size) ThrowFormatError(U"缺少 '}' 结束符", fmt, phStart - 1);
+                    outIsPlaceholder = true;
+                    outRange = { static_cast<uint32_t>(phStart), static_cast<uint32_t>(pos - phStart) };
+                    ++pos;
+                    return true;
                 }
+                ++pos;
             }
 
             // 文本剩余
-            if (!outContent.Empty()) {
-                outIsPlaceholder = false;
-                return true;
-            }
-            return false;
+            outRange = { static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start) };
+            return true;
         }
 
         // 解析占位符
-        FormatSpec FormatParser::ParsePlaceholder(const String& inside) {
+        FormatSpec FormatParser::ParsePlaceholder(const String& fmt, TextRange inside) {
             FormatSpec spec;
-            size_t i = 0;
+            size_t i = inside.offset;
+            size_t end = static_cast<size_t>(inside.offset) + inside.length;
 
-            SkipSpaces(inside, i);
-            auto idx = ParseNumber(inside, i);
+            SkipSpaces(fmt, i, end);
+            auto idx = ParseNumber(fmt, i, end);
             if (idx) spec.SetIndex(*idx, true);
 
-            SkipSpaces(inside, i);
-            if (i < inside.Size() && inside[i] == U':') {
+            SkipSpaces(fmt, i, end);
+            if (i < end && fmt[i] == U':') {
                 ++i;
-                ParseFormatOptions(inside, i, spec);
+                ParseFormatOptions(fmt, i, end, spec);
             }
-            SkipSpaces(inside, i);
-            if (i != inside.Size())
-                ThrowFormatError(U"占位符中存在无效字符", inside, i);
+            SkipSpaces(fmt, i, end);
+            if (i != end)
+                ThrowFormatError(U"占位符中存在无效字符", fmt.SubString(inside.offset, inside.length), i - inside.offset);
 
             return spec;
         }
 
         // 跳过空格
-        void FormatParser::SkipSpaces(const String& s, size_t& i) {
-            while (i < s.Size() && (s[i] == U' ' || s[i] == U'\t')) ++i;
+        void FormatParser::SkipSpaces(const String& s, size_t& i, size_t end) {
+            while (i < end && (s[i] == U' ' || s[i] == U'\t')) ++i;
         }
 
         // 解析整数数字
-        std::optional<int> FormatParser::ParseNumber(const String& s, size_t& i) {
-            if (i >= s.Size() || !isdigit((int)s[i])) return std::nullopt;
+        std::optional<int> FormatParser::ParseNumber(const String& s, size_t& i, size_t end) {
+            if (i >= end || !isdigit((int)s[i])) return std::nullopt;
             int val = 0;
-            while (i < s.Size() && isdigit((int)s[i])) {
+            while (i < end && isdigit((int)s[i])) {
                 val = val * 10 + (s[i] - U'0');
                 ++i;
             }
@@ -223,8 +207,8 @@ namespace LikesProgram {
         }
 
         // 解析填充字符（例如 "_>" 或 "'X^"）
-        String FormatParser::ParseFillChar(const String& s, size_t& i) {
-            if (i >= s.Size()) return String();
+        bool FormatParser::ParseFillChar(const String& s, size_t& i, size_t end, FormatSpec& spec) {
+            if (i >= end) return false;
 
             char32_t quote = 0;
             if (s[i] == U'\'' || s[i] == U'"') {
@@ -232,38 +216,32 @@ namespace LikesProgram {
                 ++i;
             }
 
-            String fill;
             if (quote) {
-                // 多字符或转义解析
-                while (i < s.Size()) {
+                // 多字符或转义解析：单个码点直接保存，多字符保存引号内的原文区间
+                size_t begin = i;
+                size_t count = 0;
+                char32_t first = 0;
+                while (i < end) {
                     char32_t c = s[i];
-                    if (c == quote) {
-                        ++i; // 结束
-                        break;
-                    }
-                    if (c == U'\\' && i + 1 < s.Size()) {
-                        ++i;
-                        switch (s[i]) {
-                        case U'n': fill += U'\n'; break;
-                        case U't': fill += U'\t'; break;
-                        case U'r': fill += U'\r'; break;
-                        case U'\\': fill += U'\\'; break;
-                        case U'\'': fill += U'\''; break;
-                        case U'"': fill += U'"'; break;
-                        default: fill += s[i]; break;
-                        }
-                    }
-                    else {
-                        fill += c;
-                    }
+                    if (c == quote) break;
+                    if (c == U'\\' && i + 1 < end) c = FormatSpec::Unescape(s[++i]);
+                    if (count++ == 0) first = c;
                     ++i;
                 }
+                size_t contentEnd = i;
+                if (i < end) ++i; // 结束引号
+
+                if (count == 0) return false;
+                if (count == 1) spec.SetFill(first);
+                else spec.SetFill(TextRange{ static_cast<uint32_t>(begin), static_cast<uint32_t>(contentEnd - begin) });
+                return true;
             }
-            else if (i + 1 < s.Size() && IsAlignChar(s[i + 1])) {
-                fill = String(1, s[i]);
+            else if (i + 1 < end && IsAlignChar(s[i + 1])) {
+                spec.SetFill(s[i]);
                 ++i; // 单字符填充兼容旧写法
+                return true;
             }
-            return fill;
+            return false;
         }
 
 
@@ -273,64 +251,52 @@ namespace LikesProgram {
         }
 
         // 解析格式选项
-        void FormatParser::ParseFormatOptions(const String& s, size_t& i, FormatSpec& spec) {
+        void FormatParser::ParseFormatOptions(const String& s, size_t& i, size_t end, FormatSpec& spec) {
             // 填充 + 对齐
-            String fill = ParseFillChar(s, i);
+            ParseFillChar(s, i, end, spec);
             // 尝试解析对齐字符
-            char32_t align = 0;
-            if (i < s.Size() && IsAlignChar(s[i])) {
-                align = s[i];
+            if (i < end && IsAlignChar(s[i])) {
+                spec.SetAlign(s[i]);
                 ++i;
             }
 
-            // 无论 align 是否存在，都先设置 fill
-            if (!fill.Empty()) {
-                spec.SetFill(fill);
-            }
-
-            // 如果存在对齐字符，再设置 align
-            if (align) {
-                spec.SetAlign(align);
-            }
-
             // 符号
-            if (i < s.Size() && (s[i] == U'+' || s[i] == U'-' || s[i] == U' ')) {
+            if (i < end && (s[i] == U'+' || s[i] == U'-' || s[i] == U' ')) {
                 spec.SetSign(s[i]);
                 ++i;
             }
 
             // '#' 标志
-            if (i < s.Size() && s[i] == U'#') {
+            if (i < end && s[i] == U'#') {
                 spec.SetAlternateForm(true);
                 ++i;
             }
 
             // '0' 填充
-            if (i < s.Size() && s[i] == U'0') {
+            if (i < end && s[i] == U'0') {
                 spec.SetZeroPad(true);
                 ++i;
             }
 
             // 宽度
-            if (auto w = ParseNumber(s, i)) spec.SetWidth(*w);
+            if (auto w = ParseNumber(s, i, end)) spec.SetWidth(*w);
 
             // 精度
-            if (i < s.Size() && s[i] == U'.') {
+            if (i < end && s[i] == U'.') {
                 ++i;
-                if (auto p = ParseNumber(s, i)) spec.SetPrecision(*p);
+                if (auto p = ParseNumber(s, i, end)) spec.SetPrecision(*p);
                 else ThrowFormatError(U"精度值无效", s, i);
             }
 
             // 类型
-            if (i < s.Size() && IsTypeChar(s[i])) {
+            if (i < end && IsTypeChar(s[i])) {
                 spec.SetType(s[i]);
                 ++i;
 
                 // 类型扩展参数
-                if (i < s.Size()) {
-                    String expand = s.SubString(i, s.Size() - 1);
-                    spec.SetTypeExpand(expand);
-                    i = s.Size(); // 消耗到末尾
+                if (i < end) {
+                    spec.SetTypeExpand(TextRange{ static_cast<uint32_t>(i), static_cast<uint32_t>(end - i) });
+                    i = end; // 消耗到末尾
                 }
             }
         }
@@ -1,130 +1,122 @@
 ﻿#include "../../../include/LikesProgram/stringFormat/FormatSpec.hpp"
+#include <type_traits>
 
 namespace LikesProgram {
 	namespace StringFormat {
-        struct FormatSpec::FormatSpecImpl {
-            // 索引相关
-            int index = -1;               // 参数索引（若为 -1 表示未显式指定）
-            bool explicitIndex = false;   // 是否显式指定了 index
-
-            // 填充与对齐
-            String fill = U" ";           // 填充字符，可多字符（默认空格）
-            char32_t align = U'>';        // 对齐方式：<' 左, >' 右, ^' 居中, 默认右对齐
-
-            // 符号控制
-            char32_t sign = 0;            // '+', '-', ' '，0 表示未指定
-            bool alternateForm = false;        // '#'，显示进制前缀
-            bool zeroPad = false;         // '0'，零填充
-
-            // 宽度与精度
-            std::optional<int> width;     // 输出最小宽度（可省略）
-            std::optional<int> precision; // 精度或字符串截断（可省略）
-
-            // 类型控制
-            char32_t type = U's';         // 数据类型标识：s, d, x, f, t 等
-            String typeExpand;            // 类型扩展描述（如时间模板）
-
-            // 内部状态与扩展
-            bool valid = true;            // 是否解析成功（false 表示格式错误）
-            String raw;                   // 原始格式子串，便于调试或错误输出
-
-            FormatSpecImpl() = default;
-            FormatSpecImpl(int idx, bool exp) : index(idx), explicitIndex(exp) {}
-        };
-
-        // --- 构造 / 析构 ---
-        FormatSpec::FormatSpec()
-            : impl(new FormatSpecImpl()) {
-        }
-
-        FormatSpec::FormatSpec(int idx, bool explicitIdx)
-            : impl(new FormatSpecImpl(idx, explicitIdx)) {
-        }
+        static_assert(std::is_trivially_copyable_v<FormatSpec>, "FormatSpec 需保持可平凡拷贝");
 
-        FormatSpec::~FormatSpec() {
-            if (impl) {
-                delete impl;
-                impl = nullptr;
-            }
+        // --- 构造 ---
+        FormatSpec::FormatSpec(int idx, bool explicitIdx) noexcept {
+            SetIndex(idx, explicitIdx);
         }
 
-        // --- 拷贝 / 移动 ---
-        FormatSpec::FormatSpec(const FormatSpec& other)
-            : impl(new FormatSpecImpl(*other.impl)) {
+        // --- 重置 ---
+        void FormatSpec::Reset() noexcept {
+            *this = FormatSpec{};
         }
 
-        FormatSpec::FormatSpec(FormatSpec&& other) noexcept
-            : impl(other.impl) {
-            other.impl = nullptr;
-        }
+        void FormatSpec::Bind(const String& fmt) noexcept { m_source = &fmt; }
 
-        FormatSpec& FormatSpec::operator=(const FormatSpec& other) {
-            if (this != &other) {
-                if (!impl)
-                    impl = new FormatSpecImpl();
-                *impl = *other.impl;
-            }
-            return *this;
+        String FormatSpec::Slice(TextRange range) const {
+            if (!m_source || range.Empty()) return String();
+            return m_source->SubString(range.offset, range.length);
         }
 
-        FormatSpec& FormatSpec::operator=(FormatSpec&& other) noexcept {
-            if (this != &other) {
-                if (impl)
-                    delete impl;
-                impl = other.impl;
-                other.impl = nullptr;
+        char32_t FormatSpec::Unescape(char32_t c) noexcept {
+            switch (c) {
+            case U'n': return U'\n';
+            case U't': return U'\t';
+            case U'r': return U'\r';
+            default: return c; // \\、\'、\" 及其他字符保持原样
             }
-            return *this;
-        }
-
-        // --- 重置 ---
-        void FormatSpec::Reset() noexcept {
-            if (impl)
-                *impl = FormatSpecImpl{};
-            else
-                impl = new FormatSpecImpl();
         }
 
         // --- Getter / Setter 实现 ---
-        int FormatSpec::GetIndex() const noexcept { return impl->index; }
-        void FormatSpec::SetIndex(int idx, bool explicitIdx) {
-            impl->index = idx;
-            impl->explicitIndex = explicitIdx;
+        int FormatSpec::GetIndex() const noexcept { return m_index; }
+        void FormatSpec::SetIndex(int idx, bool explicitIdx) noexcept {
+            m_index = idx;
+            if (explicitIdx) m_flags |= ExplicitIndex;
+            else m_flags &= ~ExplicitIndex;
         }
 
-        bool FormatSpec::HasExplicitIndex() const noexcept { return impl->explicitIndex; }
+        bool FormatSpec::HasExplicitIndex() const noexcept { return m_flags & ExplicitIndex; }
 
-        const String& FormatSpec::GetFill() const noexcept { return impl->fill; }
-        void FormatSpec::SetFill(const String& f) { impl->fill = f; }
+        String FormatSpec::GetFill() const {
+            if (!(m_flags & MultiCharFill)) return String(m_fill);
+            if (!m_source) return String();
 
-        char32_t FormatSpec::GetAlign() const noexcept { return impl->align; }
-        void FormatSpec::SetAlign(char32_t a) { impl->align = a; }
+            // 多字符填充：按需解析转义
+            std::u32string fill;
+            size_t end = static_cast<size_t>(m_fillText.offset) + m_fillText.length;
+            for (size_t i = m_fillText.offset; i < end; ++i) {
+                char32_t c = (*m_source)[i];
+                if (c == U'\\' && i + 1 < end) c = Unescape((*m_source)[++i]);
+                fill.push_back(c);
+            }
+            return String(fill);
+        }
+        char32_t FormatSpec::GetFillChar() const noexcept { return m_fill; }
+        bool FormatSpec::HasMultiCharFill() const noexcept { return m_flags & MultiCharFill; }
+        void FormatSpec::SetFill(char32_t fill) noexcept {
+            m_fill = fill;
+            m_flags &= ~MultiCharFill;
+        }
+        void FormatSpec::SetFill(TextRange quoted) noexcept {
+            m_fillText = quoted;
+            m_flags |= MultiCharFill;
+        }
+
+        char32_t FormatSpec::GetAlign() const noexcept { return m_align; }
+        void FormatSpec::SetAlign(char32_t a) noexcept { m_align = static_cast<uint8_t>(a); }
 
-        char32_t FormatSpec::GetSign() const noexcept { return impl->sign; }
-        void FormatSpec::SetSign(char32_t s) { impl->sign = s; }
+        char32_t FormatSpec::GetSign() const noexcept { return m_sign; }
+        void FormatSpec::SetSign(char32_t s) noexcept { m_sign = static_cast<uint8_t>(s); }
 
-        bool FormatSpec::GetAlternateForm() const noexcept { return impl->alternateForm; }
-        void FormatSpec::SetAlternateForm(bool show) { impl->alternateForm = show; }
+        bool FormatSpec::GetAlternateForm() const noexcept { return m_flags & AlternateForm; }
+        void FormatSpec::SetAlternateForm(bool show) noexcept {
+            if (show) m_flags |= AlternateForm;
+            else m_flags &= ~AlternateForm;
+        }
 
-        bool FormatSpec::GetZeroPad() const noexcept { return impl->zeroPad; }
-        void FormatSpec::SetZeroPad(bool zero) { impl->zeroPad = zero; }
+        bool FormatSpec::GetZeroPad() const noexcept { return m_flags & ZeroPad; }
+        void FormatSpec::SetZeroPad(bool zero) noexcept {
+            if (zero) m_flags |= ZeroPad;
+            else m_flags &= ~ZeroPad;
+        }
 
-        std::optional<int> FormatSpec::GetWidth() const noexcept { return impl->width; }
-        void FormatSpec::SetWidth(std::optional<int> w) { impl->width = std::move(w); }
+        std::optional<int> FormatSpec::GetWidth() const noexcept {
+            if (m_flags & HasWidth) return m_width;
+            return std::nullopt;
+        }
+        void FormatSpec::SetWidth(std::optional<int> w) noexcept {
+            m_width = w.value_or(0);
+            if (w) m_flags |= HasWidth;
+            else m_flags &= ~HasWidth;
+        }
 
-        std::optional<int> FormatSpec::GetPrecision() const noexcept { return impl->precision; }
-        void FormatSpec::SetPrecision(std::optional<int> p) { impl->precision = std::move(p); }
+        std::optional<int> FormatSpec::GetPrecision() const noexcept {
+            if (m_flags & HasPrecision) return m_precision;
+            return std::nullopt;
+        }
+        void FormatSpec::SetPrecision(std::optional<int> p) noexcept {
+            m_precision = p.value_or(0);
+            if (p) m_flags |= HasPrecision;
+            else m_flags &= ~HasPrecision;
+        }
 
-        char32_t FormatSpec::GetType() const noexcept { return impl->type; }
-        void FormatSpec::SetType(char32_t t) { impl->type = t; }
+        char32_t FormatSpec::GetType() const noexcept { return m_type; }
+        void FormatSpec::SetType(char32_t t) noexcept { m_type = static_cast<uint8_t>(t); }
 
-        const String& FormatSpec::GetTypeExpand() const noexcept { return impl->typeExpand; }
-        void FormatSpec::SetTypeExpand(const String& expand) { impl->typeExpand = expand; }
+        String FormatSpec::GetTypeExpand() const { return Slice(m_typeExpand); }
+        void FormatSpec::SetTypeExpand(TextRange expand) noexcept { m_typeExpand = expand; }
 
-        bool FormatSpec::IsValid() const noexcept { return impl->valid; }
-        void FormatSpec::SetValid(bool v) { impl->valid = v; }
+        bool FormatSpec::IsValid() const noexcept { return !(m_flags & Invalid); }
+        void FormatSpec::SetValid(bool v) noexcept {
+            if (v) m_flags &= ~Invalid;
+            else m_flags |= Invalid;
+        }
 
-        const String& FormatSpec::GetRaw() const noexcept { return impl->raw; }
-        void FormatSpec::SetRaw(const String& raw) { impl->raw = raw; }
+        String FormatSpec::GetRaw() const { return Slice(m_raw); }
+        void FormatSpec::SetRaw(TextRange raw) noexcept { m_raw = raw; }
 	}
 }
@@ -0,0 +1,252 @@
+﻿#include "../../../include/LikesProgram/stringFormat/FormatString.hpp"
+#include "../../../include/LikesProgram/String.hpp"
+#include "../../../include/LikesProgram/unicode/Convert.hpp"
+#include <atomic>
+#include <charconv>
+#include <cwchar>
+#include <stdexcept>
+#include <system_error>
+
+namespace LikesProgram {
+    namespace StringFormat {
+        namespace {
+            // 线程缓冲区超过该容量时在下次使用前收缩，避免偶发的大消息长期占用内存
+            constexpr size_t MaxRetainedBuffer = 64 * 1024;
+
+            std::atomic<bool> g_builtinOverridden{ false };
+
+            // 编码一个码点到 buffer（至少 4 字节），返回字节数
+            size_t EncodeUtf8(char32_t cp, char8_t* buffer) {
+                if (cp < 0x80) {
+                    buffer[0] = static_cast<char8_t>(cp);
+                    return 1;
+                }
+                if (cp < 0x800) {
+                    buffer[0] = static_cast<char8_t>(0xC0 | (cp >> 6));
+                    buffer[1] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+                    return 2;
+                }
+                if (cp < 0x10000) {
+                    buffer[0] = static_cast<char8_t>(0xE0 | (cp >> 12));
+                    buffer[1] = static_cast<char8_t>(0x80 | ((cp >> 6) & 0x3F));
+                    buffer[2] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+                    return 3;
+                }
+                buffer[0] = static_cast<char8_t>(0xF0 | (cp >> 18));
+                buffer[1] = static_cast<char8_t>(0x80 | ((cp >> 12) & 0x3F));
+                buffer[2] = static_cast<char8_t>(0x80 | ((cp >> 6) & 0x3F));
+                buffer[3] = static_cast<char8_t>(0x80 | (cp & 0x3F));
+                return 4;
+            }
+
+            void AppendUtf8(std::u8string& out, char32_t cp) {
+                char8_t buffer[4];
+                out.append(buffer, EncodeUtf8(cp, buffer));
+            }
+
+            // 校验 UTF-8 序列，返回首个非法位置（合法时返回 length）
+            size_t ValidateUtf8(const char8_t* s, size_t length) {
+                size_t i = 0;
+                while (i < length) {
+                    char8_t c = s[i];
+                    if (c < 0x80) { ++i; continue; }
+                    size_t len = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+                    if (len == 0 || i + len > length) return i;
+                    char32_t cp = c & (0xFF >> (len + 1));
+                    for (size_t j = 1; j < len; ++j) {
+                        if ((s[i + j] & 0xC0) != 0x80) return i;
+                        cp = (cp << 6) | (s[i + j] & 0x3F);
+                    }
+                    if ((len == 2 && cp < 0x80) || (len == 3 && cp < 0x800) || (len == 4 && cp < 0x10000) ||
+                        cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return i;
+                    i += len;
+                }
+                return length;
+            }
+
+            // 宽度按 wchar_t 单元计算（与 FormatInternal::ApplyAlignmentAndFill 一致）
+            size_t WideLength(const char8_t* s, size_t length) {
+                size_t units = 0;
+                for (size_t i = 0; i < length; ++i) {
+                    char8_t c = s[i];
+                    if ((c & 0xC0) != 0x80) ++units;
+                    if constexpr (sizeof(wchar_t) == 2) {
+                        if ((c & 0xF8) == 0xF0) ++units; // 代理对
+                    }
+                }
+                return units;
+            }
+        }
+
+        void WriteUnsigned(std::u8string& out, unsigned long long value, const CompiledToken& spec) {
+            char buffer[72];
+            char* p = buffer;
+            int base = 10;
+            switch (spec.type) {
+            case u8'x': case u8'X': base = 16; break;
+            case u8'b': case u8'B': base = 2; break;
+            case u8'o': case u8'O': base = 8; break;
+            default: break;
+            }
+            if (spec.alternateForm && base != 10) {
+                *p++ = '0';
+                *p++ = static_cast<char>(spec.type);
+            }
+            auto result = std::to_chars(p, buffer + sizeof(buffer), value, base);
+            if (spec.type == u8'X') {
+                for (char* c = p; c != result.ptr; ++c) if (*c >= 'a' && *c <= 'f') *c = static_cast<char>(*c - 'a' + 'A');
+            }
+            out.append(reinterpret_cast<const char8_t*>(buffer), static_cast<size_t>(result.ptr - buffer));
+        }
+
+        void WriteSigned(std::u8string& out, long long value, const CompiledToken& spec) {
+            switch (spec.type) {
+            case u8'x': case u8'X': case u8'b': case u8'B': case u8'o': case u8'O':
+                // 非十进制按补码输出（与 std::hex / std::oct 一致）
+                WriteUnsigned(out, static_cast<unsigned long long>(value), spec);
+                return;
+            default: break;
+            }
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(reinterpret_cast<const char8_t*>(buffer), static_cast<size_t>(result.ptr - buffer));
+        }
+
+        void WriteFloat(std::u8string& out, double value, const CompiledToken& spec) {
+            int precision = spec.hasPrecision ? spec.precision : 6;
+            std::chars_format format = std::chars_format::fixed;
+            switch (spec.type) {
+            case u8'e': case u8'E': format = std::chars_format::scientific; break;
+            case u8'g': case u8'G': format = std::chars_format::general; break;
+            case u8'%': value *= 100.0; break;
+            default: break;
+            }
+
+            char stackBuffer[128];
+            auto result = std::to_chars(stackBuffer, stackBuffer + sizeof(stackBuffer), value, format, precision);
+            if (result.ec == std::errc()) {
+                out.append(reinterpret_cast<const char8_t*>(stackBuffer), static_cast<size_t>(result.ptr - stackBuffer));
+            }
+            else {
+                // 大数值或高精度的定点输出超出栈缓冲区
+                std::string heapBuffer(static_cast<size_t>(precision) + 400, '\0');
+                result = std::to_chars(heapBuffer.data(), heapBuffer.data() + heapBuffer.size(), value, format, precision);
+                if (result.ec != std::errc()) throw std::runtime_error("WriteFloat: buffer too small");
+                out.append(reinterpret_cast<const char8_t*>(heapBuffer.data()), static_cast<size_t>(result.ptr - heapBuffer.data()));
+            }
+            if (spec.type == u8'%') out.push_back(u8'%');
+        }
+
+        void WritePointer(std::u8string& out, const void* value) {
+            constexpr char digits[] = "0123456789ABCDEF";
+            auto v = reinterpret_cast<std::uintptr_t>(value);
+            char buffer[2 + sizeof(void*) * 2] = { '0', 'x' };
+            for (size_t i = 0; i < sizeof(void*) * 2; ++i) {
+                buffer[sizeof(buffer) - 1 - i] = digits[v & 0xF];
+                v >>= 4;
+            }
+            out.append(reinterpret_cast<const char8_t*>(buffer), sizeof(buffer));
+        }
+
+        void WriteCodePoint(std::u8string& out, char32_t cp) {
+            if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) throw std::runtime_error("WriteCodePoint: invalid code point");
+            AppendUtf8(out, cp);
+        }
+
+        void WriteText(std::u8string& out, const char8_t* text, size_t length) {
+            if (ValidateUtf8(text, length) != length) throw std::runtime_error("WriteText: invalid UTF-8");
+            out.append(text, length);
+        }
+
+        void WriteText(std::u8string& out, const char* text, size_t length) {
+            WriteText(out, reinterpret_cast<const char8_t*>(text), length);
+        }
+
+        void WriteText(std::u8string& out, const char16_t* text, size_t length) {
+            if (length == 0) return;
+            size_t start = out.size();
+            out.resize(start + Unicode::Convert::MaxUtf8FromUtf16(length));
+            size_t written = Unicode::Convert::Utf16ToUtf8(text, length, out.data() + start, out.size() - start);
+            out.resize(start + written);
+        }
+
+        void WriteText(std::u8string& out, const char32_t* text, size_t length) {
+            for (size_t i = 0; i < length; ++i) WriteCodePoint(out, text[i]);
+        }
+
+        void WriteText(std::u8string& out, const wchar_t* text, size_t length) {
+            if constexpr (sizeof(wchar_t) == 2) WriteText(out, reinterpret_cast<const char16_t*>(text), length);
+            else WriteText(out, reinterpret_cast<const char32_t*>(text), length);
+        }
+
+        void WriteText(std::u8string& out, const String& text) {
+            text.AppendTo(out);
+        }
+
+        void ApplyAlignment(std::u8string& out, size_t start, const CompiledToken& spec) {
+            if (spec.width == 0) return;
+            size_t length = WideLength(out.data() + start, out.size() - start);
+            if (length >= spec.width) return;
+            size_t pad = spec.width - length;
+
+            // 零填充仅在右对齐时生效，直接补在最前面
+            if (spec.zeroPad && spec.align == u8'>') {
+                out.insert(start, pad, u8'0');
+                return;
+            }
+
+            char8_t fill[4];
+            size_t fillLength = EncodeUtf8(spec.fill, fill);
+
+            auto makePadding = [&](size_t count) {
+                std::u8string padding;
+                padding.reserve(count * fillLength);
+                for (size_t i = 0; i < count; ++i) padding.append(fill, fillLength);
+                return padding;
+            };
+
+            switch (spec.align) {
+            case u8'<':
+                if (fillLength == 1) out.append(pad, fill[0]);
+                else out.append(makePadding(pad));
+                break;
+            case u8'^': {
+                size_t left = pad / 2;
+                size_t right = pad - left;
+                if (fillLength == 1) {
+                    out.insert(start, left, fill[0]);
+                    out.append(right, fill[0]);
+                }
+                else {
+                    out.insert(start, makePadding(left));
+                    out.append(makePadding(right));
+                }
+                break;
+            }
+            default:
+                if (fillLength == 1) out.insert(start, pad, fill[0]);
+                else out.insert(start, makePadding(pad));
+                break;
+            }
+        }
+
+        std::u8string& ThreadFormatBuffer() {
+            thread_local std::u8string buffer;
+            if (buffer.capacity() > MaxRetainedBuffer) std::u8string().swap(buffer);
+            buffer.clear();
+            return buffer;
+        }
+
+        bool BuiltinFormattersOverridden() noexcept {
+            return g_builtinOverridden.load(std::memory_order_relaxed);
+        }
+
+        void MarkBuiltinFormattersOverridden() noexcept {
+            g_builtinOverridden.store(true, std::memory_order_relaxed);
+        }
+
+        void InvalidFormatString(const char* reason) {
+            throw std::invalid_argument(reason);
+        }
+    }
+}
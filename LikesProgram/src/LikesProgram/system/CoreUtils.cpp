@@ -25,10 +25,24 @@
 #include <random>
 #include <cinttypes>
 #include <thread>
+#include <memory>
 
 namespace LikesProgram {
     namespace CoreUtils {
+        namespace {
+            // 每隔多少次调用重新读取一次系统线程名（2 的幂），以发现绕过 SetCurrentThreadName 的改名
+            constexpr uint32_t ThreadNameRefreshInterval = 256;
+
+            // 当前线程名的共享副本（name 为空表示需要重新读取）；线程退出后由仍在引用它的日志消息释放
+            struct ThreadNameCache {
+                std::shared_ptr<const LikesProgram::String> name;
+                uint32_t calls = 0;
+            };
+            thread_local ThreadNameCache t_threadName;
+        }
+
         void SetCurrentThreadName(const LikesProgram::String& name) {
+            t_threadName.name.reset();
 #if defined(_WIN32)
             // Windows 10 1607+
             using SetThreadDescription_t = HRESULT(WINAPI*)(HANDLE, PCWSTR);
@@ -90,6 +104,16 @@ namespace LikesProgram {
 #endif
         }
 
+        const std::shared_ptr<const LikesProgram::String>& GetCurrentThreadNameShared() {
+            ThreadNameCache& cache = t_threadName;
+            if (cache.name && (++cache.calls & (ThreadNameRefreshInterval - 1)) != 0) return cache.name;
+
+            // 名称未变时沿用原副本，已入队的消息与后续消息共享同一个 String
+            LikesProgram::String current = GetCurrentThreadName();
+            if (!cache.name || *cache.name != current) cache.name = std::make_shared<const LikesProgram::String>(std::move(current));
+            return cache.name;
+        }
+
         LikesProgram::String GetMACAddress()
         {
             static LikesProgram::String cachedMAC;
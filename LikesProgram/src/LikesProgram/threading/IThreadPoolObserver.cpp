@@ -70,11 +70,15 @@ namespace LikesProgram {
     void ThreadPoolObserverBase::InitMetrics(const String& poolName, std::shared_ptr<Metrics::Registry> registry) {
         m_metrics.m_registry = registry;
         
-        m_metrics.m_submittedCount = std::make_shared<Metrics::Counter>(poolName + u"_submitted_total", u"Tasks submitted");
+        // 提交、完成、活跃任务数由所有工作线程高频更新，使用分散存储
+        m_metrics.m_submittedCount = std::make_shared<Metrics::Counter>(poolName + u"_submitted_total", u"Tasks submitted",
+            std::map<String, String>{}, Metrics::Storage::Striped);
         m_metrics.m_rejectedCount = std::make_shared<Metrics::Counter>(poolName + u"_rejected_total", u"Tasks rejected");
-        m_metrics.m_completedCount = std::make_shared<Metrics::Counter>(poolName + u"_completed_total", u"Tasks completed");
+        m_metrics.m_completedCount = std::make_shared<Metrics::Counter>(poolName + u"_completed_total", u"Tasks completed",
+            std::map<String, String>{}, Metrics::Storage::Striped);
 
-        m_metrics.m_activeTasks = std::make_shared<Metrics::Gauge>(poolName + u"_active_tasks", u"Active tasks");
+        m_metrics.m_activeTasks = std::make_shared<Metrics::Gauge>(poolName + u"_active_tasks", u"Active tasks",
+            std::map<String, String>{}, Metrics::Storage::Striped);
         m_metrics.m_aliveThreadsGauge = std::make_shared<Metrics::Gauge>(poolName + u"_alive_threads", u"Alive worker threads");
         m_metrics.m_queueSizeGauge = std::make_shared<Metrics::Gauge>(poolName + u"_queue_size", u"Current queue size");
         m_metrics.m_largestPoolGauge = std::make_shared<Metrics::Gauge>(poolName + u"_largest_pool_size", u"Largest pool size");
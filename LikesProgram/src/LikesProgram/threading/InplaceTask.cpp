@@ -0,0 +1,142 @@
+﻿#include "../../../include/LikesProgram/threading/InplaceTask.hpp"
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace LikesProgram {
+    namespace TaskPool {
+        namespace {
+            constexpr size_t SizeClasses[] = { 64, 128, 256, 512 };
+            constexpr size_t ClassCount = sizeof(SizeClasses) / sizeof(SizeClasses[0]);
+            constexpr size_t BatchSize = 128;        // 线程缓存与全局池之间每次交换的块数
+            constexpr size_t LocalLimit = BatchSize * 2; // 线程缓存上限，超过后归还一批
+
+            struct FreeBlock {
+                FreeBlock* next;
+            };
+
+            // 一批空闲块（单链表）
+            struct Batch {
+                FreeBlock* head;
+                size_t count;
+            };
+
+            // 全局池：只保存整批空闲块，加锁次数为每 BatchSize 次分配/释放一次
+            struct GlobalPool {
+                std::mutex mutex;
+                std::vector<Batch> batches[ClassCount];
+
+                void Push(size_t cls, Batch batch) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    batches[cls].push_back(batch);
+                }
+
+                bool Pop(size_t cls, Batch& batch) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (batches[cls].empty()) return false;
+                    batch = batches[cls].back();
+                    batches[cls].pop_back();
+                    return true;
+                }
+            };
+
+            GlobalPool& Global() {
+                static GlobalPool* pool = new GlobalPool(); // 不析构：线程退出时仍可能归还内存块
+                return *pool;
+            }
+
+            // 直接释放一批内存块
+            void FreeBatch(Batch batch) noexcept {
+                while (batch.head) {
+                    FreeBlock* next = batch.head->next;
+                    ::operator delete(batch.head);
+                    batch.head = next;
+                }
+            }
+
+            // 归还全局池，全局池扩容失败时直接释放
+            void ReturnBatch(size_t cls, Batch batch) noexcept {
+                try {
+                    Global().Push(cls, batch);
+                }
+                catch (...) {
+                    FreeBatch(batch);
+                }
+            }
+
+            // 本线程的缓存已析构（线程退出阶段），之后的分配/释放不再经过线程缓存
+            thread_local bool t_cacheTornDown = false;
+
+            // 线程缓存，线程退出时归还全局池
+            struct LocalCache {
+                Batch lists[ClassCount] = {};
+
+                ~LocalCache() {
+                    t_cacheTornDown = true;
+                    for (size_t cls = 0; cls < ClassCount; ++cls) {
+                        if (lists[cls].count > 0) ReturnBatch(cls, lists[cls]);
+                        lists[cls] = {};
+                    }
+                }
+            };
+
+            // 线程缓存已析构时返回 nullptr（如静态对象或其他 thread_local 对象析构时释放任务）
+            LocalCache* Local() noexcept {
+                if (t_cacheTornDown) return nullptr;
+                thread_local LocalCache cache;
+                return &cache;
+            }
+
+            size_t ClassOf(size_t bytes) noexcept {
+                for (size_t cls = 0; cls < ClassCount; ++cls) {
+                    if (bytes <= SizeClasses[cls]) return cls;
+                }
+                return ClassCount;
+            }
+        }
+
+        void* Allocate(size_t bytes) {
+            size_t cls = ClassOf(bytes);
+            if (cls == ClassCount) return ::operator new(bytes);
+
+            LocalCache* cache = Local();
+            if (!cache) return ::operator new(SizeClasses[cls]);
+            Batch& list = cache->lists[cls];
+            if (list.count == 0 && !Global().Pop(cls, list)) return ::operator new(SizeClasses[cls]);
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            --list.count;
+            return block;
+        }
+
+        void Deallocate(void* ptr, size_t bytes) noexcept {
+            if (!ptr) return;
+            size_t cls = ClassOf(bytes);
+            if (cls == ClassCount) {
+                ::operator delete(ptr);
+                return;
+            }
+
+            LocalCache* cache = Local();
+            if (!cache) {
+                ::operator delete(ptr); // 内存块均由 operator new 分配
+                return;
+            }
+            Batch& list = cache->lists[cls];
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = list.head;
+            list.head = block;
+            if (++list.count < LocalLimit) return;
+
+            // 缓存已满：拆出一批归还全局池
+            Batch batch{ list.head, BatchSize };
+            FreeBlock* tail = list.head;
+            for (size_t i = 1; i < BatchSize; ++i) tail = tail->next;
+            list.head = tail->next;
+            list.count -= BatchSize;
+            tail->next = nullptr;
+            ReturnBatch(cls, batch);
+        }
+    }
+}
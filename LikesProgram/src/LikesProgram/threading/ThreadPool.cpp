@@ -11,8 +11,9 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <algorithm>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <mutex>
@@ -35,6 +36,214 @@
 #endif
 
 namespace LikesProgram {
+    namespace {
+        using Task = InplaceTask;
+
+        // 共享队列模式的任务环形缓冲区：槽位复用，只在容量不足时成倍扩容，入队出队不分配内存
+        class TaskRing {
+        public:
+            size_t Size() const { return m_size; }
+            bool Empty() const { return m_size == 0; }
+
+            void PushBack(InplaceTask&& task) {
+                if (m_size == m_slots.size()) Grow();
+                m_slots[(m_head + m_size) & (m_slots.size() - 1)] = std::move(task);
+                ++m_size;
+            }
+
+            InplaceTask PopFront() {
+                InplaceTask task = std::move(m_slots[m_head]);
+                m_head = (m_head + 1) & (m_slots.size() - 1);
+                --m_size;
+                return task;
+            }
+
+            void Clear() {
+                while (m_size > 0) PopFront();
+            }
+
+        private:
+            void Grow() {
+                std::vector<InplaceTask> slots(m_slots.empty() ? 64 : m_slots.size() * 2);
+                for (size_t i = 0; i < m_size; ++i) slots[i] = std::move(m_slots[(m_head + i) & (m_slots.size() - 1)]);
+                m_slots.swap(slots);
+                m_head = 0;
+            }
+
+            std::vector<InplaceTask> m_slots; // 容量为 2 的幂
+            size_t m_head = 0;
+            size_t m_size = 0;
+        };
+
+        // 工作窃取模式的任务节点从任务内存池分配
+        Task* NewTaskNode(InplaceTask&& task) {
+            void* memory = TaskPool::Allocate(sizeof(Task));
+            return ::new (memory) Task(std::move(task));
+        }
+
+        void DeleteTaskNode(Task* task) noexcept {
+            task->~Task();
+            TaskPool::Deallocate(task, sizeof(Task));
+        }
+
+        // 有界无锁多生产者多消费者环形队列（Vyukov 算法），作为工作窃取模式的全局注入队列
+        class InjectionQueue {
+        public:
+            explicit InjectionQueue(size_t capacity) {
+                size_t size = 2;
+                while (size < capacity) size <<= 1;
+                m_mask = size - 1;
+                m_cells = std::make_unique<Cell[]>(size);
+                for (size_t i = 0; i < size; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            // 队列已满时返回 false
+            bool TryPush(Task* task) {
+                size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+                for (;;) {
+                    Cell& cell = m_cells[pos & m_mask];
+                    size_t seq = cell.sequence.load(std::memory_order_acquire);
+                    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                    if (diff == 0) {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            cell.task = task;
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // 队列为空时返回 nullptr
+            Task* TryPop() {
+                size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+                for (;;) {
+                    Cell& cell = m_cells[pos & m_mask];
+                    size_t seq = cell.sequence.load(std::memory_order_acquire);
+                    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                    if (diff == 0) {
+                        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            Task* task = cell.task;
+                            cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                            return task;
+                        }
+                    }
+                    else if (diff < 0) {
+                        return nullptr;
+                    }
+                    else {
+                        pos = m_dequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+        private:
+            struct Cell {
+                std::atomic<size_t> sequence{ 0 };
+                Task* task = nullptr;
+            };
+
+            std::unique_ptr<Cell[]> m_cells;
+            size_t m_mask = 0;
+            alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+            alignas(64) std::atomic<size_t> m_dequeuePos{ 0 };
+        };
+
+        // Chase-Lev 工作窃取双端队列：拥有者在底部 Push/Pop（LIFO），其他线程从顶部 Steal（FIFO）
+        // 满时扩容为两倍，旧数组保留到队列销毁（窃取者可能仍在读取）
+        class WorkStealingDeque {
+        public:
+            WorkStealingDeque() {
+                m_rings.push_back(std::make_unique<Ring>(256));
+                m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+            }
+
+            // 仅拥有者调用
+            void Push(Task* task) {
+                int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+                int64_t top = m_top.load(std::memory_order_acquire);
+                Ring* ring = m_ring.load(std::memory_order_relaxed);
+                if (bottom - top > ring->capacity - 1) {
+                    m_rings.push_back(ring->Grow(bottom, top));
+                    ring = m_rings.back().get();
+                    m_ring.store(ring, std::memory_order_release);
+                }
+                ring->Put(bottom, task);
+                m_bottom.store(bottom + 1, std::memory_order_release); // 发布任务，与 Steal 中读取 m_bottom 的 acquire 配对
+            }
+
+            // 仅拥有者调用，队列为空时返回 nullptr
+            Task* Pop() {
+                int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+                Ring* ring = m_ring.load(std::memory_order_relaxed);
+                m_bottom.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t top = m_top.load(std::memory_order_relaxed);
+                if (top > bottom) { // 空
+                    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                Task* task = ring->Get(bottom);
+                if (top == bottom) { // 最后一个元素，与窃取者竞争
+                    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) task = nullptr;
+                    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+                return task;
+            }
+
+            // 任意线程调用，队列为空或竞争失败时返回 nullptr
+            Task* Steal() {
+                int64_t top = m_top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t bottom = m_bottom.load(std::memory_order_acquire);
+                if (top >= bottom) return nullptr;
+                Task* task = m_ring.load(std::memory_order_acquire)->Get(top);
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+                return task;
+            }
+
+            bool Empty() const {
+                return m_top.load(std::memory_order_acquire) >= m_bottom.load(std::memory_order_acquire);
+            }
+
+        private:
+            struct Ring {
+                int64_t capacity;
+                std::unique_ptr<std::atomic<Task*>[]> slots;
+
+                explicit Ring(int64_t capacity) : capacity(capacity), slots(std::make_unique<std::atomic<Task*>[]>(static_cast<size_t>(capacity))) {}
+                Task* Get(int64_t i) const { return slots[static_cast<size_t>(i & (capacity - 1))].load(std::memory_order_relaxed); }
+                void Put(int64_t i, Task* task) { slots[static_cast<size_t>(i & (capacity - 1))].store(task, std::memory_order_relaxed); }
+                std::unique_ptr<Ring> Grow(int64_t bottom, int64_t top) const {
+                    auto ring = std::make_unique<Ring>(capacity * 2);
+                    for (int64_t i = top; i < bottom; ++i) ring->Put(i, Get(i));
+                    return ring;
+                }
+            };
+
+            alignas(64) std::atomic<int64_t> m_top{ 0 };
+            alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+            std::atomic<Ring*> m_ring{ nullptr };
+            std::vector<std::unique_ptr<Ring>> m_rings; // 仅拥有者修改
+        };
+
+        // 工作窃取模式下每个工作线程占用一个槽位，线程退出后槽位可被新线程复用（队列中剩余任务仍可被窃取）
+        struct WorkerSlot {
+            WorkStealingDeque deque;
+            std::atomic<bool> owned{ false };
+        };
+
+        // 当前线程所属的线程池与槽位，用于把工作线程内提交的任务放入本地队列
+        thread_local const void* t_currentPool = nullptr;
+        thread_local WorkerSlot* t_currentSlot = nullptr;
+    }
+
     struct ThreadPool::ThreadPoolImpl {
         Options opts_;
 
@@ -42,7 +251,7 @@ namespace LikesProgram {
         mutable std::mutex queueMutex_;
         std::condition_variable queueNotEmptyCv_; // 通知 worker
         std::condition_variable queueNotFullCv_;  // 通知 submit 等待
-        std::deque<std::function<void()>> taskQueue_; // 任务队列
+        TaskRing taskQueue_; // 任务队列
         size_t queueCapacity_ = 1000; // 队列容量
 
         // 工作线程容器（保持到最终join；活跃数用 m_aliveThreads 统计）
@@ -54,8 +263,6 @@ namespace LikesProgram {
         std::atomic<bool> acceptTasks_{ false };   // 是否接受新任务（入队）
         std::atomic<bool> shutdownNowFlag_{ false }; // 用于唤醒空闲 worker 退出（shutdown）
 
-        Time::Timer timer_;
-
         // 统计
         std::atomic<size_t> m_submittedCount{ 0 };  // 成功入队的任务数
         std::atomic<size_t> m_rejectedCount{ 0 };   // 被拒绝的任务数
@@ -75,6 +282,66 @@ namespace LikesProgram {
         // 线程退出等待
         mutable std::mutex workerExitMutex_;
         std::condition_variable workerExitCv_;
+
+        // 工作窃取调度（m_queueSize 为注入队列与各本地队列中的任务总数，入队前先占位）
+        bool workStealing_ = false;
+        std::unique_ptr<InjectionQueue> injection_;
+        std::vector<std::unique_ptr<WorkerSlot>> slots_;
+        std::mutex stealMutex_;
+        std::condition_variable stealCv_;            // 唤醒空闲 worker
+        std::atomic<size_t> m_sleepingWorkers{ 0 };  // 在 stealCv_ 上等待的 worker 数
+        std::atomic<size_t> m_blockedSubmitters{ 0 }; // Block 策略下等待空位的提交者数
+
+        // 取出最早入队的任务（注入队列优先，其次各本地队列顶部）
+        Task* TakeOldest() {
+            if (Task* task = injection_->TryPop()) return task;
+            for (auto& slot : slots_) {
+                if (Task* task = slot->deque.Steal()) return task;
+            }
+            return nullptr;
+        }
+
+        // 取任务：本地队列 → 注入队列 → 从随机位置开始窃取其他队列
+        Task* FindTask(WorkerSlot* own, uint64_t& rng) {
+            if (own) {
+                if (Task* task = own->deque.Pop()) return task;
+            }
+            if (Task* task = injection_->TryPop()) return task;
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            size_t count = slots_.size();
+            size_t start = count ? static_cast<size_t>(rng % count) : 0;
+            for (size_t i = 0; i < count; ++i) {
+                WorkerSlot* victim = slots_[(start + i) % count].get();
+                if (victim == own) continue;
+                if (Task* task = victim->deque.Steal()) return task;
+            }
+            return nullptr;
+        }
+
+        // 清空所有队列，返回丢弃的任务数
+        size_t DropStealingTasks() {
+            size_t dropped = 0;
+            bool found = true;
+            while (found) {
+                found = false;
+                while (Task* task = TakeOldest()) {
+                    DeleteTaskNode(task);
+                    m_queueSize.fetch_sub(1, std::memory_order_acq_rel);
+                    ++dropped;
+                    found = true;
+                }
+                for (auto& slot : slots_) {
+                    if (!slot->deque.Empty()) found = true; // 窃取竞争失败，再试一次
+                }
+            }
+            return dropped;
+        }
+
+        ~ThreadPoolImpl() {
+            if (injection_) DropStealingTasks();
+        }
     };
 
     String ThreadPool::Statistics::ToString() const {
@@ -104,8 +371,14 @@ namespace LikesProgram {
         m_impl->m_observer = observer;
         m_impl->opts_ = std::move(opts);
         m_impl->queueCapacity_ = opts.queueCapacity;
-        m_impl->timer_ = Time::Timer();
         m_impl->opts_.threadNamePrefix = m_impl->opts_.threadNamePrefix.SubString(0, 15 - 5);
+
+        if (m_impl->opts_.scheduler == Scheduler::WorkStealing) {
+            m_impl->workStealing_ = true;
+            m_impl->injection_ = std::make_unique<InjectionQueue>(m_impl->queueCapacity_);
+            size_t slotCount = (std::max)(m_impl->opts_.coreThreads, m_impl->opts_.maxThreads);
+            for (size_t i = 0; i < slotCount; ++i) m_impl->slots_.push_back(std::make_unique<WorkerSlot>());
+        }
     }
 
     ThreadPool::~ThreadPool() {
@@ -158,9 +431,11 @@ namespace LikesProgram {
             m_impl->shutdownNowFlag_.store(true, std::memory_order_release);
             {
                 std::lock_guard<std::mutex> lk(m_impl->queueMutex_);
-                m_impl->m_rejectedCount.fetch_add(m_impl->taskQueue_.size(), std::memory_order_relaxed);
-                m_impl->m_observer->OnTaskRejected();
-                m_impl->taskQueue_.clear();
+                size_t dropped = m_impl->taskQueue_.Size();
+                if (m_impl->workStealing_) dropped += m_impl->DropStealingTasks();
+                m_impl->m_rejectedCount.fetch_add(dropped, std::memory_order_relaxed);
+                if (m_impl->m_observer) m_impl->m_observer->OnTaskRejected();
+                m_impl->taskQueue_.Clear();
             }
             break;
         }
@@ -179,14 +454,15 @@ namespace LikesProgram {
     }
 
     bool ThreadPool::PostNoArg(std::function<void()> fn) {
-        bool success = EnqueueTask(std::move(fn));
+        bool success = EnqueueTask(InplaceTask(std::move(fn)));
         if (!success && m_impl->opts_.exceptionHandler) m_impl->opts_.exceptionHandler(std::make_exception_ptr(std::runtime_error("Task rejected")));
         return success;
     }
 
     size_t ThreadPool::GetQueueSize() const {
+        if (m_impl->workStealing_) return m_impl->m_queueSize.load(std::memory_order_acquire);
         std::lock_guard<std::mutex> lk(m_impl->queueMutex_);
-        return m_impl->taskQueue_.size();
+        return m_impl->taskQueue_.Size();
     }
 
     size_t ThreadPool::GetActiveCount() const {
@@ -248,40 +524,41 @@ namespace LikesProgram {
         m_impl->workers_.clear();
     }
 
-    bool ThreadPool::EnqueueTask(std::function<void()>&& task) {
+    bool ThreadPool::EnqueueTask(InplaceTask&& task) {
         if (!m_impl->running_.load(std::memory_order_acquire) || !m_impl->acceptTasks_.load(std::memory_order_acquire)) {
             m_impl->m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
-            m_impl->m_observer->OnTaskRejected();
+            if (m_impl->m_observer) m_impl->m_observer->OnTaskRejected();
             return false;
         }
+        if (m_impl->workStealing_) return EnqueueStealing(std::move(task));
 
         std::unique_lock<std::mutex> lock(m_impl->queueMutex_);
 
-        if (m_impl->taskQueue_.size() >= m_impl->queueCapacity_) {
+        if (m_impl->taskQueue_.Size() >= m_impl->queueCapacity_) {
             switch (m_impl->opts_.rejectPolicy) {
             case RejectPolicy::Block:
                 m_impl->queueNotFullCv_.wait(lock, [&] {
-                    return m_impl->taskQueue_.size() < m_impl->queueCapacity_ || !m_impl->acceptTasks_.load(std::memory_order_acquire) || m_impl->shutdownNowFlag_.load(std::memory_order_acquire);
+                    return m_impl->taskQueue_.Size() < m_impl->queueCapacity_ || !m_impl->acceptTasks_.load(std::memory_order_acquire) || m_impl->shutdownNowFlag_.load(std::memory_order_acquire);
                     });
                 if (!m_impl->running_.load(std::memory_order_acquire) || !m_impl->acceptTasks_.load(std::memory_order_acquire) || m_impl->shutdownNowFlag_.load(std::memory_order_acquire)) {
                     m_impl->m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
-                    m_impl->m_observer->OnTaskRejected();
+                    if (m_impl->m_observer) m_impl->m_observer->OnTaskRejected();
                     return false;
                 }
                 break;
             case RejectPolicy::Discard:
                 m_impl->m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
-                m_impl->m_observer->OnTaskRejected();
+                if (m_impl->m_observer) m_impl->m_observer->OnTaskRejected();
                 return false;
             case RejectPolicy::DiscardOld:
-                if (!m_impl->taskQueue_.empty()) m_impl->taskQueue_.pop_front();
+                if (!m_impl->taskQueue_.Empty()) m_impl->taskQueue_.PopFront();
                 break;
             case RejectPolicy::Throw:
                 throw std::runtime_error("ThreadPool: Task rejected (Throw policy)");
             }
         }
 
-        m_impl->taskQueue_.emplace_back(std::move(task));
+        m_impl->taskQueue_.PushBack(std::move(task));
         m_impl->m_submittedCount.fetch_add(1, std::memory_order_relaxed);
 
         // 记录最近一次提交时间（统一使用纳秒）
@@ -289,7 +566,7 @@ namespace LikesProgram {
         m_impl->m_lastSubmitNs.store(now_ns, std::memory_order_relaxed);
 
         // 峰值队列
-        const size_t qsz = m_impl->taskQueue_.size();
+        const size_t qsz = m_impl->taskQueue_.Size();
         Math::UpdateMax(m_impl->m_peakQueueSize, qsz);
 
         // 更新统计信息
@@ -307,6 +584,80 @@ namespace LikesProgram {
         return true;
     }
 
+    bool ThreadPool::EnqueueStealing(InplaceTask&& task) {
+        ThreadPoolImpl& impl = *m_impl;
+        auto reject = [&impl]() {
+            impl.m_rejectedCount.fetch_add(1, std::memory_order_relaxed);
+            if (impl.m_observer) impl.m_observer->OnTaskRejected();
+            return false;
+        };
+
+        // 先占位再入队，保证队列总数不超过容量（注入队列因此不会写满）
+        size_t qsz = impl.m_queueSize.fetch_add(1, std::memory_order_seq_cst) + 1;
+        while (qsz > impl.queueCapacity_) {
+            impl.m_queueSize.fetch_sub(1, std::memory_order_seq_cst);
+            switch (impl.opts_.rejectPolicy) {
+            case RejectPolicy::Block: {
+                std::unique_lock<std::mutex> lock(impl.queueMutex_);
+                impl.m_blockedSubmitters.fetch_add(1, std::memory_order_seq_cst);
+                impl.queueNotFullCv_.wait(lock, [&] {
+                    return impl.m_queueSize.load(std::memory_order_seq_cst) < impl.queueCapacity_ || !impl.acceptTasks_.load(std::memory_order_acquire) || impl.shutdownNowFlag_.load(std::memory_order_acquire);
+                    });
+                impl.m_blockedSubmitters.fetch_sub(1, std::memory_order_relaxed);
+                if (!impl.running_.load(std::memory_order_acquire) || !impl.acceptTasks_.load(std::memory_order_acquire) || impl.shutdownNowFlag_.load(std::memory_order_acquire)) {
+                    return reject();
+                }
+                break;
+            }
+            case RejectPolicy::Discard:
+                return reject();
+            case RejectPolicy::DiscardOld:
+                if (Task* old = impl.TakeOldest()) {
+                    DeleteTaskNode(old);
+                    impl.m_queueSize.fetch_sub(1, std::memory_order_seq_cst);
+                }
+                break;
+            case RejectPolicy::Throw:
+                throw std::runtime_error("ThreadPool: Task rejected (Throw policy)");
+            }
+            qsz = impl.m_queueSize.fetch_add(1, std::memory_order_seq_cst) + 1;
+        }
+
+        Task* node = NewTaskNode(std::move(task));
+        if (t_currentPool == m_impl && t_currentSlot) {
+            t_currentSlot->deque.Push(node); // 工作线程内提交：留在本地队列
+        }
+        else {
+            while (!impl.injection_->TryPush(node)) std::this_thread::yield(); // 出队方尚未释放槽位
+        }
+        impl.m_submittedCount.fetch_add(1, std::memory_order_relaxed);
+
+        // 记录最近一次提交时间（统一使用纳秒）
+        auto now_ns = std::chrono::duration_cast<Time::Nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        impl.m_lastSubmitNs.store(now_ns, std::memory_order_relaxed);
+
+        // 峰值队列
+        Math::UpdateMax(impl.m_peakQueueSize, qsz);
+
+        // 更新统计信息
+        if (impl.m_observer) impl.m_observer->OnTaskSubmitted((double)qsz);
+
+        // 有空闲 worker 时唤醒一个
+        if (impl.m_sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lk(impl.stealMutex_);
+            impl.stealCv_.notify_one();
+        }
+
+        // 动态扩容：队列长度 > 活跃线程数 且还没到 maxThreads
+        if (impl.opts_.allowDynamicResize && impl.running_.load(std::memory_order_acquire)) {
+            size_t alive = impl.m_aliveThreads.load(std::memory_order_acquire);
+            if (alive < impl.opts_.maxThreads && qsz > alive) {
+                SpawnWorker();
+            }
+        }
+        return true;
+    }
+
     void ThreadPool::WorkerLoop() {
         // 线程命名（可选）
         if (!m_impl->opts_.threadNamePrefix.Empty()) {
@@ -329,17 +680,32 @@ namespace LikesProgram {
             CoreUtils::SetCurrentThreadName(threadName);
         }
 
+        if (m_impl->workStealing_) WorkStealingLoop();
+        else SharedQueueLoop();
+
+        // 线程退出
+        {
+            std::lock_guard<std::mutex> lk(m_impl->workerExitMutex_);
+            auto prev = m_impl->m_aliveThreads.load(std::memory_order_acquire);
+            m_impl->m_aliveThreads.store((prev > 0 ? prev - 1 : 0), std::memory_order_release);
+            // 更新统计信息
+            if (m_impl->m_observer) m_impl->m_observer->OnThreadCountRemoved();
+            if (m_impl->m_aliveThreads.load(std::memory_order_acquire) == 0) m_impl->workerExitCv_.notify_all();
+        }
+    }
+
+    void ThreadPool::SharedQueueLoop() {
         auto tryExit = [this]() -> bool {
             if (m_impl->shutdownNowFlag_.load(std::memory_order_acquire)) return true;
             if (!m_impl->running_.load(std::memory_order_acquire)) {
                 std::lock_guard<std::mutex> lk(m_impl->queueMutex_);
-                return m_impl->taskQueue_.empty(); // drain 完队列即可退出
+                return m_impl->taskQueue_.Empty(); // drain 完队列即可退出
             }
             return false;
         };
 
         while (true) {
-            std::function<void()> task;
+            InplaceTask task;
 
             {
                 std::unique_lock<std::mutex> lock(m_impl->queueMutex_);
@@ -347,7 +713,7 @@ namespace LikesProgram {
                 if (!m_impl->shutdownNowFlag_.load(std::memory_order_acquire)) {
                     // 空闲等待，带 keepAlive，用于缩容
                     m_impl->queueNotEmptyCv_.wait_for(lock, m_impl->opts_.keepAlive, [&] {
-                        return !m_impl->taskQueue_.empty() || m_impl->shutdownNowFlag_.load(std::memory_order_acquire) || !m_impl->running_.load(std::memory_order_acquire);
+                        return !m_impl->taskQueue_.Empty() || m_impl->shutdownNowFlag_.load(std::memory_order_acquire) || !m_impl->running_.load(std::memory_order_acquire);
                     });
                 }
 
@@ -355,55 +721,111 @@ namespace LikesProgram {
                 if (m_impl->shutdownNowFlag_.load(std::memory_order_acquire)) break;
 
                 // Graceful/Drain：队列空且不再运行 -> 退出
-                if (!m_impl->running_.load(std::memory_order_acquire) && m_impl->taskQueue_.empty()) break;
+                if (!m_impl->running_.load(std::memory_order_acquire) && m_impl->taskQueue_.Empty()) break;
 
                 // 动态缩容：超时空闲且线程数超过 core -> 退出
-                if (m_impl->taskQueue_.empty() && m_impl->opts_.allowDynamicResize && m_impl->m_aliveThreads.load(std::memory_order_acquire) > m_impl->opts_.coreThreads) {
+                if (m_impl->taskQueue_.Empty() && m_impl->opts_.allowDynamicResize && m_impl->m_aliveThreads.load(std::memory_order_acquire) > m_impl->opts_.coreThreads) {
                     break;
                 }
 
                 // 获取任务
-                if (!m_impl->taskQueue_.empty()) {
-                    task = std::move(m_impl->taskQueue_.front());
-                    m_impl->taskQueue_.pop_front();
+                if (!m_impl->taskQueue_.Empty()) {
+                    task = m_impl->taskQueue_.PopFront();
                     m_impl->queueNotFullCv_.notify_one();
                 }
             }
 
-            if (task) {
-                m_impl->m_activeTasks.fetch_add(1, std::memory_order_relaxed);
-                // 更新统计信息
-                if (m_impl->m_observer) m_impl->m_observer->OnTaskStarted();
-                Time::Timer timer(true, &m_impl->timer_);
-                try {
-                    task();
-                }
-                catch (...) {
-                    if (m_impl->opts_.exceptionHandler) {
-                        try { m_impl->opts_.exceptionHandler(std::current_exception()); }
-                        catch (...) {} // 回调自己异常也吞掉，避免杀死worker
-                    }
+            if (task) RunTask(task);
+
+            if (tryExit()) break;
+        }
+    }
+
+    void ThreadPool::WorkStealingLoop() {
+        ThreadPoolImpl& impl = *m_impl;
+
+        // 占用一个空闲槽位；线程数超过槽位数时只从注入队列取任务和窃取
+        WorkerSlot* own = nullptr;
+        for (auto& slot : impl.slots_) {
+            bool expected = false;
+            if (slot->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                own = slot.get();
+                break;
+            }
+        }
+        t_currentPool = m_impl;
+        t_currentSlot = own;
+
+        uint64_t rng = reinterpret_cast<std::uintptr_t>(&own) | 1; // 窃取起点的随机种子
+        int idleSpins = 0;
+        while (!impl.shutdownNowFlag_.load(std::memory_order_acquire)) {
+            if (Task* task = impl.FindTask(own, rng)) {
+                impl.m_queueSize.fetch_sub(1, std::memory_order_seq_cst);
+                if (impl.m_blockedSubmitters.load(std::memory_order_seq_cst) > 0) {
+                    std::lock_guard<std::mutex> lk(impl.queueMutex_);
+                    impl.queueNotFullCv_.notify_one();
                 }
+                RunTask(*task);
+                DeleteTaskNode(task);
+                idleSpins = 0;
+                continue;
+            }
+
+            // Graceful/Drain：队列空且不再运行 -> 退出
+            if (!impl.running_.load(std::memory_order_acquire) && impl.m_queueSize.load(std::memory_order_acquire) == 0) break;
 
-                m_impl->m_completedCount.fetch_add(1, std::memory_order_relaxed);
-                m_impl->m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
-                auto now_ns = std::chrono::duration_cast<Time::Nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-                m_impl->m_lastFinishNs.store(now_ns, std::memory_order_relaxed);
-                // 更新统计信息
-                if (m_impl->m_observer) m_impl->m_observer->OnTaskCompleted(timer.Stop(), (double)m_impl->taskQueue_.size());
+            // 短暂让出 CPU，任务可能已占位但尚未写入队列
+            if (++idleSpins < 64) {
+                std::this_thread::yield();
+                continue;
             }
+            idleSpins = 0;
 
-            if (tryExit()) break;
+            bool woken;
+            {
+                std::unique_lock<std::mutex> lock(impl.stealMutex_);
+                impl.m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+                // 空闲等待，带 keepAlive，用于缩容
+                woken = impl.stealCv_.wait_for(lock, impl.opts_.keepAlive, [&] {
+                    return impl.m_queueSize.load(std::memory_order_seq_cst) > 0 || impl.shutdownNowFlag_.load(std::memory_order_acquire) || !impl.running_.load(std::memory_order_acquire);
+                    });
+                impl.m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            // 动态缩容：超时空闲且线程数超过 core -> 退出
+            if (!woken && impl.opts_.allowDynamicResize && impl.m_aliveThreads.load(std::memory_order_acquire) > impl.opts_.coreThreads) {
+                break;
+            }
         }
 
-        // 线程退出
-        {
-            std::lock_guard<std::mutex> lk(m_impl->workerExitMutex_);
-            auto prev = m_impl->m_aliveThreads.load(std::memory_order_acquire);
-            m_impl->m_aliveThreads.store((prev > 0 ? prev - 1 : 0), std::memory_order_release);
-            // 更新统计信息
-            if (m_impl->m_observer) m_impl->m_observer->OnThreadCountRemoved();
-            if (m_impl->m_aliveThreads.load(std::memory_order_acquire) == 0) m_impl->workerExitCv_.notify_all();
+        t_currentPool = nullptr;
+        t_currentSlot = nullptr;
+        if (own) own->owned.store(false, std::memory_order_release);
+    }
+
+    void ThreadPool::RunTask(InplaceTask& task) {
+        m_impl->m_activeTasks.fetch_add(1, std::memory_order_relaxed);
+        // 更新统计信息
+        if (m_impl->m_observer) m_impl->m_observer->OnTaskStarted();
+        uint64_t startNs = m_impl->m_observer ? Time::Timer::NowNs() : 0; // 只记录起点，避免每个任务构造 Timer
+        try {
+            task();
+        }
+        catch (...) {
+            if (m_impl->opts_.exceptionHandler) {
+                try { m_impl->opts_.exceptionHandler(std::current_exception()); }
+                catch (...) {} // 回调自己异常也吞掉，避免杀死worker
+            }
+        }
+
+        m_impl->m_completedCount.fetch_add(1, std::memory_order_relaxed);
+        m_impl->m_activeTasks.fetch_sub(1, std::memory_order_relaxed);
+        auto now_ns = std::chrono::duration_cast<Time::Nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        m_impl->m_lastFinishNs.store(now_ns, std::memory_order_relaxed);
+        // 更新统计信息
+        if (m_impl->m_observer) {
+            size_t queued = m_impl->workStealing_ ? m_impl->m_queueSize.load(std::memory_order_relaxed) : m_impl->taskQueue_.Size();
+            m_impl->m_observer->OnTaskCompleted(Time::Nanoseconds(Time::Timer::NowNs() - startNs), (double)queued);
         }
     }
 
@@ -427,6 +849,10 @@ namespace LikesProgram {
     void ThreadPool::NotifyAllWorkers() {
         m_impl->queueNotEmptyCv_.notify_all();
         m_impl->queueNotFullCv_.notify_all();
+        if (m_impl->workStealing_) {
+            std::lock_guard<std::mutex> lk(m_impl->stealMutex_);
+            m_impl->stealCv_.notify_all();
+        }
     }
     std::function<void(std::exception_ptr)> ThreadPool::GetExceptionHandler() const {
         return m_impl->opts_.exceptionHandler;
@@ -1,20 +1,36 @@
 ﻿#include "../../../include/LikesProgram/unicode/Convert.hpp"
 #include <stdexcept>
+#include <bit>
+#include <cstring>
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <iconv.h>
 #include <cerrno>
 #endif
+
+// x86 平台启用 SSE2/AVX2 内核（运行时按 CPU 能力选择）
+#if defined(__x86_64__) || defined(_M_X64) || ((defined(__i386__) || defined(_M_IX86)) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define LIKESPROGRAM_UNICODE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LIKESPROGRAM_TARGET_AVX2
+#else
+#define LIKESPROGRAM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 namespace LikesProgram {
     namespace Unicode {
         namespace Convert {
-            std::u16string Utf8ToUtf16(const std::u8string& utf8) {
-                std::u16string result;
-                size_t i = 0;
-                while (i < utf8.size()) {
+            namespace {
+                // ---- 标量单序列处理（非 ASCII 路径及块尾部共用） ----
+
+                // 解码 in[i] 开始的一个 UTF-8 序列并写入 UTF-16
+                inline void Utf8SequenceToUtf16(const char8_t* in, size_t length, size_t& i, char16_t* out, size_t& o) {
                     uint32_t codepoint = 0;
-                    unsigned char c = static_cast<unsigned char>(utf8[i]);
+                    unsigned char c = static_cast<unsigned char>(in[i]);
                     size_t extraBytes = 0;
 
                     if (c <= 0x7F) {
@@ -37,11 +53,11 @@ namespace LikesProgram {
                         throw std::runtime_error("Invalid UTF-8 lead byte");
                     }
 
-                    if (i + extraBytes >= utf8.size())
+                    if (i + extraBytes >= length)
                         throw std::runtime_error("Unexpected end of UTF-8 string");
 
                     for (size_t j = 1; j <= extraBytes; ++j) {
-                        unsigned char cont = static_cast<unsigned char>(utf8[i + j]);
+                        unsigned char cont = static_cast<unsigned char>(in[i + j]);
                         if ((cont & 0xC0) != 0x80)
                             throw std::runtime_error("Invalid UTF-8 continuation byte");
                         codepoint = (codepoint << 6) | (cont & 0x3F);
@@ -49,12 +65,12 @@ namespace LikesProgram {
 
                     // UTF-16 encoding
                     if (codepoint <= 0xFFFF) {
-                        result.push_back(static_cast<char16_t>(codepoint));
+                        out[o++] = static_cast<char16_t>(codepoint);
                     }
                     else if (codepoint <= 0x10FFFF) {
                         codepoint -= 0x10000;
-                        result.push_back(static_cast<char16_t>((codepoint >> 10) + 0xD800));
-                        result.push_back(static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00));
+                        out[o++] = static_cast<char16_t>((codepoint >> 10) + 0xD800);
+                        out[o++] = static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00);
                     }
                     else {
                         throw std::runtime_error("Invalid Unicode codepoint");
@@ -62,24 +78,663 @@ namespace LikesProgram {
 
                     i += extraBytes + 1;
                 }
-                return result;
-            }
 
-            std::u16string Utf32ToUtf16(const std::u32string& utf32) {
-                std::u16string result;
-                for (char32_t codepoint : utf32) {
+                // 读取 in[i] 开始的一个 UTF-16 码点（校验代理项配对）
+                inline char32_t ReadUtf16CodePoint(const char16_t* in, size_t length, size_t& i) {
+                    char32_t codepoint = in[i];
+
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) { // 高代理项
+                        if (i + 1 >= length)
+                            throw std::runtime_error("Invalid UTF-16 string: dangling high surrogate");
+                        char32_t low = in[i + 1];
+                        if (low < 0xDC00 || low > 0xDFFF)
+                            throw std::runtime_error("Invalid UTF-16 string: expected low surrogate");
+                        codepoint = ((codepoint - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
+                        i++;
+                    }
+                    else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                        throw std::runtime_error("Invalid UTF-16 string: unexpected low surrogate");
+                    }
+
+                    i++;
+                    return codepoint;
+                }
+
+                // 将 in[i] 开始的一个 UTF-16 码点写为 UTF-8
+                inline void Utf16SequenceToUtf8(const char16_t* in, size_t length, size_t& i, char8_t* out, size_t& o) {
+                    char32_t codepoint = ReadUtf16CodePoint(in, length, i);
+
+                    // UTF-8 encoding
+                    if (codepoint <= 0x7F) {
+                        out[o++] = static_cast<char8_t>(codepoint);
+                    }
+                    else if (codepoint <= 0x7FF) {
+                        out[o++] = static_cast<char8_t>(0xC0 | ((codepoint >> 6) & 0x1F));
+                        out[o++] = static_cast<char8_t>(0x80 | (codepoint & 0x3F));
+                    }
+                    else if (codepoint <= 0xFFFF) {
+                        out[o++] = static_cast<char8_t>(0xE0 | ((codepoint >> 12) & 0x0F));
+                        out[o++] = static_cast<char8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+                        out[o++] = static_cast<char8_t>(0x80 | (codepoint & 0x3F));
+                    }
+                    else {
+                        out[o++] = static_cast<char8_t>(0xF0 | ((codepoint >> 18) & 0x07));
+                        out[o++] = static_cast<char8_t>(0x80 | ((codepoint >> 12) & 0x3F));
+                        out[o++] = static_cast<char8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+                        out[o++] = static_cast<char8_t>(0x80 | (codepoint & 0x3F));
+                    }
+                }
+
+                // 将一个 UTF-32 码点写为 UTF-16
+                inline void Utf32CodePointToUtf16(char32_t codepoint, char16_t* out, size_t& o) {
                     if (codepoint <= 0xFFFF) {
-                        result.push_back(static_cast<char16_t>(codepoint));
+                        out[o++] = static_cast<char16_t>(codepoint);
                     }
                     else if (codepoint <= 0x10FFFF) {
                         codepoint -= 0x10000;
-                        result.push_back(static_cast<char16_t>((codepoint >> 10) + 0xD800));
-                        result.push_back(static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00));
+                        out[o++] = static_cast<char16_t>((codepoint >> 10) + 0xD800);
+                        out[o++] = static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00);
                     }
                     else {
                         throw std::runtime_error("Invalid UTF-32 codepoint");
                     }
                 }
+
+                // ---- 标量内核 ----
+                size_t Utf8ToUtf16Scalar(const char8_t* in, size_t length, char16_t* out) {
+                    size_t i = 0, o = 0;
+                    while (i < length) {
+                        if (in[i] < 0x80) out[o++] = in[i++];
+                        else Utf8SequenceToUtf16(in, length, i, out, o);
+                    }
+                    return o;
+                }
+
+                size_t Utf16ToUtf8Scalar(const char16_t* in, size_t length, char8_t* out) {
+                    size_t i = 0, o = 0;
+                    while (i < length) {
+                        if (in[i] < 0x80) out[o++] = static_cast<char8_t>(in[i++]);
+                        else Utf16SequenceToUtf8(in, length, i, out, o);
+                    }
+                    return o;
+                }
+
+                size_t Utf16ToUtf32Scalar(const char16_t* in, size_t length, char32_t* out) {
+                    size_t i = 0, o = 0;
+                    while (i < length) out[o++] = ReadUtf16CodePoint(in, length, i);
+                    return o;
+                }
+
+                size_t Utf32ToUtf16Scalar(const char32_t* in, size_t length, char16_t* out) {
+                    size_t o = 0;
+                    for (size_t i = 0; i < length; ++i) Utf32CodePointToUtf16(in[i], out, o);
+                    return o;
+                }
+
+#ifdef LIKESPROGRAM_UNICODE_X86
+                // ---- SSE2 内核 ----
+                // 每个块先按快速路径整体写出，再只前进到第一个需要标量处理的位置；
+                // 输出容量按最坏情况预留，因此整块写出不会越界。
+
+                // 多字节 UTF-8 块：in 指向一个序列的首字节且其后至少有 16 字节可读。
+                // 按定长序列逐通道校验（首字节与后续字节的掩码），整块解码写出，返回开头连续合法的序列数；
+                // 为 0 时交给标量路径（由其报告错误）。解码规则与 Utf8SequenceToUtf16 相同。
+
+                // 2 字节序列：每个 16 位通道一个序列（低字节为首字节），最多 8 个
+                inline size_t Utf8TwoByteBlockSse2(const char8_t* in, char16_t* out) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                    __m128i ok = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xC0E0))), _mm_set1_epi16(static_cast<short>(0x80C0)));
+                    __m128i cp = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1F)), 6),
+                        _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0x3F)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), cp);
+                    unsigned bad = ~static_cast<unsigned>(_mm_movemask_epi8(ok)) & 0xFFFF;
+                    return bad ? static_cast<size_t>(std::countr_zero(bad)) / 2 : 8;
+                }
+
+                // 3 字节序列 → 码点（每个 32 位通道低 3 字节为一个序列，最高字节忽略）
+                inline __m128i Utf8ThreeByteLanes(__m128i v, unsigned& okMask) {
+                    __m128i ok = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(0x00C0C0F0)), _mm_set1_epi32(0x008080E0));
+                    okMask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(ok)));
+                    return _mm_or_si128(_mm_or_si128(
+                        _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x0F)), 12),
+                        _mm_and_si128(_mm_srli_epi32(v, 2), _mm_set1_epi32(0x0FC0))),
+                        _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x3F)));
+                }
+
+                // 3 字节序列：SSE2 没有字节重排，按 3 字节步长读入 4 个通道，最多 4 个
+                inline size_t Utf8ThreeByteBlockSse2(const char8_t* in, char16_t* out) {
+                    uint32_t lanes[4];
+                    for (size_t k = 0; k < 4; ++k) std::memcpy(&lanes[k], in + k * 3, sizeof(uint32_t));
+                    unsigned ok = 0;
+                    __m128i cp = Utf8ThreeByteLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes)), ok);
+                    // 码点不超过 0xFFFF：偏置后有符号打包，再加回
+                    __m128i packed = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(cp, _mm_set1_epi32(0x8000)), _mm_setzero_si128()), _mm_set1_epi16(static_cast<short>(0x8000)));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+                    unsigned bad = ~ok & 0xF;
+                    return bad ? static_cast<size_t>(std::countr_zero(bad)) : 4;
+                }
+
+                // 4 字节序列 → 代理项对（每个 32 位通道一个序列，低 16 位为高代理项）；码点须在 [0x10000, 0x10FFFF]
+                inline __m128i Utf8FourByteLanes(__m128i v, unsigned& okMask) {
+                    __m128i ok = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xC0C0C0F8))), _mm_set1_epi32(static_cast<int>(0x808080F0)));
+                    __m128i cp = _mm_or_si128(_mm_or_si128(
+                        _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x07)), 18),
+                        _mm_and_si128(_mm_slli_epi32(v, 4), _mm_set1_epi32(0x3F000))), _mm_or_si128(
+                        _mm_and_si128(_mm_srli_epi32(v, 10), _mm_set1_epi32(0x0FC0)),
+                        _mm_and_si128(_mm_srli_epi32(v, 24), _mm_set1_epi32(0x3F))));
+                    ok = _mm_and_si128(ok, _mm_and_si128(_mm_cmpgt_epi32(cp, _mm_set1_epi32(0xFFFF)), _mm_cmplt_epi32(cp, _mm_set1_epi32(0x110000))));
+                    okMask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(ok)));
+                    cp = _mm_sub_epi32(cp, _mm_set1_epi32(0x10000));
+                    __m128i high = _mm_add_epi32(_mm_srli_epi32(cp, 10), _mm_set1_epi32(0xD800));
+                    __m128i low = _mm_add_epi32(_mm_and_si128(cp, _mm_set1_epi32(0x3FF)), _mm_set1_epi32(0xDC00));
+                    return _mm_or_si128(high, _mm_slli_epi32(low, 16));
+                }
+
+                // 4 字节序列：最多 4 个（写出 8 个 UTF-16 单元）
+                inline size_t Utf8FourByteBlockSse2(const char8_t* in, char16_t* out) {
+                    unsigned ok = 0;
+                    __m128i pairs = Utf8FourByteLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), ok);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pairs);
+                    unsigned bad = ~ok & 0xF;
+                    return bad ? static_cast<size_t>(std::countr_zero(bad)) : 4;
+                }
+
+                // 处理从 in[i] 开始的一段非 ASCII 序列，直到再次遇到 ASCII
+                inline void Utf8NonAsciiRunSse2(const char8_t* in, size_t length, size_t& i, char16_t* out, size_t& o) {
+                    while (i < length && in[i] >= 0x80) {
+                        if (i + 16 <= length) {
+                            unsigned char c = static_cast<unsigned char>(in[i]);
+                            size_t n = 0;
+                            if ((c & 0xE0) == 0xC0) {
+                                n = Utf8TwoByteBlockSse2(in + i, out + o);
+                                i += n * 2; o += n;
+                            }
+                            else if ((c & 0xF0) == 0xE0) {
+                                n = Utf8ThreeByteBlockSse2(in + i, out + o);
+                                i += n * 3; o += n;
+                            }
+                            else if ((c & 0xF8) == 0xF0) {
+                                n = Utf8FourByteBlockSse2(in + i, out + o);
+                                i += n * 4; o += n * 2;
+                            }
+                            if (n) continue;
+                        }
+                        Utf8SequenceToUtf16(in, length, i, out, o);
+                    }
+                }
+
+                size_t Utf8ToUtf16Sse2(const char8_t* in, size_t length, char16_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m128i zero = _mm_setzero_si128();
+                    while (i < length) {
+                        if (i + 16 <= length) {
+                            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(v)); // 非 ASCII 字节
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_unpacklo_epi8(v, zero));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o + 8), _mm_unpackhi_epi8(v, zero));
+                            size_t ascii = mask ? static_cast<size_t>(std::countr_zero(mask)) : 16;
+                            i += ascii;
+                            o += ascii;
+                            if (ascii == 16) continue;
+                        }
+                        else if (in[i] < 0x80) {
+                            out[o++] = in[i++];
+                            continue;
+                        }
+                        Utf8NonAsciiRunSse2(in, length, i, out, o);
+                    }
+                    return o;
+                }
+
+                size_t Utf16ToUtf8Sse2(const char16_t* in, size_t length, char8_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+                    while (i < length) {
+                        if (i + 8 <= length) {
+                            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                            __m128i isAscii = _mm_cmpeq_epi16(_mm_and_si128(v, nonAscii), zero);
+                            unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(isAscii)) & 0xFFFF;
+                            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + o), _mm_packus_epi16(v, v));
+                            size_t ascii = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 8;
+                            i += ascii;
+                            o += ascii;
+                            if (ascii == 8) continue;
+                        }
+                        else if (in[i] < 0x80) {
+                            out[o++] = static_cast<char8_t>(in[i++]);
+                            continue;
+                        }
+                        do Utf16SequenceToUtf8(in, length, i, out, o); while (i < length && in[i] >= 0x80);
+                    }
+                    return o;
+                }
+
+                size_t Utf16ToUtf32Sse2(const char16_t* in, size_t length, char32_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i surrogateMask = _mm_set1_epi16(static_cast<short>(0xF800));
+                    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+                    while (i < length) {
+                        if (i + 8 <= length) {
+                            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                            __m128i isSurrogate = _mm_cmpeq_epi16(_mm_and_si128(v, surrogateMask), surrogate);
+                            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(isSurrogate));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_unpacklo_epi16(v, zero));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o + 4), _mm_unpackhi_epi16(v, zero));
+                            size_t plain = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 8;
+                            i += plain;
+                            o += plain;
+                            if (plain == 8) continue;
+                        }
+                        do out[o++] = ReadUtf16CodePoint(in, length, i); while (i < length && (in[i] & 0xF800) == 0xD800);
+                    }
+                    return o;
+                }
+
+                size_t Utf32ToUtf16Sse2(const char32_t* in, size_t length, char16_t* out) {
+                    size_t i = 0, o = 0;
+                    // SSE2 没有无符号 32→16 打包：先减去 0x8000 做有符号打包，再加回
+                    const __m128i bias32 = _mm_set1_epi32(0x8000);
+                    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+                    const __m128i limit = _mm_set1_epi32(0xD800);
+                    const __m128i negative = _mm_set1_epi32(-1);
+                    while (i < length) {
+                        if (i + 8 <= length) {
+                            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4));
+                            // 可直接打包：0 <= cp < 0xD800（有符号比较，同时排除最高位被置位的非法值）
+                            __m128i okA = _mm_and_si128(_mm_cmplt_epi32(a, limit), _mm_cmpgt_epi32(a, negative));
+                            __m128i okB = _mm_and_si128(_mm_cmplt_epi32(b, limit), _mm_cmpgt_epi32(b, negative));
+                            __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_add_epi16(packed, bias16));
+                            unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi32(okA, okB))) & 0xFFFF;
+                            size_t plain = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 8;
+                            i += plain;
+                            o += plain;
+                            if (plain == 8) continue;
+                        }
+                        do Utf32CodePointToUtf16(in[i++], out, o); while (i < length && in[i] >= 0xD800);
+                    }
+                    return o;
+                }
+
+                // ---- AVX2 内核 ----
+                // 多字节 UTF-8 块的 AVX2 版本：in 后至少有 32 字节可读，其余约定同 SSE2 版本
+
+                // 2 字节序列：最多 16 个
+                LIKESPROGRAM_TARGET_AVX2
+                inline size_t Utf8TwoByteBlockAvx2(const char8_t* in, char16_t* out) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+                    __m256i ok = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(static_cast<short>(0xC0E0))), _mm256_set1_epi16(static_cast<short>(0x80C0)));
+                    __m256i cp = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x1F)), 6),
+                        _mm256_and_si256(_mm256_srli_epi16(v, 8), _mm256_set1_epi16(0x3F)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), cp);
+                    unsigned bad = ~static_cast<unsigned>(_mm256_movemask_epi8(ok));
+                    return bad ? static_cast<size_t>(std::countr_zero(bad)) / 2 : 16;
+                }
+
+                // 3 字节序列：两个 128 位通道各取 12 字节，按字节重排为 32 位通道，最多 8 个
+                LIKESPROGRAM_TARGET_AVX2
+                inline size_t Utf8ThreeByteBlockAvx2(const char8_t* in, char16_t* out) {
+                    __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+                    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+                    __m256i v = _mm256_shuffle_epi8(raw, spread);
+                    __m256i ok = _mm256_cmpeq_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0x00C0C0F0)), _mm256_set1_epi32(0x008080E0));
+                    __m256i cp = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_slli_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0x0F)), 12),
+                        _mm256_and_si256(_mm256_srli_epi32(v, 2), _mm256_set1_epi32(0x0FC0))),
+                        _mm256_and_si256(_mm256_srli_epi32(v, 16), _mm256_set1_epi32(0x3F)));
+                    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(cp, cp), 0x08);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+                    unsigned bad = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(ok))) & 0xFF;
+                    return bad ? static_cast<size_t>(std::countr_zero(bad)) : 8;
+                }
+
+                // 4 字节序列：最多 8 个（写出 16 个 UTF-16 单元）
+                LIKESPROGRAM_TARGET_AVX2
+                inline size_t Utf8FourByteBlockAvx2(const char8_t* in, char16_t* out) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+                    __m256i ok = _mm256_cmpeq_epi32(_mm256_and_si256(v, _mm256_set1_epi32(static_cast<int>(0xC0C0C0F8))), _mm256_set1_epi32(static_cast<int>(0x808080F0)));
+                    __m256i cp = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_slli_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0x07)), 18),
+                        _mm256_and_si256(_mm256_slli_epi32(v, 4), _mm256_set1_epi32(0x3F000))), _mm256_or_si256(
+                        _mm256_and_si256(_mm256_srli_epi32(v, 10), _mm256_set1_epi32(0x0FC0)),
+                        _mm256_and_si256(_mm256_srli_epi32(v, 24), _mm256_set1_epi32(0x3F))));
+                    __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi32(cp, _mm256_set1_epi32(0xFFFF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0x110000), cp));
+                    cp = _mm256_sub_epi32(cp, _mm256_set1_epi32(0x10000));
+                    __m256i high = _mm256_add_epi32(_mm256_srli_epi32(cp, 10), _mm256_set1_epi32(0xD800));
+                    __m256i low = _mm256_add_epi32(_mm256_and_si256(cp, _mm256_set1_epi32(0x3FF)), _mm256_set1_epi32(0xDC00));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_or_si256(high, _mm256_slli_epi32(low, 16)));
+                    // 序列个数只取决于字节模式（依赖链较短），码点越界极少见，单独分支处理
+                    unsigned bad = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(ok))) & 0xFF;
+                    size_t n = bad ? static_cast<size_t>(std::countr_zero(bad)) : 8;
+                    unsigned outOfRange = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(inRange))) & ((1u << n) - 1);
+                    if (outOfRange) [[unlikely]] n = static_cast<size_t>(std::countr_zero(outOfRange));
+                    return n;
+                }
+
+                // 混合块查找表：以窗口前 12 字节中“序列首字节”（非后续字节）的位置为索引（第 0 字节恒为首字节，共 11 位），
+                // 给出把前若干个完整的 1~3 字节序列分别重排到 32 位通道（首字节在最低字节，缺少的字节补 0）的重排表
+                struct MixedUtf8Table {
+                    alignas(16) uint8_t shuffle[2048][16];
+                    uint8_t count[2048];    // 完整序列数（0~4）
+                    uint8_t consumed[2048]; // 这些序列占用的字节数
+
+                    MixedUtf8Table() {
+                        for (unsigned index = 0; index < 2048; ++index) {
+                            unsigned starts = (index << 1) | 1;
+                            std::memset(shuffle[index], 0x80, sizeof(shuffle[index]));
+                            unsigned n = 0, begin = 0;
+                            while (n < 4) {
+                                unsigned next = begin + 1;
+                                while (next < 12 && !(starts & (1u << next))) ++next;
+                                if (next >= 12 || next - begin > 3) break; // 序列未在窗口内结束，或超过 3 字节
+                                for (unsigned k = begin; k < next; ++k) shuffle[index][n * 4 + (k - begin)] = static_cast<uint8_t>(k);
+                                ++n;
+                                begin = next;
+                            }
+                            count[index] = static_cast<uint8_t>(n);
+                            consumed[index] = static_cast<uint8_t>(begin);
+                        }
+                    }
+                };
+
+                const MixedUtf8Table& GetMixedUtf8Table() {
+                    static const MixedUtf8Table table;
+                    return table;
+                }
+
+                // in 开始的 32 字节中后续字节（10xxxxxx）的位掩码
+                LIKESPROGRAM_TARGET_AVX2
+                inline uint32_t Utf8ContinuationMaskAvx2(const char8_t* in) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+                    __m256i continuation = _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(0xC0))), _mm256_set1_epi8(static_cast<char>(0x80)));
+                    return static_cast<uint32_t>(_mm256_movemask_epi8(continuation));
+                }
+
+                // 混合块：ASCII 与 2、3 字节序列交错时一次解码最多 4 个序列，避免在各类快速路径间频繁切换。
+                // starts 的低 12 位为 in 开始各字节是否为序列首字节（由调用方按段预先计算，使前进量只依赖查表）；
+                // 首字节类别须与通道中实际的后续字节数一致，否则在该通道停下交给标量路径
+                LIKESPROGRAM_TARGET_AVX2
+                inline size_t Utf8MixedBlockAvx2(const MixedUtf8Table& table, const char8_t* in, unsigned starts, char16_t* out, size_t& consumed) {
+                    __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                    unsigned index = (starts >> 1) & 0x7FF;
+                    size_t count = table.count[index];
+                    if (count == 0) return 0;
+
+                    __m128i v = _mm_shuffle_epi8(raw, _mm_load_si128(reinterpret_cast<const __m128i*>(table.shuffle[index])));
+                    __m128i zero = _mm_setzero_si128();
+                    __m128i one = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFFFF80)), zero), _mm_set1_epi32(-1));
+                    __m128i two = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFFC0E0)), _mm_set1_epi32(0x0080C0)), _mm_set1_epi32(-1));
+                    __m128i three = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(0xC0C0F0)), _mm_set1_epi32(0x8080E0));
+                    __m128i cp2 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x1F)), 6), _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0x3F)));
+                    __m128i cp3 = _mm_or_si128(_mm_or_si128(
+                        _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x0F)), 12),
+                        _mm_and_si128(_mm_srli_epi32(v, 2), _mm_set1_epi32(0x0FC0))),
+                        _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x3F)));
+                    __m128i cp = _mm_or_si128(_mm_or_si128(_mm_and_si128(one, v), _mm_and_si128(two, cp2)), _mm_and_si128(three, cp3));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi32(cp, cp));
+
+                    unsigned ok = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(one, two), three))));
+                    unsigned bad = ~ok & ((1u << count) - 1);
+                    if (bad) [[unlikely]] {
+                        count = static_cast<size_t>(std::countr_zero(bad));
+                        consumed = table.shuffle[index][count * 4]; // 第一个非法序列的起始位置
+                        return count;
+                    }
+                    consumed = table.consumed[index]; // 不依赖校验结果，缩短循环依赖链
+                    return count;
+                }
+
+                // 处理从 in[i] 开始的非 ASCII 段：同类序列成段时走定长块，类别切换处（含夹杂的 ASCII）走混合块，
+                // 遇到整段 ASCII 时返回；非法序列由标量路径报告
+                LIKESPROGRAM_TARGET_AVX2
+                inline void Utf8NonAsciiRunAvx2(const MixedUtf8Table& table, const char8_t* in, size_t length, size_t& i, char16_t* out, size_t& o) {
+                    bool window = false;
+                    size_t windowBase = 0, windowLimit = 0;
+                    uint64_t windowStarts = 0;
+                    while (i + 32 <= length) {
+                        unsigned char c = static_cast<unsigned char>(in[i]);
+                        size_t n = 0;
+                        if (c < 0x80) {
+                            // 夹在非 ASCII 序列间的 ASCII：较长或其后为 4 字节序列（混合块不处理）时直接扩展写出，
+                            // 否则与后面的 2、3 字节序列一起交给混合块
+                            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(v));
+                            if (mask == 0) return;
+                            size_t ascii = static_cast<size_t>(std::countr_zero(mask));
+                            if (ascii >= 4 || in[i + ascii] >= 0xF0) {
+                                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), _mm256_cvtepu8_epi16(v));
+                                i += ascii; o += ascii;
+                                continue;
+                            }
+                        }
+                        else if ((c & 0xE0) == 0xC0) {
+                            n = Utf8TwoByteBlockAvx2(in + i, out + o);
+                            i += n * 2; o += n;
+                        }
+                        else if ((c & 0xF0) == 0xE0) {
+                            n = Utf8ThreeByteBlockAvx2(in + i, out + o);
+                            i += n * 3; o += n;
+                        }
+                        else if ((c & 0xF8) == 0xF0) {
+                            n = Utf8FourByteBlockAvx2(in + i, out + o);
+                            i += n * 4; o += n * 2;
+                        }
+                        if (n) continue; // 块内遇到其他类别时，下一轮从切换处开始
+
+                        // 序列首字节掩码按 64 字节一段预先计算（段尾不足时按 32 字节），每个混合块只需移位取用
+                        if (!window || i - windowBase > windowLimit) {
+                            windowBase = i;
+                            if (i + 64 <= length) {
+                                windowStarts = ~(static_cast<uint64_t>(Utf8ContinuationMaskAvx2(in + i)) | static_cast<uint64_t>(Utf8ContinuationMaskAvx2(in + i + 32)) << 32);
+                                windowLimit = 52;
+                            }
+                            else {
+                                windowStarts = ~static_cast<uint64_t>(Utf8ContinuationMaskAvx2(in + i));
+                                windowLimit = 20;
+                            }
+                            window = true;
+                        }
+                        size_t consumed = 0;
+                        size_t mixed = Utf8MixedBlockAvx2(table, in + i, static_cast<unsigned>(windowStarts >> (i - windowBase)), out + o, consumed);
+                        if (mixed) {
+                            i += consumed; o += mixed;
+                            continue;
+                        }
+                        if (c < 0x80) out[o++] = in[i++];
+                        else Utf8SequenceToUtf16(in, length, i, out, o);
+                    }
+                    while (i < length && in[i] >= 0x80) Utf8SequenceToUtf16(in, length, i, out, o);
+                }
+
+                LIKESPROGRAM_TARGET_AVX2
+                size_t Utf8ToUtf16Avx2(const char8_t* in, size_t length, char16_t* out) {
+                    const MixedUtf8Table& table = GetMixedUtf8Table();
+                    size_t i = 0, o = 0;
+                    while (i < length) {
+                        if (i + 32 <= length) {
+                            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(v));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+                            size_t ascii = mask ? static_cast<size_t>(std::countr_zero(mask)) : 32;
+                            i += ascii;
+                            o += ascii;
+                            if (ascii == 32) continue;
+                        }
+                        else if (in[i] < 0x80) {
+                            out[o++] = in[i++];
+                            continue;
+                        }
+                        Utf8NonAsciiRunAvx2(table, in, length, i, out, o);
+                    }
+                    return o;
+                }
+
+                LIKESPROGRAM_TARGET_AVX2
+                size_t Utf16ToUtf8Avx2(const char16_t* in, size_t length, char8_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m256i zero = _mm256_setzero_si256();
+                    const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+                    while (i < length) {
+                        if (i + 16 <= length) {
+                            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                            __m256i isAscii = _mm256_cmpeq_epi16(_mm256_and_si256(v, nonAscii), zero);
+                            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(isAscii));
+                            // packus 在 128 位通道内交错，重排后低 128 位即为连续的 16 字节
+                            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm256_castsi256_si128(packed));
+                            size_t ascii = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 16;
+                            i += ascii;
+                            o += ascii;
+                            if (ascii == 16) continue;
+                        }
+                        else if (in[i] < 0x80) {
+                            out[o++] = static_cast<char8_t>(in[i++]);
+                            continue;
+                        }
+                        do Utf16SequenceToUtf8(in, length, i, out, o); while (i < length && in[i] >= 0x80);
+                    }
+                    return o;
+                }
+
+                LIKESPROGRAM_TARGET_AVX2
+                size_t Utf16ToUtf32Avx2(const char16_t* in, size_t length, char32_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m256i surrogateMask = _mm256_set1_epi16(static_cast<short>(0xF800));
+                    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+                    while (i < length) {
+                        if (i + 16 <= length) {
+                            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                            __m256i isSurrogate = _mm256_cmpeq_epi16(_mm256_and_si256(v, surrogateMask), surrogate);
+                            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(isSurrogate));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o + 8), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+                            size_t plain = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 16;
+                            i += plain;
+                            o += plain;
+                            if (plain == 16) continue;
+                        }
+                        do out[o++] = ReadUtf16CodePoint(in, length, i); while (i < length && (in[i] & 0xF800) == 0xD800);
+                    }
+                    return o;
+                }
+
+                LIKESPROGRAM_TARGET_AVX2
+                size_t Utf32ToUtf16Avx2(const char32_t* in, size_t length, char16_t* out) {
+                    size_t i = 0, o = 0;
+                    const __m256i limit = _mm256_set1_epi32(0xD7FF);
+                    const __m256i zero = _mm256_setzero_si256();
+                    while (i < length) {
+                        if (i + 16 <= length) {
+                            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 8));
+                            // 需标量处理：cp >= 0xD800 或最高位被置位（有符号为负）
+                            __m256i badA = _mm256_or_si256(_mm256_cmpgt_epi32(a, limit), _mm256_cmpgt_epi32(zero, a));
+                            __m256i badB = _mm256_or_si256(_mm256_cmpgt_epi32(b, limit), _mm256_cmpgt_epi32(zero, b));
+                            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), packed);
+                            __m256i bad = _mm256_permute4x64_epi64(_mm256_packs_epi32(badA, badB), 0xD8);
+                            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(bad));
+                            size_t plain = mask ? static_cast<size_t>(std::countr_zero(mask)) / 2 : 16;
+                            i += plain;
+                            o += plain;
+                            if (plain == 16) continue;
+                        }
+                        do Utf32CodePointToUtf16(in[i++], out, o); while (i < length && in[i] >= 0xD800);
+                    }
+                    return o;
+                }
+
+                bool CpuSupportsAvx2() {
+#ifdef _MSC_VER
+                    int info[4] = {};
+                    __cpuid(info, 0);
+                    if (info[0] < 7) return false;
+                    __cpuid(info, 1);
+                    bool osxsave = (info[2] & (1 << 27)) != 0;
+                    bool avx = (info[2] & (1 << 28)) != 0;
+                    if (!osxsave || !avx) return false;
+                    if ((_xgetbv(0) & 0x6) != 0x6) return false; // 操作系统需保存 YMM 寄存器
+                    __cpuidex(info, 7, 0);
+                    return (info[1] & (1 << 5)) != 0;
+#else
+                    __builtin_cpu_init();
+                    return __builtin_cpu_supports("avx2");
+#endif
+                }
+#endif
+
+                // 内核函数表，首次使用时按 CPU 能力选择
+                struct Kernels {
+                    size_t (*utf8ToUtf16)(const char8_t*, size_t, char16_t*);
+                    size_t (*utf16ToUtf8)(const char16_t*, size_t, char8_t*);
+                    size_t (*utf16ToUtf32)(const char16_t*, size_t, char32_t*);
+                    size_t (*utf32ToUtf16)(const char32_t*, size_t, char16_t*);
+                    const char* name;
+                };
+
+                const Kernels& SelectKernels() {
+                    static const Kernels kernels = []() -> Kernels {
+#ifdef LIKESPROGRAM_UNICODE_X86
+                        if (CpuSupportsAvx2()) return { Utf8ToUtf16Avx2, Utf16ToUtf8Avx2, Utf16ToUtf32Avx2, Utf32ToUtf16Avx2, "AVX2" };
+                        return { Utf8ToUtf16Sse2, Utf16ToUtf8Sse2, Utf16ToUtf32Sse2, Utf32ToUtf16Sse2, "SSE2" };
+#else
+                        return { Utf8ToUtf16Scalar, Utf16ToUtf8Scalar, Utf16ToUtf32Scalar, Utf32ToUtf16Scalar, "Scalar" };
+#endif
+                    }();
+                    return kernels;
+                }
+
+                // 短输入直接走标量路径，避免向量循环的额外开销
+                constexpr size_t ShortInput = 16;
+
+                inline void CheckCapacity(size_t capacity, size_t required) {
+                    if (capacity < required) throw std::length_error("Unicode::Convert: output buffer too small");
+                }
+            }
+
+            size_t Utf8ToUtf16(const char8_t* utf8, size_t length, char16_t* out, size_t capacity) {
+                CheckCapacity(capacity, MaxUtf16FromUtf8(length));
+                if (length < ShortInput) return Utf8ToUtf16Scalar(utf8, length, out);
+                return SelectKernels().utf8ToUtf16(utf8, length, out);
+            }
+
+            size_t Utf32ToUtf16(const char32_t* utf32, size_t length, char16_t* out, size_t capacity) {
+                CheckCapacity(capacity, MaxUtf16FromUtf32(length));
+                if (length < ShortInput) return Utf32ToUtf16Scalar(utf32, length, out);
+                return SelectKernels().utf32ToUtf16(utf32, length, out);
+            }
+
+            size_t Utf16ToUtf8(const char16_t* utf16, size_t length, char8_t* out, size_t capacity) {
+                CheckCapacity(capacity, MaxUtf8FromUtf16(length));
+                if (length < ShortInput) return Utf16ToUtf8Scalar(utf16, length, out);
+                return SelectKernels().utf16ToUtf8(utf16, length, out);
+            }
+
+            size_t Utf16ToUtf32(const char16_t* utf16, size_t length, char32_t* out, size_t capacity) {
+                CheckCapacity(capacity, MaxUtf32FromUtf16(length));
+                if (length < ShortInput) return Utf16ToUtf32Scalar(utf16, length, out);
+                return SelectKernels().utf16ToUtf32(utf16, length, out);
+            }
+
+            const char* ActiveKernel() {
+                return SelectKernels().name;
+            }
+
+            std::u16string Utf8ToUtf16(const std::u8string& utf8) {
+                std::u16string result(MaxUtf16FromUtf8(utf8.size()), u'\0');
+                result.resize(Utf8ToUtf16(utf8.data(), utf8.size(), result.data(), result.size()));
+                return result;
+            }
+
+            std::u16string Utf32ToUtf16(const std::u32string& utf32) {
+                std::u16string result(MaxUtf16FromUtf32(utf32.size()), u'\0');
+                result.resize(Utf32ToUtf16(utf32.data(), utf32.size(), result.data(), result.size()));
                 return result;
             }
 
@@ -120,75 +775,14 @@ namespace LikesProgram {
             }
 
             std::u8string Utf16ToUtf8(const std::u16string& utf16) {
-                std::u8string result;
-                size_t i = 0;
-                while (i < utf16.size()) {
-                    uint32_t codepoint = utf16[i];
-
-                    // 判断是否为高代理项
-                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
-                        if (i + 1 >= utf16.size())
-                            throw std::runtime_error("Invalid UTF-16 string: dangling high surrogate");
-                        char32_t low = utf16[i + 1];
-                        if (low < 0xDC00 || low > 0xDFFF)
-                            throw std::runtime_error("Invalid UTF-16 string: expected low surrogate");
-                        codepoint = ((codepoint - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
-                        i++;
-                    }
-                    else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
-                        throw std::runtime_error("Invalid UTF-16 string: unexpected low surrogate");
-                    }
-
-                    // UTF-8 encoding
-                    if (codepoint <= 0x7F) {
-                        result.push_back(static_cast<char>(codepoint));
-                    }
-                    else if (codepoint <= 0x7FF) {
-                        result.push_back(static_cast<char>(0xC0 | ((codepoint >> 6) & 0x1F)));
-                        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-                    }
-                    else if (codepoint <= 0xFFFF) {
-                        result.push_back(static_cast<char>(0xE0 | ((codepoint >> 12) & 0x0F)));
-                        result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-                        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-                    }
-                    else if (codepoint <= 0x10FFFF) {
-                        result.push_back(static_cast<char>(0xF0 | ((codepoint >> 18) & 0x07)));
-                        result.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
-                        result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-                        result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-                    }
-                    else {
-                        throw std::runtime_error("Invalid Unicode codepoint");
-                    }
-
-                    i++;
-                }
+                std::u8string result(MaxUtf8FromUtf16(utf16.size()), u8'\0');
+                result.resize(Utf16ToUtf8(utf16.data(), utf16.size(), result.data(), result.size()));
                 return result;
             }
 
             std::u32string Utf16ToUtf32(const std::u16string& utf16) {
-                std::u32string result;
-                size_t i = 0;
-                while (i < utf16.size()) {
-                    char32_t codepoint = utf16[i];
-
-                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) { // 高代理项
-                        if (i + 1 >= utf16.size())
-                            throw std::runtime_error("Invalid UTF-16 string: dangling high surrogate");
-                        char32_t low = utf16[i + 1];
-                        if (low < 0xDC00 || low > 0xDFFF)
-                            throw std::runtime_error("Invalid UTF-16 string: expected low surrogate");
-                        codepoint = ((codepoint - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
-                        i++;
-                    }
-                    else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
-                        throw std::runtime_error("Invalid UTF-16 string: unexpected low surrogate");
-                    }
-
-                    result.push_back(codepoint);
-                    i++;
-                }
+                std::u32string result(MaxUtf32FromUtf16(utf16.size()), U'\0');
+                result.resize(Utf16ToUtf32(utf16.data(), utf16.size(), result.data(), result.size()));
                 return result;
             }
 